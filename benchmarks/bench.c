@@ -0,0 +1,748 @@
+/*
+	bench.c
+
+	microbenchmarks for every processor and the block kernels under them. each case runs a fixed
+	stretch of noise through the block API at block sizes 1, 16, 64, 256, 1024 and 4096 and reports
+	ns per sample frame (all channels of the mode), frames per second and cycles per frame.
+
+	the same source builds twice, the SIMD path px_simd.h picks for the target and the scalar
+	fallback (PX_NO_SIMD, auto-vectorization off), compare the two json files for the SIMD gain.
+
+	cycles
+		perf_event (PERF_COUNT_HW_CPU_CYCLES, core cycles) on linux when the kernel allows it,
+		rdtsc on x86 otherwise (reference cycles, scales with the nominal clock not the real one),
+		null when neither is there. ns always comes from the monotonic clock.
+
+	build:
+		cmake -S . -B build && cmake --build build
+		build/benchmarks/px_bench --json simd.json
+		build/benchmarks/px_bench_scalar --json scalar.json
+
+	options:
+		--json path         results as json (default px_bench.json)
+		--baseline path     compare ns/sample against an earlier json, exit 1 on a regression
+		--tolerance x       allowed slowdown against the baseline (default 0.10, 10%)
+		--filter name       only cases whose processor name contains name
+		--quick             fewer repetitions, for a smoke run
+
+	every result is the fastest of the repetitions, after a warm-up pass. run on an idle machine
+	with the governor pinned for numbers worth keeping as a baseline.
+*/
+
+#include "px_graph.h"
+#include "px_batch.h"
+#include "px_filter_design.h"
+
+#if !defined(_WIN32)
+#include <time.h>
+#else
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_PERF
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define BENCH_TSC
+#endif
+
+#define SAMPLE_RATE 48000.f
+#define FRAMES 16384		// per pass, every block size processes the same stretch
+#define MAX_BLOCK 4096
+#define REPETITIONS 7
+#define QUICK_REPETITIONS 2
+#define BATCH_INSTANCES (2 * PX_BATCH_LANES)
+#define BENCH_CHANNELS BATCH_INSTANCES	// the widest case
+
+static const int block_sizes[] = { 1, 16, 64, 256, 1024, 4096 };
+#define NUM_BLOCK_SIZES ((int)(sizeof(block_sizes) / sizeof(block_sizes[0])))
+
+// ----------------------------------------------------------------------------------------------------
+// clocks
+
+static double now_ns(void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double)counter.QuadPart * 1.0e9 / (double)frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1.0e9 + (double)time.tv_nsec;
+#endif
+}
+
+typedef enum
+{
+	COUNTER_NONE,
+	COUNTER_PERF,
+	COUNTER_TSC
+} COUNTER_TYPE;
+
+static COUNTER_TYPE counter_type = COUNTER_NONE;
+static int perf_fd = -1;
+
+static void counter_open(void)
+{
+#ifdef BENCH_PERF
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CPU_CYCLES;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	perf_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	if (perf_fd >= 0)
+	{
+		ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+		counter_type = COUNTER_PERF;
+		return;
+	}
+#endif
+#ifdef BENCH_TSC
+	counter_type = COUNTER_TSC;
+#endif
+}
+
+static void counter_close(void)
+{
+#ifdef BENCH_PERF
+	if (perf_fd >= 0)
+		close(perf_fd);
+#endif
+	perf_fd = -1;
+}
+
+static unsigned long long counter_read(void)
+{
+#ifdef BENCH_PERF
+	if (counter_type == COUNTER_PERF)
+	{
+		unsigned long long cycles = 0;
+		if (read(perf_fd, &cycles, sizeof(cycles)) != (ssize_t)sizeof(cycles))
+			return 0;
+		return cycles;
+	}
+#endif
+#ifdef BENCH_TSC
+	if (counter_type == COUNTER_TSC)
+		return __rdtsc();
+#endif
+	return 0;
+}
+
+static const char* counter_name(void)
+{
+	switch (counter_type)
+	{
+		case COUNTER_PERF: return "perf_event";
+		case COUNTER_TSC: return "rdtsc";
+		default: return "none";
+	}
+}
+
+static const char* simd_name(void)
+{
+#if defined(PX_SIMD_AVX512)
+	return "avx512";
+#elif defined(PX_SIMD_AVX)
+	return "avx";
+#elif defined(PX_SIMD_SSE)
+	return "sse2";
+#elif defined(PX_SIMD_NEON)
+	return "neon";
+#else
+	return "scalar";
+#endif
+}
+
+static unsigned int seed = 1;
+static SAMPLE_TYPE noise(void)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (SAMPLE_TYPE)((int)(seed >> 9) - (1 << 22)) / (SAMPLE_TYPE)(1 << 23);	// -6 dBFS white
+}
+
+// ----------------------------------------------------------------------------------------------------
+// processors, set up once with settings a session would use, every case reuses them
+
+typedef struct
+{
+	px_biquad biquad[2];
+	px_biquad svf;
+	px_sos_cascade crossover;
+
+	px_mono_equalizer equalizer;
+	px_stereo_equalizer stereo_equalizer;
+	px_ms_equalizer ms_equalizer;
+
+	px_saturator saturator;
+	px_clipper clipper;
+
+	px_mono_compressor compressor;
+	px_stereo_compressor stereo_compressor;
+	px_ms_compressor ms_compressor;
+	px_linked_compressor linked;
+
+	px_mono_multiband multiband;
+	px_stereo_multiband stereo_multiband;
+
+	px_mono_limiter limiter;
+	px_stereo_limiter stereo_limiter;
+
+	px_delay_line delay;
+	px_stereo_delay stereo_delay;
+
+	px_mono_equalizer batch_equalizers[BATCH_INSTANCES];
+	px_mono_compressor batch_compressors[BATCH_INSTANCES];
+	px_saturator batch_saturators[BATCH_INSTANCES];
+	px_batch_equalizer batch_equalizer;
+	px_batch_compressor batch_compressor;
+	px_batch_saturator batch_saturator;
+
+	// eq > compressor > limiter, stereo, through the graph
+	px_stereo_equalizer graph_equalizer;
+	px_stereo_compressor graph_compressor;
+	px_stereo_limiter graph_limiter;
+	px_graph graph;
+
+	// kernels
+	px_level_detector detector;
+	px_gain_curve curve;
+	px_meter meter;
+	SAMPLE_TYPE scratch[MAX_BLOCK];
+	SAMPLE_TYPE zeros[MAX_BLOCK];
+} bench_processors;
+
+static void equalizer_bands(px_mono_equalizer* equalizer)
+{
+	px_equalizer_mono_add_band(equalizer, 40.f, 0.7f, 0.f, BIQUAD_HIGHPASS);
+	px_equalizer_mono_add_band(equalizer, 250.f, 1.f, 3.f, BIQUAD_PEAK);
+	px_equalizer_mono_add_band(equalizer, 2500.f, 0.7f, -3.f, BIQUAD_PEAK);
+	px_equalizer_mono_add_band(equalizer, 8000.f, 0.7f, 2.f, BIQUAD_HIGHSHELF);
+}
+
+static void equalizer_free(px_mono_equalizer* equalizer)
+{
+	while (equalizer->num_bands > 0)
+		px_equalizer_mono_remove_band(equalizer, 0);
+}
+
+static void multiband_crossovers(px_mono_multiband* mono, px_stereo_multiband* stereo)
+{
+	const float crossovers[] = { 150.f, 1200.f, 6000.f };
+	for (int index = 0; index < 3; ++index)
+	{
+		if (mono)
+			px_multiband_mono_set_crossover(mono, index, crossovers[index]);
+		if (stereo)
+			px_multiband_stereo_set_crossover(stereo, index, crossovers[index]);
+	}
+}
+
+static void processors_initialize(bench_processors* p)
+{
+	memset(p, 0, sizeof(bench_processors));
+
+	for (int channel = 0; channel < 2; ++channel)
+	{
+		px_biquad_initialize(&p->biquad[channel], SAMPLE_RATE, BIQUAD_PEAK);
+		px_biquad_set_frequency(&p->biquad[channel], 1000.f);
+		px_biquad_set_quality(&p->biquad[channel], 0.7f);
+		px_biquad_set_gain(&p->biquad[channel], 6.f);
+	}
+	px_biquad_initialize(&p->svf, SAMPLE_RATE, BIQUAD_PEAK);
+	px_biquad_set_frequency(&p->svf, 1000.f);
+	px_biquad_set_gain(&p->svf, 6.f);
+	px_biquad_set_topology(&p->svf, BIQUAD_SVF);
+
+	px_filter_specification specification = PX_FILTER_SPECIFICATION(FILTER_LINKWITZ_RILEY, BIQUAD_LOWPASS, 8, SAMPLE_RATE, 250.f);
+	px_filter_design(specification, &p->crossover);
+
+	px_equalizer_mono_initialize(&p->equalizer, SAMPLE_RATE);
+	equalizer_bands(&p->equalizer);
+	px_equalizer_stereo_initialize(&p->stereo_equalizer, SAMPLE_RATE);
+	equalizer_bands(&p->stereo_equalizer.left);
+	equalizer_bands(&p->stereo_equalizer.right);
+	px_equalizer_ms_initialize(&p->ms_equalizer, SAMPLE_RATE);
+	equalizer_bands(&p->ms_equalizer.mid);
+	equalizer_bands(&p->ms_equalizer.side);
+
+	px_saturator_initialize(&p->saturator, SAMPLE_RATE, TANGENT);
+	px_saturator_set_drive(&p->saturator, 6.f);
+	px_clipper_initialize(&p->clipper);
+	px_clipper_set_type(&p->clipper, SOFT);
+
+	px_compressor_mono_initialize(&p->compressor, SAMPLE_RATE);
+	px_compressor_mono_set_threshold(&p->compressor, -18.f);
+	px_compressor_mono_set_ratio(&p->compressor, 4.f);
+	px_compressor_stereo_initialize(&p->stereo_compressor, SAMPLE_RATE);
+	px_compressor_stereo_set_threshold(&p->stereo_compressor, -18.f);
+	px_compressor_stereo_set_ratio(&p->stereo_compressor, 4.f);
+	px_compressor_ms_initialize(&p->ms_compressor, SAMPLE_RATE);
+	px_compressor_ms_set_threshold(&p->ms_compressor, -18.f);
+	px_compressor_ms_set_ratio(&p->ms_compressor, 4.f);
+	px_linked_initialize(&p->linked, SAMPLE_RATE, 2);
+	px_compressor_mono_set_threshold(px_linked_get_compressor(&p->linked), -18.f);
+
+	px_multiband_mono_initialize(&p->multiband, SAMPLE_RATE, 4);
+	px_multiband_stereo_initialize(&p->stereo_multiband, SAMPLE_RATE, 4);
+	multiband_crossovers(&p->multiband, &p->stereo_multiband);
+
+	px_limiter_mono_initialize(&p->limiter, SAMPLE_RATE);
+	px_limiter_mono_set_ceiling(&p->limiter, -1.f);
+	px_limiter_stereo_initialize(&p->stereo_limiter, SAMPLE_RATE);
+	px_limiter_stereo_set_ceiling(&p->stereo_limiter, -1.f);
+
+	px_delay_mono_initialize(&p->delay, SAMPLE_RATE, 1.f);
+	px_delay_mono_set_time(&p->delay, 0.25f);
+	px_delay_mono_set_feedback(&p->delay, 0.5f);
+	px_delay_stereo_initialize(&p->stereo_delay, SAMPLE_RATE, 1.f, true);
+	px_delay_stereo_set_time(&p->stereo_delay, 0.25f, BOTH);
+	px_delay_stereo_set_feedback(&p->stereo_delay, 0.5f, BOTH);
+
+	px_mono_equalizer* equalizers[BATCH_INSTANCES];
+	px_mono_compressor* compressors[BATCH_INSTANCES];
+	px_saturator* saturators[BATCH_INSTANCES];
+	for (int instance = 0; instance < BATCH_INSTANCES; ++instance)
+	{
+		px_equalizer_mono_initialize(&p->batch_equalizers[instance], SAMPLE_RATE);
+		equalizer_bands(&p->batch_equalizers[instance]);
+		px_compressor_mono_initialize(&p->batch_compressors[instance], SAMPLE_RATE);
+		px_compressor_mono_set_threshold(&p->batch_compressors[instance], -18.f - (float)instance);
+		px_saturator_initialize(&p->batch_saturators[instance], SAMPLE_RATE, (instance & 1) ? TANGENT : ARCTANGENT);
+
+		equalizers[instance] = &p->batch_equalizers[instance];
+		compressors[instance] = &p->batch_compressors[instance];
+		saturators[instance] = &p->batch_saturators[instance];
+	}
+	px_batch_equalizer_initialize(&p->batch_equalizer, equalizers, BATCH_INSTANCES);
+	px_batch_compressor_initialize(&p->batch_compressor, compressors, BATCH_INSTANCES);
+	px_batch_saturator_initialize(&p->batch_saturator, saturators, BATCH_INSTANCES);
+
+	px_equalizer_stereo_initialize(&p->graph_equalizer, SAMPLE_RATE);
+	equalizer_bands(&p->graph_equalizer.left);
+	equalizer_bands(&p->graph_equalizer.right);
+	px_compressor_stereo_initialize(&p->graph_compressor, SAMPLE_RATE);
+	px_compressor_stereo_set_threshold(&p->graph_compressor, -18.f);
+	px_limiter_stereo_initialize(&p->graph_limiter, SAMPLE_RATE);
+
+	px_graph_initialize(&p->graph, SAMPLE_RATE, 2, MAX_BLOCK);
+	int eq = px_graph_add_stereo_equalizer(&p->graph, &p->graph_equalizer);
+	int comp = px_graph_add_stereo_compressor(&p->graph, &p->graph_compressor);
+	int limiter = px_graph_add_stereo_limiter(&p->graph, &p->graph_limiter);
+	px_graph_connect(&p->graph, PX_GRAPH_INPUT, eq);
+	px_graph_connect(&p->graph, eq, comp);
+	px_graph_connect(&p->graph, comp, limiter);
+	px_graph_connect(&p->graph, limiter, PX_GRAPH_OUTPUT);
+	if (!px_graph_compile(&p->graph))
+		printf("Invalid benchmark graph");
+
+	px_level_detector_initialize(&p->detector, SAMPLE_RATE);
+	px_level_detector_set_mode(&p->detector, DETECTOR_RMS);
+	px_level_detector_set_window(&p->detector, 10.f);
+
+	px_gain_segment segments[] = { { 0.f, 4.f } };
+	px_gain_curve_set(&p->curve, segments, 1, 1.f, 6.f);
+
+	px_meter_initialize(&p->meter, 1024);
+}
+
+static void processors_free(bench_processors* p)
+{
+	equalizer_free(&p->equalizer);
+	equalizer_free(&p->stereo_equalizer.left);
+	equalizer_free(&p->stereo_equalizer.right);
+	equalizer_free(&p->ms_equalizer.mid);
+	equalizer_free(&p->ms_equalizer.side);
+	equalizer_free(&p->graph_equalizer.left);
+	equalizer_free(&p->graph_equalizer.right);
+
+	px_compressor_mono_free_detector(&p->compressor);
+	px_compressor_mono_free_detector(&p->stereo_compressor.left);
+	px_compressor_mono_free_detector(&p->stereo_compressor.right);
+	px_compressor_mono_free_detector(&p->ms_compressor.mid);
+	px_compressor_mono_free_detector(&p->ms_compressor.side);
+	px_compressor_mono_free_detector(&p->graph_compressor.left);
+	px_compressor_mono_free_detector(&p->graph_compressor.right);
+	px_linked_free(&p->linked);
+
+	for (int band = 0; band < PX_MULTIBAND_MAX_BANDS; ++band)
+	{
+		px_compressor_mono_free_detector(&p->multiband.bands[band]);
+		px_compressor_mono_free_detector(&p->stereo_multiband.bands[band]);
+	}
+
+	px_limiter_mono_free_buffers(&p->limiter);
+	px_limiter_stereo_free_buffers(&p->stereo_limiter);
+	px_limiter_stereo_free_buffers(&p->graph_limiter);
+	px_delay_mono_free_buffer(&p->delay);
+	px_delay_stereo_free_buffer(&p->stereo_delay);
+
+	px_batch_equalizer_free(&p->batch_equalizer);
+	px_batch_compressor_free(&p->batch_compressor);
+	px_batch_saturator_free(&p->batch_saturator);
+	for (int instance = 0; instance < BATCH_INSTANCES; ++instance)
+	{
+		equalizer_free(&p->batch_equalizers[instance]);
+		px_compressor_mono_free_detector(&p->batch_compressors[instance]);
+	}
+
+	px_graph_free(&p->graph);
+	px_level_detector_free(&p->detector);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// cases, one block call on channels[num_channels]
+
+typedef void (*bench_callback)(bench_processors* p, SAMPLE_TYPE** channels, int num_samples);
+
+typedef struct
+{
+	const char* processor;
+	const char* mode;	// mono, stereo, ms, or the lane count of a batch
+	int num_channels;
+	bench_callback process;
+} bench_case;
+
+static void run_biquad_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_biquad_process_block(&p->biquad[0], c[0], n); }
+static void run_biquad_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_biquad_process_block(&p->biquad[0], c[0], n); px_biquad_process_block(&p->biquad[1], c[1], n); }
+static void run_svf_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_biquad_process_block(&p->svf, c[0], n); }
+static void run_sos_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_sos_cascade_process_block(&p->crossover, c[0], n); }
+
+static void run_equalizer_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_equalizer_mono_process_block(&p->equalizer, c[0], n); }
+static void run_equalizer_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_equalizer_stereo_process_block(&p->stereo_equalizer, c[0], c[1], n); }
+
+// no block API for M/S, per-sample is what a caller gets
+static void run_equalizer_ms(bench_processors* p, SAMPLE_TYPE** c, int n)
+{
+	for (int i = 0; i < n; ++i)
+		px_equalizer_ms_process(&p->ms_equalizer, c[0] + i, c[1] + i);
+}
+
+static void run_saturator_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_saturator_mono_process_block(&p->saturator, c[0], n); }
+static void run_saturator_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_saturator_stereo_process_block(&p->saturator, c[0], c[1], n); }
+static void run_clipper_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_clipper_mono_process_block(&p->clipper, c[0], n); }
+static void run_clipper_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_clipper_stereo_process_block(&p->clipper, c[0], c[1], n); }
+
+static void run_compressor_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_compressor_mono_process_block(&p->compressor, c[0], n); }
+static void run_compressor_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_compressor_stereo_process_block(&p->stereo_compressor, c[0], c[1], n, false); }
+
+static void run_compressor_ms(bench_processors* p, SAMPLE_TYPE** c, int n)
+{
+	for (int i = 0; i < n; ++i)
+		px_compressor_ms_process(&p->ms_compressor, c[0] + i, c[1] + i, false);
+}
+
+static void run_linked_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_linked_process_block(&p->linked, c, n); }
+static void run_multiband_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_multiband_mono_process_block(&p->multiband, c[0], n); }
+static void run_multiband_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_multiband_stereo_process_block(&p->stereo_multiband, c[0], c[1], n); }
+static void run_limiter_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_limiter_mono_process_block(&p->limiter, c[0], n); }
+static void run_limiter_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_limiter_stereo_process_block(&p->stereo_limiter, c[0], c[1], n); }
+static void run_delay_mono(bench_processors* p, SAMPLE_TYPE** c, int n) { px_delay_mono_process_block(&p->delay, c[0], n); }
+static void run_delay_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_delay_stereo_process_block(&p->stereo_delay, c[0], c[1], n); }
+
+static void run_batch_equalizer(bench_processors* p, SAMPLE_TYPE** c, int n) { px_batch_equalizer_process(&p->batch_equalizer, c, n); }
+static void run_batch_compressor(bench_processors* p, SAMPLE_TYPE** c, int n) { px_batch_compressor_process(&p->batch_compressor, c, n); }
+static void run_batch_saturator(bench_processors* p, SAMPLE_TYPE** c, int n) { px_batch_saturator_process(&p->batch_saturator, c, n); }
+static void run_graph_stereo(bench_processors* p, SAMPLE_TYPE** c, int n) { px_graph_process(&p->graph, c, c, n); }
+
+static void run_detector(bench_processors* p, SAMPLE_TYPE** c, int n) { px_level_detector_process_block(&p->detector, c[0], p->scratch, n); }
+static void run_gain_curve(bench_processors* p, SAMPLE_TYPE** c, int n) { px_gain_curve_lookup_block(&p->curve, c[0], p->scratch, n); }
+static void run_meter(bench_processors* p, SAMPLE_TYPE** c, int n) { px_meter_level_block(&p->meter, c[0], n); px_meter_advance(&p->meter, n); }
+
+// a silent block is the one that takes the full scan
+static void run_silence(bench_processors* p, SAMPLE_TYPE** c, int n)
+{
+	volatile bool silent = px_is_silent(p->zeros, n);
+	(void)silent;
+	(void)c;
+}
+
+static const bench_case cases[] =
+{
+	{ "biquad",		"mono",		1,			run_biquad_mono },
+	{ "biquad",		"stereo",	2,			run_biquad_stereo },
+	{ "biquad_svf",		"mono",		1,			run_svf_mono },
+	{ "sos_cascade_lr8",	"mono",		1,			run_sos_mono },
+	{ "equalizer",		"mono",		1,			run_equalizer_mono },
+	{ "equalizer",		"stereo",	2,			run_equalizer_stereo },
+	{ "equalizer",		"ms",		2,			run_equalizer_ms },
+	{ "saturator",		"mono",		1,			run_saturator_mono },
+	{ "saturator",		"stereo",	2,			run_saturator_stereo },
+	{ "clipper",		"mono",		1,			run_clipper_mono },
+	{ "clipper",		"stereo",	2,			run_clipper_stereo },
+	{ "compressor",		"mono",		1,			run_compressor_mono },
+	{ "compressor",		"stereo",	2,			run_compressor_stereo },
+	{ "compressor",		"ms",		2,			run_compressor_ms },
+	{ "linked",		"stereo",	2,			run_linked_stereo },
+	{ "multiband",		"mono",		1,			run_multiband_mono },
+	{ "multiband",		"stereo",	2,			run_multiband_stereo },
+	{ "limiter",		"mono",		1,			run_limiter_mono },
+	{ "limiter",		"stereo",	2,			run_limiter_stereo },
+	{ "delay",		"mono",		1,			run_delay_mono },
+	{ "delay",		"stereo",	2,			run_delay_stereo },
+	{ "batch_equalizer",	"batch",	BATCH_INSTANCES,	run_batch_equalizer },
+	{ "batch_compressor",	"batch",	BATCH_INSTANCES,	run_batch_compressor },
+	{ "batch_saturator",	"batch",	BATCH_INSTANCES,	run_batch_saturator },
+	{ "graph_eq_comp_limiter", "stereo",	2,			run_graph_stereo },
+	{ "kernel_detector_rms", "mono",	1,			run_detector },
+	{ "kernel_gain_curve",	"mono",		1,			run_gain_curve },
+	{ "kernel_meter",	"mono",		1,			run_meter },
+	{ "kernel_is_silent",	"mono",		1,			run_silence },
+};
+#define NUM_CASES ((int)(sizeof(cases) / sizeof(cases[0])))
+
+// ----------------------------------------------------------------------------------------------------
+// measurement
+
+typedef struct
+{
+	const bench_case* benchmark;
+	int block;
+	double ns_per_sample;		// per frame, all channels
+	double cycles_per_sample;	// < 0 without a counter
+} bench_result;
+
+static SAMPLE_TYPE* source[BENCH_CHANNELS];
+static SAMPLE_TYPE* work[BENCH_CHANNELS];
+
+// one pass over FRAMES, the copy back from the source stays outside the timing
+static void run_pass(bench_processors* p, const bench_case* benchmark, int block, double* ns, unsigned long long* cycles)
+{
+	SAMPLE_TYPE* channels[BENCH_CHANNELS];
+	for (int channel = 0; channel < benchmark->num_channels; ++channel)
+		memcpy(work[channel], source[channel], sizeof(SAMPLE_TYPE) * FRAMES);
+
+	double start = now_ns();
+	unsigned long long start_cycles = counter_read();
+	for (int offset = 0; offset < FRAMES; offset += block)
+	{
+		for (int channel = 0; channel < benchmark->num_channels; ++channel)
+			channels[channel] = work[channel] + offset;
+		benchmark->process(p, channels, block);
+	}
+	*cycles = counter_read() - start_cycles;
+	*ns = now_ns() - start;
+}
+
+static bench_result measure(bench_processors* p, const bench_case* benchmark, int block, int repetitions)
+{
+	bench_result result;
+	result.benchmark = benchmark;
+	result.block = block;
+
+	double ns, best_ns = 0.0;
+	unsigned long long cycles, best_cycles = 0;
+
+	run_pass(p, benchmark, block, &ns, &cycles);	// warm-up, caches and envelopes
+	for (int repetition = 0; repetition < repetitions; ++repetition)
+	{
+		run_pass(p, benchmark, block, &ns, &cycles);
+		if (repetition == 0 || ns < best_ns)
+		{
+			best_ns = ns;
+			best_cycles = cycles;
+		}
+	}
+
+	result.ns_per_sample = best_ns / FRAMES;
+	result.cycles_per_sample = (counter_type != COUNTER_NONE) ? (double)best_cycles / FRAMES : -1.0;
+	return result;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// json, one result per line so --baseline can read it back without a parser
+
+static bool write_json(const char* path, const bench_result* results, int num_results, int repetitions)
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+	{
+		printf("Invalid json path %s\n", path);
+		return false;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"suite\": \"px_bench\",\n");
+	fprintf(file, "\t\"simd\": \"%s\",\n", simd_name());
+	fprintf(file, "\t\"simd_width\": %d,\n", PX_SIMD_WIDTH);
+	fprintf(file, "\t\"sample_type\": \"%s\",\n", (sizeof(SAMPLE_TYPE) == sizeof(double)) ? "double" : "float");
+	fprintf(file, "\t\"counter\": \"%s\",\n", counter_name());
+	fprintf(file, "\t\"sample_rate\": %.0f,\n", (double)SAMPLE_RATE);
+	fprintf(file, "\t\"frames_per_pass\": %d,\n", FRAMES);
+	fprintf(file, "\t\"repetitions\": %d,\n", repetitions);
+	fprintf(file, "\t\"results\": [\n");
+
+	for (int index = 0; index < num_results; ++index)
+	{
+		const bench_result* result = &results[index];
+		fprintf(file, "\t\t{ \"processor\": \"%s\", \"mode\": \"%s\", \"channels\": %d, \"block\": %d, \"ns_per_sample\": %.4f, \"samples_per_second\": %.0f, \"cycles_per_sample\": ",
+			result->benchmark->processor, result->benchmark->mode, result->benchmark->num_channels, result->block,
+			result->ns_per_sample, 1.0e9 / result->ns_per_sample);
+		if (result->cycles_per_sample >= 0.0)
+			fprintf(file, "%.3f }", result->cycles_per_sample);
+		else
+			fprintf(file, "null }");
+		fprintf(file, "%s\n", (index + 1 < num_results) ? "," : "");
+	}
+
+	fprintf(file, "\t]\n}\n");
+	fclose(file);
+	return true;
+}
+
+// regressions against a file written by write_json, cases missing from either side are skipped
+static int compare_baseline(const char* path, const bench_result* results, int num_results, double tolerance)
+{
+	FILE* file = fopen(path, "r");
+	if (!file)
+	{
+		printf("Invalid baseline path %s\n", path);
+		return -1;
+	}
+
+	char line[512];
+	int regressions = 0;
+	while (fgets(line, sizeof(line), file))
+	{
+		char processor[64], mode[16], simd[16];
+		int channels, block;
+		double ns;
+
+		if (sscanf(line, " \"simd\": \"%15[^\"]\"", simd) == 1 && strcmp(simd, simd_name()) != 0)
+			printf("baseline is %s, this build is %s\n", simd, simd_name());
+
+		if (sscanf(line, " { \"processor\": \"%63[^\"]\", \"mode\": \"%15[^\"]\", \"channels\": %d, \"block\": %d, \"ns_per_sample\": %lf",
+			processor, mode, &channels, &block, &ns) != 5)
+			continue;
+
+		for (int index = 0; index < num_results; ++index)
+		{
+			const bench_result* result = &results[index];
+			if (result->block != block || strcmp(result->benchmark->processor, processor) != 0 || strcmp(result->benchmark->mode, mode) != 0)
+				continue;
+
+			if (result->ns_per_sample > ns * (1.0 + tolerance))
+			{
+				printf("regression %-24s %-6s block %4d  %8.3f ns -> %8.3f ns  (+%.1f%%)\n", processor, mode, block,
+					ns, result->ns_per_sample, 100.0 * (result->ns_per_sample / ns - 1.0));
+				++regressions;
+			}
+			break;
+		}
+	}
+
+	fclose(file);
+	return regressions;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+	const char* json_path = "px_bench.json";
+	const char* baseline_path = NULL;
+	const char* filter = NULL;
+	double tolerance = 0.10;
+	int repetitions = REPETITIONS;
+
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (strcmp(argv[arg], "--json") == 0 && arg + 1 < argc)
+			json_path = argv[++arg];
+		else if (strcmp(argv[arg], "--baseline") == 0 && arg + 1 < argc)
+			baseline_path = argv[++arg];
+		else if (strcmp(argv[arg], "--tolerance") == 0 && arg + 1 < argc)
+			tolerance = atof(argv[++arg]);
+		else if (strcmp(argv[arg], "--filter") == 0 && arg + 1 < argc)
+			filter = argv[++arg];
+		else if (strcmp(argv[arg], "--quick") == 0)
+			repetitions = QUICK_REPETITIONS;
+		else
+		{
+			printf("usage: %s [--json path] [--baseline path] [--tolerance x] [--filter name] [--quick]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	for (int channel = 0; channel < BENCH_CHANNELS; ++channel)
+	{
+		source[channel] = (SAMPLE_TYPE*)malloc(sizeof(SAMPLE_TYPE) * FRAMES);
+		work[channel] = (SAMPLE_TYPE*)malloc(sizeof(SAMPLE_TYPE) * FRAMES);
+		assert(source[channel] && work[channel]);
+		for (int i = 0; i < FRAMES; ++i)
+			source[channel][i] = noise();
+	}
+
+	bench_processors* processors = (bench_processors*)malloc(sizeof(bench_processors));
+	assert(processors);
+	processors_initialize(processors);
+	counter_open();
+
+	bench_result* results = (bench_result*)malloc(sizeof(bench_result) * NUM_CASES * NUM_BLOCK_SIZES);
+	assert(results);
+	int num_results = 0;
+
+	px_fp_mode mode = px_denormals_disable();	// per-sample M/S paths have no guard of their own
+	for (int index = 0; index < NUM_CASES; ++index)
+	{
+		if (filter && !strstr(cases[index].processor, filter))
+			continue;
+		assert(cases[index].num_channels <= BENCH_CHANNELS);
+		for (int size = 0; size < NUM_BLOCK_SIZES; ++size)
+			results[num_results++] = measure(processors, &cases[index], block_sizes[size], repetitions);
+	}
+	px_denormals_restore(mode);
+
+	printf("\npx_bench  simd %s x%d  %s  cycles %s\n\n", simd_name(), PX_SIMD_WIDTH,
+		(sizeof(SAMPLE_TYPE) == sizeof(double)) ? "double" : "float", counter_name());
+	printf("%-24s %-6s %6s %12s %14s %12s\n", "processor", "mode", "block", "ns/sample", "samples/s", "cycles/sample");
+	for (int index = 0; index < num_results; ++index)
+	{
+		const bench_result* result = &results[index];
+		printf("%-24s %-6s %6d %12.3f %14.0f %12.2f\n", result->benchmark->processor, result->benchmark->mode, result->block,
+			result->ns_per_sample, 1.0e9 / result->ns_per_sample, result->cycles_per_sample);
+	}
+
+	int status = write_json(json_path, results, num_results, repetitions) ? 0 : 1;
+	if (status == 0 && baseline_path)
+	{
+		int regressions = compare_baseline(baseline_path, results, num_results, tolerance);
+		if (regressions != 0)
+			status = 1;
+		if (regressions >= 0)
+			printf("\n%d regression(s) over %.0f%% against %s\n", regressions, 100.0 * tolerance, baseline_path);
+	}
+
+	counter_close();
+	processors_free(processors);
+	free(processors);
+	free(results);
+	for (int channel = 0; channel < BENCH_CHANNELS; ++channel)
+	{
+		free(source[channel]);
+		free(work[channel]);
+	}
+	return status;
+}
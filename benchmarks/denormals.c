@@ -0,0 +1,185 @@
+/*
+	denormals.c
+
+	silent input must cost what loud input costs. an impulse followed by silence leaves every
+	recursive state decaying toward zero, through the subnormal range, where x86 runs ~100x
+	slower. the chain here (equalizer, multiband, feedback delay) is timed on noise and on that
+	decaying silence, ns/sample for each and the ratio. the raw recurrence at the top has no
+	protection at all and shows the stall being avoided.
+
+	build:
+		cc -O2 -Isource benchmarks/denormals.c -o denormals -lm -lpthread
+		./denormals
+
+	ratio ~1.0 for the chain is the pass, the raw recurrence's silent time is the failure mode.
+*/
+
+#include "px_multiband.h"
+#include "px_equalizer.h"
+#include "px_delay.h"
+
+#if !defined(_WIN32)
+#include <time.h>
+#else
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#define SAMPLE_RATE 48000.f
+#define BLOCK 256
+#define SECONDS 8
+
+static double now_ns(void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double)counter.QuadPart * 1.0e9 / (double)frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1.0e9 + (double)time.tv_nsec;
+#endif
+}
+
+static unsigned int seed = 1;
+static SAMPLE_TYPE noise(void)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (SAMPLE_TYPE)((int)(seed >> 9) - (1 << 22)) / (SAMPLE_TYPE)(1 << 23);	// -6 dBFS white
+}
+
+// ----------------------------------------------------------------------------------------------------
+// unprotected: a slow one-pole pair left to ring out, fp mode forced back to IEEE
+
+static double raw_recurrence(const SAMPLE_TYPE* input, int num_samples)
+{
+	volatile SAMPLE_TYPE sink = 0;
+#ifdef PX_DOUBLE_BUFFER
+	SAMPLE_TYPE z1 = 1.0e-300, z2 = 1.0e-300;
+#else
+	SAMPLE_TYPE z1 = 1.0e-30f, z2 = 1.0e-30f;
+#endif
+
+	double start = now_ns();
+	for (int i = 0; i < num_samples; ++i)
+	{
+		z1 = input[i] + (SAMPLE_TYPE)0.9999 * z1;
+		z2 = z1 + (SAMPLE_TYPE)0.9998 * z2;
+		sink = z2;
+	}
+	(void)sink;
+	return (now_ns() - start) / num_samples;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// protected: the library chain, block entry points and state flushing as shipped
+
+typedef struct
+{
+	px_mono_equalizer equalizer;
+	px_mono_multiband multiband;
+	px_delay_line delay;
+} chain;
+
+static void chain_initialize(chain* c)
+{
+	px_equalizer_mono_initialize(&c->equalizer, SAMPLE_RATE);
+	px_equalizer_mono_add_band(&c->equalizer, 40.f, 4.f, 0.f, BIQUAD_HIGHPASS);
+	px_equalizer_mono_add_band(&c->equalizer, 120.f, 8.f, 6.f, BIQUAD_PEAK);
+	px_equalizer_mono_add_band(&c->equalizer, 2500.f, 0.7f, -3.f, BIQUAD_PEAK);
+	px_equalizer_mono_add_band(&c->equalizer, 9000.f, 0.7f, 0.f, BIQUAD_LOWPASS);
+
+	px_multiband_mono_initialize(&c->multiband, SAMPLE_RATE, 4);
+	px_multiband_mono_set_crossover(&c->multiband, 0, 150.f);
+	px_multiband_mono_set_crossover(&c->multiband, 1, 1200.f);
+	px_multiband_mono_set_crossover(&c->multiband, 2, 6000.f);
+
+	px_delay_mono_initialize(&c->delay, SAMPLE_RATE, 1.f);
+	px_delay_mono_set_time(&c->delay, 0.25f);
+	px_delay_mono_set_feedback(&c->delay, 0.7f);
+}
+
+static void chain_free(chain* c)
+{
+	while (c->equalizer.num_bands > 0)
+		px_equalizer_mono_remove_band(&c->equalizer, 0);
+	for (int band = 0; band < PX_MULTIBAND_MAX_BANDS; ++band)
+		px_compressor_mono_free_detector(&c->multiband.bands[band]);
+	px_delay_mono_free_buffer(&c->delay);
+}
+
+static double chain_run(chain* c, SAMPLE_TYPE* buffer, int num_samples)
+{
+	double start = now_ns();
+	for (int offset = 0; offset + BLOCK <= num_samples; offset += BLOCK)
+	{
+		SAMPLE_TYPE* block = buffer + offset;
+		px_equalizer_mono_process_block(&c->equalizer, block, BLOCK);
+		px_multiband_mono_process_block(&c->multiband, block, BLOCK);
+		for (int i = 0; i < BLOCK; ++i)
+			px_delay_mono_process(&c->delay, block + i);
+	}
+	return (now_ns() - start) / num_samples;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(void)
+{
+	const int num_samples = (int)SAMPLE_RATE * SECONDS;
+	SAMPLE_TYPE* loud = (SAMPLE_TYPE*)malloc(sizeof(SAMPLE_TYPE) * num_samples);
+	SAMPLE_TYPE* silent = (SAMPLE_TYPE*)malloc(sizeof(SAMPLE_TYPE) * num_samples);
+	SAMPLE_TYPE* work = (SAMPLE_TYPE*)malloc(sizeof(SAMPLE_TYPE) * num_samples);
+	assert(loud && silent && work);
+
+	for (int i = 0; i < num_samples; ++i)
+	{
+		loud[i] = noise();
+		silent[i] = 0.f;
+	}
+
+	// raw, IEEE mode whatever the host set
+#ifdef PX_FTZ
+	px_fp_mode mode = px_fp_mode_get();
+	px_fp_mode_set(mode & ~PX_FTZ_BITS);
+#endif
+	double raw_loud = raw_recurrence(loud, num_samples);
+	double raw_silent = raw_recurrence(silent, num_samples);
+#ifdef PX_FTZ
+	px_fp_mode_set(mode);
+#endif
+
+	// chain, excited by a second of noise, then timed on noise or on its decaying tail
+	chain c;
+	double chain_loud, chain_silent;
+
+	chain_initialize(&c);
+	memcpy(work, loud, sizeof(SAMPLE_TYPE) * num_samples);
+	chain_run(&c, work, (int)SAMPLE_RATE);
+	memcpy(work, loud, sizeof(SAMPLE_TYPE) * num_samples);
+	chain_loud = chain_run(&c, work, num_samples);
+	chain_free(&c);
+
+	chain_initialize(&c);
+	memcpy(work, loud, sizeof(SAMPLE_TYPE) * num_samples);
+	chain_run(&c, work, (int)SAMPLE_RATE);
+	memcpy(work, silent, sizeof(SAMPLE_TYPE) * num_samples);
+	chain_silent = chain_run(&c, work, num_samples);
+	chain_free(&c);
+
+	printf("%-28s %10s %10s %8s\n", "", "loud", "silent", "ratio");
+	printf("%-28s %7.2f ns %7.2f ns %8.2f\n", "raw recurrence, no guard", raw_loud, raw_silent, raw_silent / raw_loud);
+	printf("%-28s %7.2f ns %7.2f ns %8.2f\n", "eq > multiband > delay", chain_loud, chain_silent, chain_silent / chain_loud);
+
+	free(loud);
+	free(silent);
+	free(work);
+	return 0;
+}
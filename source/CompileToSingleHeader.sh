@@ -4,7 +4,7 @@
 output_file="../px_audio.h"
 > "$output_file" 
 
-header_files=("px_globals.h" "px_memory.h" "px_vector.h" "px_buffer.h" "px_converter.h" "px_delay.h" "px_biquad.h" "px_saturator.h" "px_clip.h" "px_equalizer.h" "px_compressor.h")
+header_files=("px_globals.h" "px_simd.h" "px_silence.h" "px_memory.h" "px_profile.h" "px_vector.h" "px_buffer.h" "px_meter.h" "px_smoother.h" "px_detector.h" "px_gain_curve.h" "px_converter.h" "px_delay.h" "px_biquad.h" "px_filter_design.h" "px_saturator.h" "px_clip.h" "px_limiter.h" "px_equalizer.h" "px_compressor.h" "px_multiband.h" "px_linked.h" "px_batch.h" "px_graph.h" "px_executor.h")
 
 cat "${header_files[0]}" >> "$output_file"
 
@@ -0,0 +1,567 @@
+#include "px_globals.h"
+#include "px_simd.h"
+#include "px_memory.h"
+#include "px_equalizer.h"
+#include "px_compressor.h"
+#include "px_saturator.h"
+#include "px_profile.h"
+
+#ifndef PX_BATCH_H
+#define PX_BATCH_H
+
+/*
+	px_batch.h
+
+	many independent instances of one processor run side by side in SIMD lanes, PX_BATCH_LANES
+	instances per group (4 on SSE/NEON, 8 on AVX float, 16 on AVX-512). every lane has its own
+	parameters and state, there is no linking between instances. one stream per instance, in place.
+
+	the instances stay the place settings live: set them up with their usual setters, the batch
+	reads them at the start of each process call (smoothers advance by the block, glides step at
+	block rate). the filter and envelope state lives in the batch, the instances' own state is
+	not touched, so an instance is either batched or processed on its own, not both.
+
+	px_batch_compressor	px_mono_compressor through px_compressor_lanes: ratio / knee transfer,
+				peak detector, no sidechain eq or meter
+	px_batch_equalizer	px_mono_equalizer, band n of every instance is one SoA biquad (transposed
+				direct form II, svf bands are designed as direct form), instances with
+				fewer bands get unity stages. coefficients are redesigned only when a
+				band's parameters change
+	px_batch_saturator	px_saturator, per-lane drive ramp and curve
+
+	streams are transposed to [sample][lane] one chunk at a time, so a chain (eq, compressor,
+	saturator) is three batch calls over the same streams.
+
+	init:
+		px_mono_compressor compressors[1000];		// set up as usual
+		px_mono_compressor* instances[1000];		// &compressors[n]
+
+		px_batch_compressor batch;
+		px_batch_compressor_initialize(&batch, instances, 1000);	// copies the pointer list
+		px_batch_compressor_free(&batch);
+
+	use:
+		px_batch_equalizer_process(&equalizers, streams, num_samples);	// SAMPLE_TYPE* streams[num_instances]
+		px_batch_compressor_process(&compressors, streams, num_samples);
+		px_batch_saturator_process(&saturators, streams, num_samples);
+*/
+
+#define PX_BATCH_LANES PX_SIMD_WIDTH
+#define PX_BATCH_CHUNK 64
+
+// one band slot of a group, a direct form biquad per lane
+typedef struct
+{
+	SAMPLE_TYPE a0[PX_BATCH_LANES];
+	SAMPLE_TYPE a1[PX_BATCH_LANES];
+	SAMPLE_TYPE a2[PX_BATCH_LANES];
+	SAMPLE_TYPE b1[PX_BATCH_LANES];
+	SAMPLE_TYPE b2[PX_BATCH_LANES];
+	SAMPLE_TYPE z1[PX_BATCH_LANES];
+	SAMPLE_TYPE z2[PX_BATCH_LANES];
+} px_batch_biquad;
+
+typedef struct
+{
+	px_mono_compressor** instances;
+	int num_instances;
+	int num_groups;
+	px_compressor_lanes* groups;
+} px_batch_compressor;
+
+typedef struct
+{
+	px_mono_equalizer** instances;
+	int num_instances;
+	int num_groups;
+	px_batch_biquad* stages;		// MAX_BANDS per group
+	px_biquad_parameters* designed;		// parameters behind each stage lane's coefficients
+} px_batch_equalizer;
+
+typedef struct
+{
+	px_saturator** instances;
+	int num_instances;
+	int num_groups;
+} px_batch_saturator;
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_batch_compressor* px_batch_compressor_create(px_mono_compressor** instances, int num_instances);
+static void px_batch_compressor_destroy(px_batch_compressor* batch);
+static void px_batch_compressor_initialize(px_batch_compressor* batch, px_mono_compressor** instances, int num_instances);
+static void px_batch_compressor_free(px_batch_compressor* batch);
+static void px_batch_compressor_process(px_batch_compressor* batch, SAMPLE_TYPE** streams, int num_samples);
+static int px_batch_compressor_latency_samples(const px_batch_compressor* batch);	// 0, like px_compressor_mono_latency_samples
+
+static px_batch_equalizer* px_batch_equalizer_create(px_mono_equalizer** instances, int num_instances);
+static void px_batch_equalizer_destroy(px_batch_equalizer* batch);
+static void px_batch_equalizer_initialize(px_batch_equalizer* batch, px_mono_equalizer** instances, int num_instances);
+static void px_batch_equalizer_free(px_batch_equalizer* batch);
+static void px_batch_equalizer_process(px_batch_equalizer* batch, SAMPLE_TYPE** streams, int num_samples);
+static int px_batch_equalizer_latency_samples(const px_batch_equalizer* batch);	// 0
+
+static px_batch_saturator* px_batch_saturator_create(px_saturator** instances, int num_instances);
+static void px_batch_saturator_destroy(px_batch_saturator* batch);
+static void px_batch_saturator_initialize(px_batch_saturator* batch, px_saturator** instances, int num_instances);
+static void px_batch_saturator_free(px_batch_saturator* batch);
+static void px_batch_saturator_process(px_batch_saturator* batch, SAMPLE_TYPE** streams, int num_samples);
+static int px_batch_saturator_latency_samples(const px_batch_saturator* batch);	// 0
+
+// ----------------------------------------------------------------------------------------------------
+
+static int px_batch_group_size(int num_instances, int group);
+static void px_batch_gather(SAMPLE_TYPE** streams, int count, int offset, SAMPLE_TYPE* lanes, int num_samples);
+static void px_batch_scatter(SAMPLE_TYPE** streams, int count, int offset, const SAMPLE_TYPE* lanes, int num_samples);
+
+static void px_batch_compressor_update(px_batch_compressor* batch, int group, int num_samples);
+static int px_batch_equalizer_update(px_batch_equalizer* batch, int group, int num_samples);
+static bool px_batch_parameters_equal(const px_biquad_parameters* a, const px_biquad_parameters* b);
+static void px_batch_biquad_clear(px_batch_biquad* stage, int lane);
+static void px_batch_biquad_block(px_batch_biquad* stage, SAMPLE_TYPE* lanes, int num_samples);
+static void px_batch_saturate_block(SAMPLE_TYPE* lanes, int num_samples, const SAMPLE_TYPE* gain_start, const SAMPLE_TYPE* gain_end,
+				    const SAMPLE_TYPE* tangent, int num_tangent, int count);
+
+// ----------------------------------------------------------------------------------------------------
+// compressor
+
+static px_batch_compressor* px_batch_compressor_create(px_mono_compressor** instances, int num_instances)
+{
+	px_batch_compressor* batch = (px_batch_compressor*)px_malloc(sizeof(px_batch_compressor));
+	if (batch)
+		px_batch_compressor_initialize(batch, instances, num_instances);
+	return batch;
+}
+
+static void px_batch_compressor_destroy(px_batch_compressor* batch)
+{
+	if (batch)
+	{
+		px_batch_compressor_free(batch);
+		px_free(batch);
+	}
+}
+
+static void px_batch_compressor_initialize(px_batch_compressor* batch, px_mono_compressor** instances, int num_instances)
+{
+	px_assert(batch, instances);
+	assert(num_instances >= 1);
+
+	batch->num_instances = num_instances;
+	batch->num_groups = (num_instances + PX_BATCH_LANES - 1) / PX_BATCH_LANES;
+	batch->instances = (px_mono_compressor**)px_malloc(sizeof(px_mono_compressor*) * num_instances);
+	batch->groups = (px_compressor_lanes*)px_malloc(sizeof(px_compressor_lanes) * batch->num_groups);
+
+	memcpy(batch->instances, instances, sizeof(px_mono_compressor*) * num_instances);
+	for (int group = 0; group < batch->num_groups; ++group)
+		px_compressor_lanes_initialize(&batch->groups[group]);
+}
+
+static void px_batch_compressor_free(px_batch_compressor* batch)
+{
+	assert(batch);
+	px_free(batch->instances);
+	px_free(batch->groups);
+	batch->num_instances = 0;
+	batch->num_groups = 0;
+}
+
+static void px_batch_compressor_process(px_batch_compressor* batch, SAMPLE_TYPE** streams, int num_samples)
+{
+	px_assert(batch, streams);
+	PX_PROFILE_BEGIN("px_batch_compressor", batch);
+	px_fp_mode mode = px_denormals_disable();
+
+	for (int group = 0; group < batch->num_groups; ++group)
+	{
+		px_batch_compressor_update(batch, group, num_samples);
+		px_compressor_lanes_process_channels(&batch->groups[group], streams + group * PX_BATCH_LANES,
+						     px_batch_group_size(batch->num_instances, group), num_samples);
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+static int px_batch_compressor_latency_samples(const px_batch_compressor* batch)
+{
+	assert(batch);
+	return 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// equalizer
+
+static px_batch_equalizer* px_batch_equalizer_create(px_mono_equalizer** instances, int num_instances)
+{
+	px_batch_equalizer* batch = (px_batch_equalizer*)px_malloc(sizeof(px_batch_equalizer));
+	if (batch)
+		px_batch_equalizer_initialize(batch, instances, num_instances);
+	return batch;
+}
+
+static void px_batch_equalizer_destroy(px_batch_equalizer* batch)
+{
+	if (batch)
+	{
+		px_batch_equalizer_free(batch);
+		px_free(batch);
+	}
+}
+
+static void px_batch_equalizer_initialize(px_batch_equalizer* batch, px_mono_equalizer** instances, int num_instances)
+{
+	px_assert(batch, instances);
+	assert(num_instances >= 1);
+
+	batch->num_instances = num_instances;
+	batch->num_groups = (num_instances + PX_BATCH_LANES - 1) / PX_BATCH_LANES;
+	batch->instances = (px_mono_equalizer**)px_malloc(sizeof(px_mono_equalizer*) * num_instances);
+	batch->stages = (px_batch_biquad*)px_malloc(sizeof(px_batch_biquad) * batch->num_groups * MAX_BANDS);
+	batch->designed = (px_biquad_parameters*)px_malloc(sizeof(px_biquad_parameters) * batch->num_groups * MAX_BANDS * PX_BATCH_LANES);
+
+	memcpy(batch->instances, instances, sizeof(px_mono_equalizer*) * num_instances);
+
+	// zeroed parameters never match a real band, the first update designs everything
+	memset(batch->designed, 0, sizeof(px_biquad_parameters) * batch->num_groups * MAX_BANDS * PX_BATCH_LANES);
+	for (int stage = 0; stage < batch->num_groups * MAX_BANDS; ++stage)
+		for (int lane = 0; lane < PX_BATCH_LANES; ++lane)
+			px_batch_biquad_clear(&batch->stages[stage], lane);
+}
+
+static void px_batch_equalizer_free(px_batch_equalizer* batch)
+{
+	assert(batch);
+	px_free(batch->instances);
+	px_free(batch->stages);
+	px_free(batch->designed);
+	batch->num_instances = 0;
+	batch->num_groups = 0;
+}
+
+static void px_batch_equalizer_process(px_batch_equalizer* batch, SAMPLE_TYPE** streams, int num_samples)
+{
+	px_assert(batch, streams);
+	PX_PROFILE_BEGIN("px_batch_equalizer", batch);
+	px_fp_mode mode = px_denormals_disable();
+
+	SAMPLE_TYPE lanes[PX_BATCH_CHUNK * PX_BATCH_LANES];
+	for (int group = 0; group < batch->num_groups; ++group)
+	{
+		const int count = px_batch_group_size(batch->num_instances, group);
+		const int num_stages = px_batch_equalizer_update(batch, group, num_samples);
+		px_batch_biquad* stages = batch->stages + group * MAX_BANDS;
+
+		if (num_stages == 0)
+			continue;
+
+		for (int offset = 0; offset < num_samples; offset += PX_BATCH_CHUNK)
+		{
+			int chunk = (num_samples - offset < PX_BATCH_CHUNK) ? num_samples - offset : PX_BATCH_CHUNK;
+
+			px_batch_gather(streams + group * PX_BATCH_LANES, count, offset, lanes, chunk);
+			for (int stage = 0; stage < num_stages; ++stage)
+				px_batch_biquad_block(&stages[stage], lanes, chunk);
+			px_batch_scatter(streams + group * PX_BATCH_LANES, count, offset, lanes, chunk);
+		}
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+static int px_batch_equalizer_latency_samples(const px_batch_equalizer* batch)
+{
+	assert(batch);
+	return 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// saturator
+
+static px_batch_saturator* px_batch_saturator_create(px_saturator** instances, int num_instances)
+{
+	px_batch_saturator* batch = (px_batch_saturator*)px_malloc(sizeof(px_batch_saturator));
+	if (batch)
+		px_batch_saturator_initialize(batch, instances, num_instances);
+	return batch;
+}
+
+static void px_batch_saturator_destroy(px_batch_saturator* batch)
+{
+	if (batch)
+	{
+		px_batch_saturator_free(batch);
+		px_free(batch);
+	}
+}
+
+static void px_batch_saturator_initialize(px_batch_saturator* batch, px_saturator** instances, int num_instances)
+{
+	px_assert(batch, instances);
+	assert(num_instances >= 1);
+
+	batch->num_instances = num_instances;
+	batch->num_groups = (num_instances + PX_BATCH_LANES - 1) / PX_BATCH_LANES;
+	batch->instances = (px_saturator**)px_malloc(sizeof(px_saturator*) * num_instances);
+	memcpy(batch->instances, instances, sizeof(px_saturator*) * num_instances);
+}
+
+static void px_batch_saturator_free(px_batch_saturator* batch)
+{
+	assert(batch);
+	px_free(batch->instances);
+	batch->num_instances = 0;
+	batch->num_groups = 0;
+}
+
+// the drive ramp is the instance's own block ramp, so the instance's ramp_gain is the lane state
+static void px_batch_saturator_process(px_batch_saturator* batch, SAMPLE_TYPE** streams, int num_samples)
+{
+	px_assert(batch, streams);
+	if (num_samples <= 0)
+		return;
+	PX_PROFILE_BEGIN("px_batch_saturator", batch);
+
+	SAMPLE_TYPE lanes[PX_BATCH_CHUNK * PX_BATCH_LANES];
+	SAMPLE_TYPE gain_start[PX_BATCH_LANES];
+	SAMPLE_TYPE gain_end[PX_BATCH_LANES];
+	SAMPLE_TYPE tangent[PX_BATCH_LANES];
+
+	for (int group = 0; group < batch->num_groups; ++group)
+	{
+		const int first = group * PX_BATCH_LANES;
+		const int count = px_batch_group_size(batch->num_instances, group);
+
+		int num_tangent = 0;
+		for (int lane = 0; lane < PX_BATCH_LANES; ++lane)
+		{
+			gain_start[lane] = 0.f;
+			gain_end[lane] = 0.f;
+			tangent[lane] = 0.f;
+			if (lane >= count)
+				continue;
+
+			px_saturator* saturator = batch->instances[first + lane];
+			gain_start[lane] = saturator->ramp_gain;
+			gain_end[lane] = px_smoother_skip(&saturator->smoother, num_samples);
+			tangent[lane] = (saturator->curve == TANGENT) ? 1.f : 0.f;
+			num_tangent += (saturator->curve == TANGENT);
+			saturator->ramp_gain = gain_end[lane];
+		}
+
+		for (int offset = 0; offset < num_samples; offset += PX_BATCH_CHUNK)
+		{
+			int chunk = (num_samples - offset < PX_BATCH_CHUNK) ? num_samples - offset : PX_BATCH_CHUNK;
+
+			// ramp position of this chunk within the block
+			SAMPLE_TYPE chunk_start[PX_BATCH_LANES];
+			SAMPLE_TYPE chunk_end[PX_BATCH_LANES];
+			for (int lane = 0; lane < PX_BATCH_LANES; ++lane)
+			{
+				SAMPLE_TYPE step = (gain_end[lane] - gain_start[lane]) / (SAMPLE_TYPE)num_samples;
+				chunk_start[lane] = gain_start[lane] + step * (SAMPLE_TYPE)offset;
+				chunk_end[lane] = gain_start[lane] + step * (SAMPLE_TYPE)(offset + chunk);
+			}
+
+			px_batch_gather(streams + first, count, offset, lanes, chunk);
+			px_batch_saturate_block(lanes, chunk, chunk_start, chunk_end, tangent, num_tangent, count);
+			px_batch_scatter(streams + first, count, offset, lanes, chunk);
+		}
+	}
+	PX_PROFILE_END(num_samples);
+}
+
+static int px_batch_saturator_latency_samples(const px_batch_saturator* batch)
+{
+	assert(batch);
+	return 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static int px_batch_group_size(int num_instances, int group)
+{
+	int remaining = num_instances - group * PX_BATCH_LANES;
+	return (remaining < PX_BATCH_LANES) ? remaining : PX_BATCH_LANES;
+}
+
+// streams to [sample][lane], lanes past count read silence
+static void px_batch_gather(SAMPLE_TYPE** streams, int count, int offset, SAMPLE_TYPE* lanes, int num_samples)
+{
+	if (count < PX_BATCH_LANES)
+		memset(lanes, 0, sizeof(SAMPLE_TYPE) * PX_BATCH_LANES * num_samples);
+
+	for (int lane = 0; lane < count; ++lane)
+	{
+		const SAMPLE_TYPE* stream = streams[lane] + offset;
+		for (int i = 0; i < num_samples; ++i)
+			lanes[i * PX_BATCH_LANES + lane] = stream[i];
+	}
+}
+
+static void px_batch_scatter(SAMPLE_TYPE** streams, int count, int offset, const SAMPLE_TYPE* lanes, int num_samples)
+{
+	for (int lane = 0; lane < count; ++lane)
+	{
+		SAMPLE_TYPE* stream = streams[lane] + offset;
+		for (int i = 0; i < num_samples; ++i)
+			stream[i] = lanes[i * PX_BATCH_LANES + lane];
+	}
+}
+
+// same block-rate parameter read as px_multiband: smoothers jump by the block, then the lane copies settings
+static void px_batch_compressor_update(px_batch_compressor* batch, int group, int num_samples)
+{
+	const int first = group * PX_BATCH_LANES;
+	const int count = px_batch_group_size(batch->num_instances, group);
+
+	for (int lane = 0; lane < count; ++lane)
+	{
+		px_mono_compressor* compressor = batch->instances[first + lane];
+		if (px_compressor_is_smoothing(compressor))
+		{
+			compressor->parameters.threshold = px_smoother_skip(&compressor->smoothing.threshold, num_samples);
+			compressor->parameters.ratio = px_smoother_skip(&compressor->smoothing.ratio, num_samples);
+			compressor->parameters.makeup_gain = px_smoother_skip(&compressor->smoothing.makeup_gain, num_samples);
+			compressor->makeup = dB2lin(compressor->parameters.makeup_gain);
+		}
+		px_compressor_lanes_set(&batch->groups[group], lane, compressor);
+	}
+}
+
+// designs the stages whose band parameters moved, returns the group's stage count
+static int px_batch_equalizer_update(px_batch_equalizer* batch, int group, int num_samples)
+{
+	const int first = group * PX_BATCH_LANES;
+	const int count = px_batch_group_size(batch->num_instances, group);
+	px_batch_biquad* stages = batch->stages + group * MAX_BANDS;
+	px_biquad_parameters* designed = batch->designed + group * MAX_BANDS * PX_BATCH_LANES;
+
+	int num_stages = 0;
+	for (int lane = 0; lane < count; ++lane)
+	{
+		int num_bands = batch->instances[first + lane]->num_bands;
+		num_stages = (num_bands > num_stages) ? num_bands : num_stages;
+	}
+
+	for (int stage = 0; stage < num_stages; ++stage)
+	{
+		for (int lane = 0; lane < count; ++lane)
+		{
+			px_mono_equalizer* equalizer = batch->instances[first + lane];
+			px_biquad_parameters* last = &designed[stage * PX_BATCH_LANES + lane];
+
+			if (stage >= equalizer->num_bands)
+			{
+				if (last->sample_rate != 0.f)
+				{
+					px_batch_biquad_clear(&stages[stage], lane);
+					memset(last, 0, sizeof(px_biquad_parameters));
+				}
+				continue;
+			}
+
+			px_biquad* biquad = (px_biquad*)px_vector_get(&equalizer->filter_bank, stage);
+			if (px_biquad_is_smoothing(biquad))
+			{
+				biquad->parameters.frequency = px_smoother_skip(&biquad->smoothing.frequency, num_samples);
+				biquad->parameters.quality = px_smoother_skip(&biquad->smoothing.quality, num_samples);
+				biquad->parameters.gain = px_smoother_skip(&biquad->smoothing.gain, num_samples);
+				biquad->modulation.remaining = 0;
+				biquad->modulation.pending = false;
+			}
+
+			const px_biquad_parameters parameters = biquad->parameters;
+			if (px_batch_parameters_equal(&parameters, last))
+				continue;
+
+			px_biquad_coefficients coefficients;
+			px_biquad_update_coefficients(parameters, &coefficients);
+			stages[stage].a0[lane] = coefficients.a0;
+			stages[stage].a1[lane] = coefficients.a1;
+			stages[stage].a2[lane] = coefficients.a2;
+			stages[stage].b1[lane] = coefficients.b1;
+			stages[stage].b2[lane] = coefficients.b2;
+			*last = parameters;
+		}
+	}
+	return num_stages;
+}
+
+// field by field, memcmp would read the padding after lookup
+static bool px_batch_parameters_equal(const px_biquad_parameters* a, const px_biquad_parameters* b)
+{
+	return a->sample_rate == b->sample_rate
+		&& a->frequency == b->frequency
+		&& a->quality == b->quality
+		&& a->gain == b->gain
+		&& a->type == b->type
+		&& a->lookup == b->lookup
+		&& a->topology == b->topology;
+}
+
+static void px_batch_biquad_clear(px_batch_biquad* stage, int lane)
+{
+	stage->a0[lane] = 1.f;
+	stage->a1[lane] = 0.f;
+	stage->a2[lane] = 0.f;
+	stage->b1[lane] = 0.f;
+	stage->b2[lane] = 0.f;
+	stage->z1[lane] = 0.f;
+	stage->z2[lane] = 0.f;
+}
+
+// one recurrence step per sample for every lane, coefficients and state in registers
+static void px_batch_biquad_block(px_batch_biquad* stage, SAMPLE_TYPE* lanes, int num_samples)
+{
+	const px_simd a0 = px_simd_load(stage->a0);
+	const px_simd a1 = px_simd_load(stage->a1);
+	const px_simd a2 = px_simd_load(stage->a2);
+	const px_simd b1 = px_simd_load(stage->b1);
+	const px_simd b2 = px_simd_load(stage->b2);
+	px_simd z1 = px_simd_load(stage->z1);
+	px_simd z2 = px_simd_load(stage->z2);
+
+	for (int i = 0; i < num_samples; ++i)
+	{
+		px_simd in = px_simd_load(lanes + i * PX_BATCH_LANES);
+		px_simd out = px_simd_mul_add(in, a0, z1);
+		z1 = px_simd_sub(px_simd_mul_add(in, a1, z2), px_simd_mul(b1, out));
+		z2 = px_simd_sub(px_simd_mul(in, a2), px_simd_mul(b2, out));
+		px_simd_store(lanes + i * PX_BATCH_LANES, out);
+	}
+
+	// px_flush_denormal per lane
+	const px_simd threshold = px_simd_set1((SAMPLE_TYPE)PX_DENORMAL_THRESHOLD);
+	const px_simd zero = px_simd_set1(0);
+	px_simd_store(stage->z1, px_simd_select(px_simd_less(px_simd_abs(z1), threshold), zero, z1));
+	px_simd_store(stage->z2, px_simd_select(px_simd_less(px_simd_abs(z2), threshold), zero, z2));
+}
+
+// per-lane drive ramp landing on gain_end at the last sample, curve picked per lane
+static void px_batch_saturate_block(SAMPLE_TYPE* lanes, int num_samples, const SAMPLE_TYPE* gain_start, const SAMPLE_TYPE* gain_end,
+				    const SAMPLE_TYPE* tangent, int num_tangent, int count)
+{
+	px_simd start = px_simd_load(gain_start);
+	px_simd step = px_simd_div(px_simd_sub(px_simd_load(gain_end), start), px_simd_set1((SAMPLE_TYPE)num_samples));
+	px_simd gain = px_simd_add(start, step);
+	px_simd blend = px_simd_load(tangent);
+
+	for (int i = 0; i < num_samples; ++i)
+	{
+		px_simd x = px_simd_mul(px_simd_load(lanes + i * PX_BATCH_LANES), gain);
+		px_simd y;
+		if (num_tangent == 0)
+			y = px_simd_atan(x);
+		else if (num_tangent == count)
+			y = px_simd_tanh(x);
+		else
+		{
+			px_simd arctangent = px_simd_atan(x);
+			y = px_simd_mul_add(blend, px_simd_sub(px_simd_tanh(x), arctangent), arctangent);
+		}
+		px_simd_store(lanes + i * PX_BATCH_LANES, y);
+		gain = px_simd_add(gain, step);
+	}
+}
+
+#endif
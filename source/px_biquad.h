@@ -1,4 +1,7 @@
 #include "px_globals.h"
+#include "px_smoother.h"
+#include "px_silence.h"
+#include "px_profile.h"
 
 #ifndef PX_BIQUAD_H
 #define PX_BIQUAD_H
@@ -21,17 +24,41 @@ typedef enum {
    BIQUAD_ALLPASS
 } BIQUAD_FILTER_TYPE;
 
+typedef enum {
+   BIQUAD_DIRECT_FORM,  // transposed direct form II, the default
+   BIQUAD_SVF           // zero-delay-feedback state variable filter, see px_biquad_svf
+} BIQUAD_TOPOLOGY;
+
 typedef struct 
 {
-   float a0;
-   float a1;
-   float a2;
-   float b1;
-   float b2;
-   float z1;
-   float z2;
+   SAMPLE_TYPE a0;
+   SAMPLE_TYPE a1;
+   SAMPLE_TYPE a2;
+   SAMPLE_TYPE b1;
+   SAMPLE_TYPE b2;
+   SAMPLE_TYPE z1;
+   SAMPLE_TYPE z2;
 } px_biquad_coefficients;
 
+/*
+   state variable filter (Simper / Cytomic, trapezoidal integrators)
+
+   same prewarped bilinear responses as the direct form coefficients, but the state lives in two
+   integrators instead of the output history. the coefficients stay well conditioned at low f / fs
+   (sidechain high-pass, sub-bass bands) and every g > 0, k > 0 is stable, so they can move every sample.
+   an update is one tan and one divide:
+
+   g = tan(PI * f / fs), k = 1 / Q (scaled for cut peaks and shelves)
+   output = m0 * input + m1 * band + m2 * low
+*/
+typedef struct
+{
+   SAMPLE_TYPE g, k;            // integrator gain, damping
+   SAMPLE_TYPE a1, a2, a3;      // derived from g and k by px_biquad_svf_prepare
+   SAMPLE_TYPE m0, m1, m2;      // input, band and low mix
+   SAMPLE_TYPE ic1eq, ic2eq;    // integrator states
+} px_biquad_svf;
+
 typedef struct
 {
    float sample_rate;
@@ -39,12 +66,74 @@ typedef struct
    float quality;
    float gain;
    BIQUAD_FILTER_TYPE type;
+   bool lookup;         // take K and V from px_biquad_lookup instead of tan/pow
+   BIQUAD_TOPOLOGY topology;
 } px_biquad_parameters;
 
+/*
+   coefficient lookup tables
+
+   K = tan(PI * f / fs) over normalized frequency and V = 10^(dB / 20) over dB, linearly interpolated.
+   both tables are sample-rate independent, so one shared copy is built by px_biquad_lookup_initialize()
+   (called from px_equalizer_mono_initialize and px_biquad_set_lookup) and every biquad with
+   parameters.lookup set reads from it. the first caller builds, concurrent callers wait for the
+   atomic state to say ready, after that it is a single acquire load.
+   off by default, an equalizer opts in with px_equalizer_mono_set_lookup.
+
+   K is spaced uniformly in f / fs: tan is close to linear at low frequencies, so uniform points are
+   accurate without needing a log to compute the index. outside the covered range the exact functions are used.
+
+   error bound: K < 4e-5 relative (worst just below 0.49 fs), V and sqrt(V) < 3e-5 relative.
+   at 48 kHz the magnitude response stays within 0.01 dB of the exact design for bands above 300 Hz.
+   below that the float direct-form coefficients themselves dominate, the exact path shows the same
+   rounding spread
+*/
+
+#define PX_BIQUAD_K_TABLE_SIZE 4096
+#define PX_BIQUAD_K_TABLE_LIMIT 0.49f     // f / fs covered by the K table
+#define PX_BIQUAD_V_TABLE_RANGE 60        // dB
+#define PX_BIQUAD_V_TABLE_STEPS 8         // points per dB
+
+typedef struct
+{
+   px_atomic_int state;  // 0 empty, 1 building, 2 ready
+   float k[PX_BIQUAD_K_TABLE_SIZE + 2];
+   float v[PX_BIQUAD_V_TABLE_RANGE * PX_BIQUAD_V_TABLE_STEPS + 2];
+} px_biquad_table;
+
+static px_biquad_table px_biquad_lookup;
+
+// setters glide frequency, quality and gain when a smoothing time is set
+typedef struct
+{
+   px_smoother frequency;
+   px_smoother quality;
+   px_smoother gain;
+} px_biquad_smoothing;
+
+// modulation mode: coefficients are designed once per control block and
+// linearly interpolated in between. the (b1, b2) stability triangle is convex,
+// so every interpolated filter between two stable designs is stable as well.
+// the svf interpolates g, k and the mix instead, any positive g and k is stable
+typedef struct
+{
+   int control_block;                   // samples per coefficient design, 0 = every sample
+   int remaining;                       // samples left in the current ramp
+   bool pending;                        // a setter changed a parameter since the last design
+   px_biquad_coefficients target;       // coefficients at the end of the ramp
+   SAMPLE_TYPE a0, a1, a2, b1, b2;      // per-sample increments
+   px_biquad_svf svf_target;
+   SAMPLE_TYPE g, k, m0, m1, m2;        // svf per-sample increments
+} px_biquad_modulation;
+
 typedef struct
 {
    px_biquad_coefficients coefficients;
+   px_biquad_svf svf;
    px_biquad_parameters parameters;
+   px_biquad_smoothing smoothing;
+   px_biquad_modulation modulation;
+   px_silence silence;                  // block API tail skipping
 } px_biquad;
 
 
@@ -54,39 +143,131 @@ typedef struct
 static px_biquad* px_biquad_create(float sample_rate, BIQUAD_FILTER_TYPE type); 
 static void px_biquad_destroy(px_biquad* biquad);
 
-static void px_biquad_process(px_biquad* biquad, float* input);
+static void px_biquad_process(px_biquad* biquad, SAMPLE_TYPE* input);
+static void px_biquad_process_block(px_biquad* biquad, SAMPLE_TYPE* input, int num_samples);
 static void px_biquad_initialize(px_biquad* biquad, float sample_rate, BIQUAD_FILTER_TYPE type);
 
 static void px_biquad_set_frequency(px_biquad* biquad, float in_frequency);
 static void px_biquad_set_quality(px_biquad* biquad, float in_quality);
 static void px_biquad_set_gain(px_biquad* biquad, float in_gain);
 static void px_biquad_set_type(px_biquad* biquad, BIQUAD_FILTER_TYPE in_type);
+static void px_biquad_set_smoothing(px_biquad* biquad, float in_time);	// ms, 0 = instant
+static void px_biquad_set_modulation(px_biquad* biquad, int control_block);	// samples, 0 = off
+static void px_biquad_set_lookup(px_biquad* biquad, bool lookup);
+static void px_biquad_set_topology(px_biquad* biquad, BIQUAD_TOPOLOGY topology);	// resets the filter state
+static int px_biquad_latency_samples(const px_biquad* biquad);	// 0, minimum phase
+static int px_biquad_tail_samples(const px_biquad* biquad);	// until the slower pole falls PX_SILENCE_DECAY, PX_TAIL_INFINITE while gliding
+static void px_biquad_reset(px_biquad* biquad);	// clears the filter state
+
+static void px_biquad_lookup_initialize();
 
 // ------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 // inline functions
 // ----------------------------------------------------------------------------------
 
-static inline float px_biquad_filter(px_biquad* biquad, float input);
+static inline SAMPLE_TYPE px_biquad_filter(px_biquad* biquad, SAMPLE_TYPE input);
 static inline void px_biquad_update_coefficients(const px_biquad_parameters parameters, px_biquad_coefficients* coefficients);
+static inline void px_biquad_update_terms(const px_biquad_parameters parameters, SAMPLE_TYPE* K, SAMPLE_TYPE* V, SAMPLE_TYPE* sqrt_V);
+static inline void px_biquad_design(px_biquad* biquad);
+
+static inline SAMPLE_TYPE px_biquad_svf_filter(px_biquad_svf* svf, SAMPLE_TYPE input);
+static inline void px_biquad_svf_block(px_biquad_svf* svf, SAMPLE_TYPE* input, int num_samples);
+static inline void px_biquad_update_svf(const px_biquad_parameters parameters, px_biquad_svf* svf);
+static inline void px_biquad_svf_prepare(px_biquad_svf* svf);
+static inline float px_biquad_lookup_k(float normalized_frequency);
+static inline float px_biquad_lookup_v(float gain);
+
+static inline bool px_biquad_is_smoothing(const px_biquad* biquad);
+static inline void px_biquad_smooth(px_biquad* biquad);
+static inline void px_biquad_modulate(px_biquad* biquad);
+static inline void px_biquad_ramp(px_biquad* biquad, int num_samples);
+static inline bool px_biquad_defer_update(px_biquad* biquad, const px_smoother* smoother);
 
 // ---------------------------------------------------------------------------------------
 
-static void px_biquad_process(px_biquad* biquad, float* input)
+static void px_biquad_process(px_biquad* biquad, SAMPLE_TYPE* input)
 {
     px_assert(biquad, input);
-    float mono = *input;
+    if (px_biquad_is_smoothing(biquad))
+        px_biquad_smooth(biquad);
+
+    SAMPLE_TYPE mono = *input;
     *input = px_biquad_filter(biquad, mono);
 }
 
+static void px_biquad_process_block(px_biquad* biquad, SAMPLE_TYPE* input, int num_samples)
+{
+    px_assert(biquad, input);
+    PX_PROFILE_BEGIN("px_biquad", biquad);
+
+    // silent past the tail, nothing left to ring out
+    const bool asleep = biquad->silence.asleep;
+    const bool silent = px_is_silent(input, num_samples);
+    if (px_silence_skip(&biquad->silence, silent, num_samples, silent ? px_biquad_tail_samples(biquad) : PX_TAIL_INFINITE))
+    {
+        if (!asleep)
+            px_biquad_reset(biquad);
+        memset(input, 0, sizeof(SAMPLE_TYPE) * num_samples);
+        PX_PROFILE_END(num_samples);
+        return;
+    }
+
+    px_fp_mode mode = px_denormals_disable();
+    int i = 0;
+    while (i < num_samples && px_biquad_is_smoothing(biquad))
+    {
+        px_biquad_smooth(biquad);
+        input[i] = px_biquad_filter(biquad, input[i]);
+        ++i;
+    }
+
+    if (biquad->parameters.topology == BIQUAD_SVF)
+    {
+        px_biquad_svf_block(&biquad->svf, input + i, num_samples - i);
+        px_denormals_restore(mode);
+        PX_PROFILE_END(num_samples);
+        return;
+    }
+
+    // settled, run the recurrence on local copies
+    px_biquad_coefficients c = biquad->coefficients;
+    for (; i < num_samples; ++i)
+    {
+        SAMPLE_TYPE in = input[i];
+        SAMPLE_TYPE out = in * c.a0 + c.z1;
+        c.z1 = in * c.a1 + c.z2 - c.b1 * out;
+        c.z2 = in * c.a2 - c.b2 * out;
+        input[i] = out;
+    }
+    biquad->coefficients.z1 = px_flush_denormal(c.z1);
+    biquad->coefficients.z2 = px_flush_denormal(c.z2);
+    px_denormals_restore(mode);
+    PX_PROFILE_END(num_samples);
+}
+
 static void px_biquad_initialize(px_biquad* biquad, float sample_rate, BIQUAD_FILTER_TYPE type)
 {
     assert(biquad);
-    px_biquad_parameters parameters = { sample_rate, 100.f, 0.5f, 0.f, type };
+    px_biquad_parameters parameters = { sample_rate, 100.f, 0.5f, 0.f, type, false, BIQUAD_DIRECT_FORM };
     px_biquad_coefficients coefficients = { 1.f, 0.f, 0.0f, 0.0f, 0.0f };
+    px_biquad_svf svf = { 0.f };
     px_biquad_update_coefficients(parameters, &coefficients);
+    px_biquad_update_svf(parameters, &svf);
 
     biquad->parameters = parameters;
     biquad->coefficients = coefficients;
+    biquad->svf = svf;
+
+    px_smoother_initialize(&biquad->smoothing.frequency, sample_rate, 0.f, SMOOTHER_ONE_POLE, parameters.frequency);
+    px_smoother_initialize(&biquad->smoothing.quality, sample_rate, 0.f, SMOOTHER_LINEAR, parameters.quality);
+    px_smoother_initialize(&biquad->smoothing.gain, sample_rate, 0.f, SMOOTHER_LINEAR, parameters.gain);
+
+    biquad->modulation.control_block = 0;
+    biquad->modulation.remaining = 0;
+    biquad->modulation.pending = false;
+    biquad->modulation.target = coefficients;
+    biquad->modulation.svf_target = svf;
+    px_silence_reset(&biquad->silence);
 }
 
 static px_biquad* px_biquad_create(float sample_rate, BIQUAD_FILTER_TYPE type)
@@ -105,8 +286,12 @@ static void px_biquad_destroy(px_biquad* biquad)
 static void px_biquad_set_frequency(px_biquad* biquad, float in_frequency)
 {
     assert(biquad);
+    px_smoother_set_target(&biquad->smoothing.frequency, in_frequency);
+    if (px_biquad_defer_update(biquad, &biquad->smoothing.frequency))
+        return; // process glides there
+
     biquad->parameters.frequency = in_frequency;
-    px_biquad_update_coefficients(biquad->parameters, &biquad->coefficients);
+    px_biquad_design(biquad);
 }
 
 static void px_biquad_set_quality(px_biquad* biquad, float in_quality)
@@ -114,42 +299,338 @@ static void px_biquad_set_quality(px_biquad* biquad, float in_quality)
     assert(biquad);
     if (in_quality > 0.0f)
     {
+        px_smoother_set_target(&biquad->smoothing.quality, in_quality);
+        if (px_biquad_defer_update(biquad, &biquad->smoothing.quality))
+            return;
+
         biquad->parameters.quality = in_quality;
-        px_biquad_update_coefficients(biquad->parameters, &biquad->coefficients);
+        px_biquad_design(biquad);
     }
 }
 
 static void px_biquad_set_gain(px_biquad* biquad, float in_gain)
 {
     assert(biquad);
+    px_smoother_set_target(&biquad->smoothing.gain, in_gain);
+    if (px_biquad_defer_update(biquad, &biquad->smoothing.gain))
+        return;
+
     biquad->parameters.gain = in_gain;
-    px_biquad_update_coefficients(biquad->parameters, &biquad->coefficients);
+    px_biquad_design(biquad);
 }
 
 static void px_biquad_set_type(px_biquad* biquad, BIQUAD_FILTER_TYPE in_type)
 {
     assert(biquad);
     biquad->parameters.type = in_type;
-    px_biquad_update_coefficients(biquad->parameters, &biquad->coefficients);
+    px_biquad_design(biquad);
+}
+
+static void px_biquad_set_smoothing(px_biquad* biquad, float in_time)
+{
+    assert(biquad);
+    px_smoother_set_time(&biquad->smoothing.frequency, in_time);
+    px_smoother_set_time(&biquad->smoothing.quality, in_time);
+    px_smoother_set_time(&biquad->smoothing.gain, in_time);
+}
+
+static void px_biquad_set_lookup(px_biquad* biquad, bool lookup)
+{
+    assert(biquad);
+    if (lookup)
+        px_biquad_lookup_initialize();
+
+    biquad->parameters.lookup = lookup;
+    px_biquad_design(biquad);
+}
+
+static void px_biquad_set_topology(px_biquad* biquad, BIQUAD_TOPOLOGY topology)
+{
+    assert(biquad);
+    if (biquad->parameters.topology == topology)
+        return;
+
+    // the two states don't map onto each other, start from silence
+    biquad->parameters.topology = topology;
+    biquad->coefficients.z1 = 0.f;
+    biquad->coefficients.z2 = 0.f;
+    biquad->svf.ic1eq = 0.f;
+    biquad->svf.ic2eq = 0.f;
+    biquad->modulation.remaining = 0;
+    px_biquad_design(biquad);
+}
+
+static int px_biquad_latency_samples(const px_biquad* biquad)
+{
+    assert(biquad);
+    return 0;
+}
+
+// the svf's poles are the direct form's, b1 and b2 follow from g and k without the tan
+static int px_biquad_tail_samples(const px_biquad* biquad)
+{
+    assert(biquad);
+    if (px_biquad_is_smoothing(biquad))
+        return PX_TAIL_INFINITE;
+
+    if (biquad->parameters.topology == BIQUAD_SVF)
+    {
+        const SAMPLE_TYPE g = biquad->svf.g, k = biquad->svf.k;
+        const SAMPLE_TYPE norm = 1.f / (1.f + g * k + g * g);
+        return px_silence_tail_poles(2.f * (g * g - 1.f) * norm, (1.f - g * k + g * g) * norm);
+    }
+    return px_silence_tail_poles(biquad->coefficients.b1, biquad->coefficients.b2);
+}
+
+static void px_biquad_reset(px_biquad* biquad)
+{
+    assert(biquad);
+    biquad->coefficients.z1 = 0.f;
+    biquad->coefficients.z2 = 0.f;
+    biquad->svf.ic1eq = 0.f;
+    biquad->svf.ic2eq = 0.f;
+}
+
+static void px_biquad_lookup_initialize()
+{
+    int expected = 0;
+    if (px_atomic_load(&px_biquad_lookup.state) == 2)
+        return;
+    if (!px_atomic_compare_exchange(&px_biquad_lookup.state, &expected, 1))
+    {
+        // another thread is building them
+        while (px_atomic_load(&px_biquad_lookup.state) != 2)
+            px_pause();
+        return;
+    }
+
+    for (int i = 0; i < PX_BIQUAD_K_TABLE_SIZE + 2; ++i)
+    {
+        double normalized = (double)i * PX_BIQUAD_K_TABLE_LIMIT / PX_BIQUAD_K_TABLE_SIZE;
+        px_biquad_lookup.k[i] = (float)tan(PI * normalized);
+    }
+
+    for (int i = 0; i < PX_BIQUAD_V_TABLE_RANGE * PX_BIQUAD_V_TABLE_STEPS + 2; ++i)
+    {
+        double gain = (double)i / PX_BIQUAD_V_TABLE_STEPS;
+        px_biquad_lookup.v[i] = (float)pow(10.0, gain / 20.0);
+    }
+
+    px_atomic_store(&px_biquad_lookup.state, 2);
+}
+
+static void px_biquad_set_modulation(px_biquad* biquad, int control_block)
+{
+    assert(biquad);
+    assert(control_block >= 0);
+    biquad->modulation.control_block = control_block;
+
+    if (control_block == 0 && (biquad->modulation.remaining > 0 || biquad->modulation.pending))
+    {
+        // drop the current ramp and design what the setters deferred in one step
+        biquad->modulation.remaining = 0;
+        biquad->modulation.pending = false;
+        biquad->parameters.frequency = biquad->smoothing.frequency.current;
+        biquad->parameters.quality = biquad->smoothing.quality.current;
+        biquad->parameters.gain = biquad->smoothing.gain.current;
+        px_biquad_design(biquad);
+    }
+    assert(control_block > 0 || (biquad->modulation.remaining == 0 && !biquad->modulation.pending));
 }
 
 // ------------------------------------------------------------------------------------------------------------------------------
 
-static inline float px_biquad_filter(px_biquad* biquad, float input)
+static inline SAMPLE_TYPE px_biquad_filter(px_biquad* biquad, SAMPLE_TYPE input)
 {
-    float out = input * biquad->coefficients.a0 + biquad->coefficients.z1;
+    if (biquad->parameters.topology == BIQUAD_SVF)
+        return px_biquad_svf_filter(&biquad->svf, input);
+
+    SAMPLE_TYPE out = input * biquad->coefficients.a0 + biquad->coefficients.z1;
     biquad->coefficients.z1 = input * biquad->coefficients.a1 + biquad->coefficients.z2 - biquad->coefficients.b1 * out;
     biquad->coefficients.z2 = input * biquad->coefficients.a2 - biquad->coefficients.b2 * out;
-    return (float)out;
+    return out;
+}
+
+static inline SAMPLE_TYPE px_biquad_svf_filter(px_biquad_svf* svf, SAMPLE_TYPE input)
+{
+    SAMPLE_TYPE v3 = input - svf->ic2eq;
+    SAMPLE_TYPE v1 = svf->a1 * svf->ic1eq + svf->a2 * v3;
+    SAMPLE_TYPE v2 = svf->ic2eq + svf->a2 * svf->ic1eq + svf->a3 * v3;
+    svf->ic1eq = 2.f * v1 - svf->ic1eq;
+    svf->ic2eq = 2.f * v2 - svf->ic2eq;
+    return svf->m0 * input + svf->m1 * v1 + svf->m2 * v2;
+}
+
+// the integrators are a serial recursion, keep everything in registers
+static inline void px_biquad_svf_block(px_biquad_svf* svf, SAMPLE_TYPE* input, int num_samples)
+{
+    const SAMPLE_TYPE a1 = svf->a1, a2 = svf->a2, a3 = svf->a3;
+    const SAMPLE_TYPE m0 = svf->m0, m1 = svf->m1, m2 = svf->m2;
+    SAMPLE_TYPE ic1eq = svf->ic1eq;
+    SAMPLE_TYPE ic2eq = svf->ic2eq;
+
+    for (int i = 0; i < num_samples; ++i)
+    {
+        SAMPLE_TYPE v0 = input[i];
+        SAMPLE_TYPE v3 = v0 - ic2eq;
+        SAMPLE_TYPE v1 = a1 * ic1eq + a2 * v3;
+        SAMPLE_TYPE v2 = ic2eq + a2 * ic1eq + a3 * v3;
+        ic1eq = 2.f * v1 - ic1eq;
+        ic2eq = 2.f * v2 - ic2eq;
+        input[i] = m0 * v0 + m1 * v1 + m2 * v2;
+    }
+    svf->ic1eq = px_flush_denormal(ic1eq);
+    svf->ic2eq = px_flush_denormal(ic2eq);
+}
+
+// a ramp in flight is aimed at the new design, landing on a stale target would undo the setter
+static inline void px_biquad_design(px_biquad* biquad)
+{
+    if (biquad->modulation.remaining > 0)
+        px_biquad_ramp(biquad, biquad->modulation.remaining);
+    else if (biquad->parameters.topology == BIQUAD_SVF)
+        px_biquad_update_svf(biquad->parameters, &biquad->svf);
+    else
+        px_biquad_update_coefficients(biquad->parameters, &biquad->coefficients);
+}
+
+static inline bool px_biquad_is_smoothing(const px_biquad* biquad)
+{
+    return px_smoother_is_smoothing(&biquad->smoothing.frequency)
+        || px_smoother_is_smoothing(&biquad->smoothing.quality)
+        || px_smoother_is_smoothing(&biquad->smoothing.gain)
+        || biquad->modulation.remaining > 0
+        || biquad->modulation.pending;
+}
+
+// setters skip the coefficient update when smoothing or when modulation mode picks it up
+static inline bool px_biquad_defer_update(px_biquad* biquad, const px_smoother* smoother)
+{
+    if (px_smoother_is_smoothing(smoother))
+        return true;
+
+    if (biquad->modulation.control_block > 0)
+    {
+        biquad->modulation.pending = true;
+        return true;
+    }
+    return false;
+}
+
+// one smoothing step, coefficients are recalculated while any parameter is moving
+static inline void px_biquad_smooth(px_biquad* biquad)
+{
+    if (biquad->modulation.control_block > 0)
+    {
+        px_biquad_modulate(biquad);
+        return;
+    }
+
+    biquad->parameters.frequency = px_smoother_next(&biquad->smoothing.frequency);
+    biquad->parameters.quality = px_smoother_next(&biquad->smoothing.quality);
+    biquad->parameters.gain = px_smoother_next(&biquad->smoothing.gain);
+    px_biquad_design(biquad);
+}
+
+// modulation step: design the coefficients a control block ahead, then ramp towards them
+static inline void px_biquad_modulate(px_biquad* biquad)
+{
+    px_biquad_modulation* modulation = &biquad->modulation;
+
+    if (modulation->remaining == 0)
+    {
+        int block = modulation->control_block;
+        modulation->pending = false;
+
+        biquad->parameters.frequency = px_smoother_skip(&biquad->smoothing.frequency, block);
+        biquad->parameters.quality = px_smoother_skip(&biquad->smoothing.quality, block);
+        biquad->parameters.gain = px_smoother_skip(&biquad->smoothing.gain, block);
+
+        px_biquad_ramp(biquad, block);
+    }
+
+    if (biquad->parameters.topology == BIQUAD_SVF)
+    {
+        px_biquad_svf* svf = &biquad->svf;
+        if (--modulation->remaining == 0)
+        {
+            svf->g = modulation->svf_target.g;
+            svf->k = modulation->svf_target.k;
+            svf->m0 = modulation->svf_target.m0;
+            svf->m1 = modulation->svf_target.m1;
+            svf->m2 = modulation->svf_target.m2;
+        }
+        else
+        {
+            svf->g += modulation->g;
+            svf->k += modulation->k;
+            svf->m0 += modulation->m0;
+            svf->m1 += modulation->m1;
+            svf->m2 += modulation->m2;
+        }
+        px_biquad_svf_prepare(svf);
+        return;
+    }
+
+    if (--modulation->remaining == 0)
+    {
+        // land exactly on the design
+        biquad->coefficients.a0 = modulation->target.a0;
+        biquad->coefficients.a1 = modulation->target.a1;
+        biquad->coefficients.a2 = modulation->target.a2;
+        biquad->coefficients.b1 = modulation->target.b1;
+        biquad->coefficients.b2 = modulation->target.b2;
+    }
+    else
+    {
+        biquad->coefficients.a0 += modulation->a0;
+        biquad->coefficients.a1 += modulation->a1;
+        biquad->coefficients.a2 += modulation->a2;
+        biquad->coefficients.b1 += modulation->b1;
+        biquad->coefficients.b2 += modulation->b2;
+    }
+}
+
+// design the current parameters and step towards them from where the coefficients are now
+static inline void px_biquad_ramp(px_biquad* biquad, int num_samples)
+{
+    px_biquad_modulation* modulation = &biquad->modulation;
+    SAMPLE_TYPE scale = (SAMPLE_TYPE)1 / (SAMPLE_TYPE)num_samples;
+    modulation->remaining = num_samples;
+
+    if (biquad->parameters.topology == BIQUAD_SVF)
+    {
+        px_biquad_svf svf_target = biquad->svf;
+        px_biquad_update_svf(biquad->parameters, &svf_target);
+
+        modulation->svf_target = svf_target;
+        modulation->g = (svf_target.g - biquad->svf.g) * scale;
+        modulation->k = (svf_target.k - biquad->svf.k) * scale;
+        modulation->m0 = (svf_target.m0 - biquad->svf.m0) * scale;
+        modulation->m1 = (svf_target.m1 - biquad->svf.m1) * scale;
+        modulation->m2 = (svf_target.m2 - biquad->svf.m2) * scale;
+    }
+    else
+    {
+        px_biquad_coefficients target = biquad->coefficients;
+        px_biquad_update_coefficients(biquad->parameters, &target);
+
+        modulation->target = target;
+        modulation->a0 = (target.a0 - biquad->coefficients.a0) * scale;
+        modulation->a1 = (target.a1 - biquad->coefficients.a1) * scale;
+        modulation->a2 = (target.a2 - biquad->coefficients.a2) * scale;
+        modulation->b1 = (target.b1 - biquad->coefficients.b1) * scale;
+        modulation->b2 = (target.b2 - biquad->coefficients.b2) * scale;
+    }
 }
 
 static inline void px_biquad_update_coefficients(const px_biquad_parameters parameters, px_biquad_coefficients* coefficients)
 {
-    float a0 = coefficients->a0;
-    float a1 = coefficients->a1;
-    float a2 = coefficients->a2;
-    float b1 = coefficients->b1;
-    float b2 = coefficients->b2;
+    SAMPLE_TYPE a0 = coefficients->a0;
+    SAMPLE_TYPE a1 = coefficients->a1;
+    SAMPLE_TYPE a2 = coefficients->a2;
+    SAMPLE_TYPE b1 = coefficients->b1;
+    SAMPLE_TYPE b2 = coefficients->b2;
 
     if (parameters.frequency <= 0.f || parameters.frequency != parameters.frequency)
     {
@@ -161,12 +642,11 @@ static inline void px_biquad_update_coefficients(const px_biquad_parameters para
         return;
     }
 
-    float norm;
-    float V = pow(10.f, fabs(parameters.gain) / 20.0f);
-    float K = tan(PI * (parameters.frequency / parameters.sample_rate));
+    SAMPLE_TYPE norm;
+    SAMPLE_TYPE V, K, sqrt_V;
+    px_biquad_update_terms(parameters, &K, &V, &sqrt_V);
 
-    //  printf("%d", V);
-    //  printf("%d", K);
+    const SAMPLE_TYPE sqrt_2 = (SAMPLE_TYPE)1.4142135623730951;
 
     switch (parameters.type)
     {
@@ -231,20 +711,20 @@ static inline void px_biquad_update_coefficients(const px_biquad_parameters para
         if (parameters.gain >= 0.f)
         { // boost
             norm = 1.f / (1.f + K / parameters.quality + K * K);
-            a0 = (1.f + sqrt(V) * K / parameters.quality + V * K * K) * norm;
+            a0 = (1.f + sqrt_V * K / parameters.quality + V * K * K) * norm;
             a1 = 2.f * (V * K * K - 1.f) * norm;
-            a2 = (1.f - sqrt(V) * K / parameters.quality + V * K * K) * norm;
+            a2 = (1.f - sqrt_V * K / parameters.quality + V * K * K) * norm;
             b1 = 2.f * (K * K - 1.f) * norm;
             b2 = (1.f - K / parameters.quality + K * K) * norm;
         }
         else
         { // cut
-            norm = 1.f / (1.f + sqrt(V) * K / parameters.quality + V * K * K);
+            norm = 1.f / (1.f + sqrt_V * K / parameters.quality + V * K * K);
             a0 = (1.f + K / parameters.quality + K * K) * norm;
             a1 = 2.f * (K * K - 1.f) * norm;
             a2 = (1 - K / parameters.quality + K * K) * norm;
             b1 = 2.f * (V * K * K - 1.f) * norm;
-            b2 = (1.f - sqrt(V) * K / parameters.quality + V * K * K) * norm;
+            b2 = (1.f - sqrt_V * K / parameters.quality + V * K * K) * norm;
         }
         break;
 
@@ -252,62 +732,62 @@ static inline void px_biquad_update_coefficients(const px_biquad_parameters para
         if (parameters.gain >= 0.f)
         { // boost
             norm = 1 / (1.f + K / parameters.quality + K * K);
-            a0 = (V + sqrt(V) * K / parameters.quality + K * K) * norm;
+            a0 = (V + sqrt_V * K / parameters.quality + K * K) * norm;
             a1 = 2.f * (K * K - V) * norm;
-            a2 = (V - sqrt(V) * K / parameters.quality + K * K) * norm;
+            a2 = (V - sqrt_V * K / parameters.quality + K * K) * norm;
             b1 = 2.f * (K * K - 1.f) * norm;
             b2 = (1.f - K / parameters.quality + K * K) * norm;
         }
         else
         { // cut
-            norm = 1.f / (V + sqrt(V) * K / parameters.quality + K * K);
+            norm = 1.f / (V + sqrt_V * K / parameters.quality + K * K);
             a0 = (1.f + K / parameters.quality + K * K) * norm;
             a1 = 2.f * (K * K - 1.f) * norm;
             a2 = (1.f - K / parameters.quality + K * K) * norm;
             b1 = 2.f * (K * K - V) * norm;
-            b2 = (V - sqrt(V) * K / parameters.quality + K * K) * norm;
+            b2 = (V - sqrt_V * K / parameters.quality + K * K) * norm;
         }
         break;
 
     case BIQUAD_LOWSHELF_NOQ:
         if (parameters.gain >= 0.f)
         { // boost
-            norm = 1.f / (1.f + sqrt(2.f) * K + K * K);
-            a0 = (1.f + sqrt(2.f * V) * K + V * K * K) * norm;
+            norm = 1.f / (1.f + sqrt_2 * K + K * K);
+            a0 = (1.f + (sqrt_2 * sqrt_V) * K + V * K * K) * norm;
             a1 = 2.f * (V * K * K - 1.f) * norm;
-            a2 = (1.f - sqrt(2.f * V) * K + V * K * K) * norm;
+            a2 = (1.f - (sqrt_2 * sqrt_V) * K + V * K * K) * norm;
             b1 = 2.f * (K * K - 1.f) * norm;
-            b2 = (1.f - sqrt(2.f) * K + K * K) * norm;
+            b2 = (1.f - sqrt_2 * K + K * K) * norm;
         }
         else
         { // cut
-            norm = 1.f / (1.f + sqrt(2.f * V) * K + V * K * K);
-            a0 = (1.f + sqrt(2.f) * K + K * K) * norm;
+            norm = 1.f / (1.f + (sqrt_2 * sqrt_V) * K + V * K * K);
+            a0 = (1.f + sqrt_2 * K + K * K) * norm;
             a1 = 2.f * (K * K - 1.f) * norm;
-            a2 = (1.f - sqrt(2.f) * K + K * K) * norm;
+            a2 = (1.f - sqrt_2 * K + K * K) * norm;
             b1 = 2.f * (V * K * K - 1.f) * norm;
-            b2 = (1.f - sqrt(2.f * V) * K + V * K * K) * norm;
+            b2 = (1.f - (sqrt_2 * sqrt_V) * K + V * K * K) * norm;
         }
         break;
 
     case BIQUAD_HIGHSHELF_NOQ:
         if (parameters.gain >= 0.f)
         { // boost
-            norm = 1.f / (1.f + sqrt(2.f) * K + K * K);
-            a0 = (V + sqrt(2.f * V) * K + K * K) * norm;
+            norm = 1.f / (1.f + sqrt_2 * K + K * K);
+            a0 = (V + (sqrt_2 * sqrt_V) * K + K * K) * norm;
             a1 = 2.f * (K * K - V) * norm;
-            a2 = (V - sqrt(2.f * V) * K + K * K) * norm;
+            a2 = (V - (sqrt_2 * sqrt_V) * K + K * K) * norm;
             b1 = 2.f * (K * K - 1.f) * norm;
-            b2 = (1.f - sqrt(2.f) * K + K * K) * norm;
+            b2 = (1.f - sqrt_2 * K + K * K) * norm;
         }
         else
         { // cut
-            norm = 1.f / (V + sqrt(2.f * V) * K + K * K);
-            a0 = (1.f + sqrt(2.f) * K + K * K) * norm;
+            norm = 1.f / (V + (sqrt_2 * sqrt_V) * K + K * K);
+            a0 = (1.f + sqrt_2 * K + K * K) * norm;
             a1 = 2.f * (K * K - 1.f) * norm;
-            a2 = (1.f - sqrt(2.f) * K + K * K) * norm;
+            a2 = (1.f - sqrt_2 * K + K * K) * norm;
             b1 = 2.f * (K * K - V) * norm;
-            b2 = (V - sqrt(2.f * V) * K + K * K) * norm;
+            b2 = (V - (sqrt_2 * sqrt_V) * K + K * K) * norm;
         }
         break;
 
@@ -336,6 +816,168 @@ static inline void px_biquad_update_coefficients(const px_biquad_parameters para
     coefficients->b2 = b2;
 }
 
+// interpolated table reads, falling back to the exact functions outside the tables
+
+// prewarped frequency and linear gain shared by both topologies
+static inline void px_biquad_update_terms(const px_biquad_parameters parameters, SAMPLE_TYPE* K, SAMPLE_TYPE* V, SAMPLE_TYPE* sqrt_V)
+{
+    if (parameters.lookup)
+    {
+        *V = px_biquad_lookup_v(fabsf(parameters.gain));
+        *sqrt_V = px_biquad_lookup_v(0.5f * fabsf(parameters.gain));
+        *K = px_biquad_lookup_k(parameters.frequency / parameters.sample_rate);
+    }
+    else
+    {
+        *V = (SAMPLE_TYPE)pow(10.0, fabs(parameters.gain) / 20.0);
+        *sqrt_V = (SAMPLE_TYPE)sqrt(*V);
+        *K = (SAMPLE_TYPE)tan(PI * ((double)parameters.frequency / parameters.sample_rate));
+    }
+}
+
+/*
+   svf mix for the analog prototype b2 s^2 + b1 s + b0 over s^2 + k s + 1:
+   m0 = b2, m1 = b1 - k * b2, m2 = b0 - b2
+
+   cut peaks and shelves have their gain in the denominator, those widen k (peak)
+   or move g by sqrt(V) (shelves) so the denominator stays s^2 + k s + 1
+*/
+static inline void px_biquad_update_svf(const px_biquad_parameters parameters, px_biquad_svf* svf)
+{
+    svf->g = 0.f;
+    svf->k = 1.f;
+    svf->m0 = 1.f;
+    svf->m1 = 0.f;
+    svf->m2 = 0.f;
+
+    if (parameters.frequency <= 0.f || parameters.frequency != parameters.frequency)
+    {
+        px_biquad_svf_prepare(svf);  // pass through
+        return;
+    }
+
+    SAMPLE_TYPE V, K, sqrt_V;
+    px_biquad_update_terms(parameters, &K, &V, &sqrt_V);
+
+    SAMPLE_TYPE quality = parameters.quality;
+    if (parameters.type == BIQUAD_LOWSHELF_NOQ || parameters.type == BIQUAD_HIGHSHELF_NOQ)
+        quality = (SAMPLE_TYPE)0.70710678118654752;
+
+    const bool boost = parameters.gain >= 0.f;
+    SAMPLE_TYPE g = K;
+    SAMPLE_TYPE k = 1.f / quality;
+    SAMPLE_TYPE m0 = 1.f, m1 = 0.f, m2 = 0.f;
+
+    switch (parameters.type)
+    {
+    case BIQUAD_LOWPASS:
+        m0 = 0.f;
+        m2 = 1.f;
+        break;
+
+    case BIQUAD_HIGHPASS:
+        m1 = -k;
+        m2 = -1.f;
+        break;
+
+    case BIQUAD_BANDPASS:   // 0 dB peak, like the direct form
+        m0 = 0.f;
+        m1 = k;
+        break;
+
+    case BIQUAD_NOTCH:
+        m1 = -k;
+        break;
+
+    case BIQUAD_PEAK:
+        if (boost)
+        {
+            m1 = k * (V - 1.f);
+        }
+        else
+        {
+            k = V / quality;
+            m1 = (1.f - V) / quality;
+        }
+        break;
+
+    case BIQUAD_LOWSHELF:
+    case BIQUAD_LOWSHELF_NOQ:
+        if (boost)
+        {
+            m1 = k * (sqrt_V - 1.f);
+            m2 = V - 1.f;
+        }
+        else
+        {
+            g = K * sqrt_V;
+            m1 = k * (1.f / sqrt_V - 1.f);
+            m2 = 1.f / V - 1.f;
+        }
+        break;
+
+    case BIQUAD_HIGHSHELF:
+    case BIQUAD_HIGHSHELF_NOQ:
+        if (boost)
+        {
+            m0 = V;
+            m1 = k * (sqrt_V - V);
+            m2 = 1.f - V;
+        }
+        else
+        {
+            g = K / sqrt_V;
+            m0 = 1.f / V;
+            m1 = k * (1.f / sqrt_V - 1.f / V);
+            m2 = 1.f - 1.f / V;
+        }
+        break;
+
+    case BIQUAD_ALLPASS:
+        m1 = -2.f * k;
+        break;
+
+    case BIQUAD_NONE:
+        break;
+    }
+
+    svf->g = g;
+    svf->k = k;
+    svf->m0 = m0;
+    svf->m1 = m1;
+    svf->m2 = m2;
+    px_biquad_svf_prepare(svf);
+}
+
+static inline void px_biquad_svf_prepare(px_biquad_svf* svf)
+{
+    svf->a1 = 1.f / (1.f + svf->g * (svf->g + svf->k));
+    svf->a2 = svf->g * svf->a1;
+    svf->a3 = svf->g * svf->a2;
+}
+
+static inline float px_biquad_lookup_k(float normalized_frequency)
+{
+    float position = normalized_frequency * (PX_BIQUAD_K_TABLE_SIZE / PX_BIQUAD_K_TABLE_LIMIT);
+    if (!(position >= 0.f && position < (float)PX_BIQUAD_K_TABLE_SIZE))
+        return tanf((float)PI * normalized_frequency);
+
+    int index = (int)position;
+    float fraction = position - (float)index;
+    return px_biquad_lookup.k[index] + fraction * (px_biquad_lookup.k[index + 1] - px_biquad_lookup.k[index]);
+}
+
+static inline float px_biquad_lookup_v(float gain)
+{
+    float position = gain * (float)PX_BIQUAD_V_TABLE_STEPS;
+    if (!(position >= 0.f && position < (float)(PX_BIQUAD_V_TABLE_RANGE * PX_BIQUAD_V_TABLE_STEPS)))
+        return powf(10.f, gain / 20.f);
+
+    int index = (int)position;
+    float fraction = position - (float)index;
+    return px_biquad_lookup.v[index] + fraction * (px_biquad_lookup.v[index + 1] - px_biquad_lookup.v[index]);
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 #endif
@@ -0,0 +1,376 @@
+#include "px_biquad.h"
+
+#ifndef PX_BIQUAD_HPP
+#define PX_BIQUAD_HPP
+
+#include <tuple>
+
+/*
+	px_biquad.hpp
+
+	optional C++17 layer over px_biquad. the filter type and sample type are template parameters,
+	so coefficient design has no runtime switch, and fixed-parameter filters get their coefficients
+	at compile time and are fully inlined.
+
+	// runtime parameters, compile-time type
+
+		px::biquad<BIQUAD_LOWPASS, double> lowpass;
+		lowpass.set(96000.0, 40.0, 0.707);
+		lowpass.process_block(samples, num_samples);
+
+	// fixed parameters, constexpr coefficients
+
+		px::fixed_biquad<px::dc_blocker<48000>> dc;
+		px::fixed_biquad<px::sidechain_highpass<48000>> sidechain;
+
+		static_assert(px::dc_blocker<48000>::coefficients.a0 > 0.f, "designed at compile time");
+
+	// cascades unroll into straight-line code
+
+		px::cascade<px::fixed_biquad<px::crossover_lowpass<48000, 120>>,
+		            px::fixed_biquad<px::crossover_lowpass<48000, 120>>> lr4_lowpass;
+		float y = lr4_lowpass.process(x);
+
+	design<>() follows px_biquad_update_coefficients() exactly, but runs in double before
+	rounding to the sample type. this header is not part of the single px_audio.h.
+*/
+
+namespace px
+{
+	// constexpr math for the designs, the arguments the designs pass are small and bounded
+	// ------------------------------------------------------------------------------------------
+
+	namespace detail
+	{
+		constexpr double sqrt(double x)
+		{
+			if (x <= 0.0)
+				return 0.0;
+
+			double guess = x > 1.0 ? x : 1.0;
+			for (int i = 0; i < 64; ++i)
+				guess = 0.5 * (guess + x / guess);
+			return guess;
+		}
+
+		constexpr double exp(double x)
+		{
+			// halve until small, taylor, then square back up
+			int halvings = 0;
+			while (x > 0.5 || x < -0.5)
+			{
+				x *= 0.5;
+				++halvings;
+			}
+
+			double sum = 1.0;
+			double term = 1.0;
+			for (int n = 1; n < 20; ++n)
+			{
+				term *= x / n;
+				sum += term;
+			}
+
+			for (int i = 0; i < halvings; ++i)
+				sum *= sum;
+			return sum;
+		}
+
+		// x in [0, PI / 2), which is all that tan(PI * f / fs) needs below nyquist
+		constexpr double tan(double x)
+		{
+			double x2 = x * x;
+			double sine = 0.0, cosine = 0.0;
+			double sine_term = x, cosine_term = 1.0;
+			for (int n = 0; n < 30; ++n)
+			{
+				sine += sine_term;
+				cosine += cosine_term;
+				sine_term *= -x2 / ((2.0 * n + 2.0) * (2.0 * n + 3.0));
+				cosine_term *= -x2 / ((2.0 * n + 1.0) * (2.0 * n + 2.0));
+			}
+			return sine / cosine;
+		}
+
+		constexpr double abs(double x) { return x < 0.0 ? -x : x; }
+
+		constexpr double dB2lin(double dB) { return exp(dB * 0.11512925464970228420089957273422); }
+	}
+
+	// ------------------------------------------------------------------------------------------
+
+	template <typename T>
+	struct biquad_coefficients
+	{
+		T a0, a1, a2, b1, b2;
+	};
+
+	template <BIQUAD_FILTER_TYPE Type, typename T = float>
+	constexpr biquad_coefficients<T> design(double sample_rate, double frequency, double quality = 0.7071067811865476, double gain = 0.0)
+	{
+		double a0 = 1.0, a1 = 0.0, a2 = 0.0, b1 = 0.0, b2 = 0.0;
+
+		if (frequency <= 0.0 || Type == BIQUAD_NONE)
+			return { (T)a0, (T)a1, (T)a2, (T)b1, (T)b2 };
+
+		const double V = detail::dB2lin(detail::abs(gain));
+		const double sqrt_V = detail::sqrt(V);
+		const double sqrt_2 = 1.4142135623730951;
+		const double K = detail::tan(PI * (frequency / sample_rate));
+		const double Q = quality;
+		const bool boost = gain >= 0.0;
+		double norm = 1.0;
+
+		if constexpr (Type == BIQUAD_LOWPASS)
+		{
+			norm = 1.0 / (1.0 + K / Q + K * K);
+			a0 = K * K * norm;
+			a1 = 2.0 * a0;
+			a2 = a0;
+			b1 = 2.0 * (K * K - 1.0) * norm;
+			b2 = (1.0 - K / Q + K * K) * norm;
+		}
+		else if constexpr (Type == BIQUAD_HIGHPASS)
+		{
+			norm = 1.0 / (1.0 + K / Q + K * K);
+			a0 = norm;
+			a1 = -2.0 * a0;
+			a2 = a0;
+			b1 = 2.0 * (K * K - 1.0) * norm;
+			b2 = (1.0 - K / Q + K * K) * norm;
+		}
+		else if constexpr (Type == BIQUAD_BANDPASS)
+		{
+			norm = 1.0 / (1.0 + K / Q + K * K);
+			a0 = K / Q * norm;
+			a1 = 0.0;
+			a2 = -a0;
+			b1 = 2.0 * (K * K - 1.0) * norm;
+			b2 = (1.0 - K / Q + K * K) * norm;
+		}
+		else if constexpr (Type == BIQUAD_NOTCH)
+		{
+			norm = 1.0 / (1.0 + K / Q + K * K);
+			a0 = (1.0 + K * K) * norm;
+			a1 = 2.0 * (K * K - 1.0) * norm;
+			a2 = a0;
+			b1 = a1;
+			b2 = (1.0 - K / Q + K * K) * norm;
+		}
+		else if constexpr (Type == BIQUAD_PEAK)
+		{
+			if (boost)
+			{
+				norm = 1.0 / (1.0 + K / Q + K * K);
+				a0 = (1.0 + K / Q * V + K * K) * norm;
+				a1 = 2.0 * (K * K - 1.0) * norm;
+				a2 = (1.0 - K / Q * V + K * K) * norm;
+				b1 = a1;
+				b2 = (1.0 - K / Q + K * K) * norm;
+			}
+			else
+			{
+				norm = 1.0 / (1.0 + K / Q * V + K * K);
+				a0 = (1.0 + K / Q + K * K) * norm;
+				a1 = 2.0 * (K * K - 1.0) * norm;
+				a2 = (1.0 - K / Q + K * K) * norm;
+				b1 = a1;
+				b2 = (1.0 - K / Q * V + K * K) * norm;
+			}
+		}
+		else if constexpr (Type == BIQUAD_LOWSHELF || Type == BIQUAD_LOWSHELF_NOQ)
+		{
+			// the NOQ shelves are the Q shelves at Q = 1 / sqrt(2)
+			const double S = (Type == BIQUAD_LOWSHELF) ? sqrt_V / Q : sqrt_2 * sqrt_V;
+			const double R = (Type == BIQUAD_LOWSHELF) ? 1.0 / Q : sqrt_2;
+			if (boost)
+			{
+				norm = 1.0 / (1.0 + R * K + K * K);
+				a0 = (1.0 + S * K + V * K * K) * norm;
+				a1 = 2.0 * (V * K * K - 1.0) * norm;
+				a2 = (1.0 - S * K + V * K * K) * norm;
+				b1 = 2.0 * (K * K - 1.0) * norm;
+				b2 = (1.0 - R * K + K * K) * norm;
+			}
+			else
+			{
+				norm = 1.0 / (1.0 + S * K + V * K * K);
+				a0 = (1.0 + R * K + K * K) * norm;
+				a1 = 2.0 * (K * K - 1.0) * norm;
+				a2 = (1.0 - R * K + K * K) * norm;
+				b1 = 2.0 * (V * K * K - 1.0) * norm;
+				b2 = (1.0 - S * K + V * K * K) * norm;
+			}
+		}
+		else if constexpr (Type == BIQUAD_HIGHSHELF || Type == BIQUAD_HIGHSHELF_NOQ)
+		{
+			const double S = (Type == BIQUAD_HIGHSHELF) ? sqrt_V / Q : sqrt_2 * sqrt_V;
+			const double R = (Type == BIQUAD_HIGHSHELF) ? 1.0 / Q : sqrt_2;
+			if (boost)
+			{
+				norm = 1.0 / (1.0 + R * K + K * K);
+				a0 = (V + S * K + K * K) * norm;
+				a1 = 2.0 * (K * K - V) * norm;
+				a2 = (V - S * K + K * K) * norm;
+				b1 = 2.0 * (K * K - 1.0) * norm;
+				b2 = (1.0 - R * K + K * K) * norm;
+			}
+			else
+			{
+				norm = 1.0 / (V + S * K + K * K);
+				a0 = (1.0 + R * K + K * K) * norm;
+				a1 = 2.0 * (K * K - 1.0) * norm;
+				a2 = (1.0 - R * K + K * K) * norm;
+				b1 = 2.0 * (K * K - V) * norm;
+				b2 = (V - S * K + K * K) * norm;
+			}
+		}
+		else if constexpr (Type == BIQUAD_ALLPASS)
+		{
+			norm = 1.0 / (1.0 + K / Q + K * K);
+			a0 = (1.0 - K / Q + K * K) * norm;
+			a1 = 2.0 * (K * K - 1.0) * norm;
+			a2 = 1.0;
+			b1 = a1;
+			b2 = a0;
+		}
+
+		return { (T)a0, (T)a1, (T)a2, (T)b1, (T)b2 };
+	}
+
+	// runtime parameters, the filter type is fixed so set() compiles to a single design
+	// ------------------------------------------------------------------------------------------
+
+	template <BIQUAD_FILTER_TYPE Type, typename T = float>
+	class biquad
+	{
+	public:
+		using sample_type = T;
+
+		constexpr biquad() = default;
+		constexpr biquad(double sample_rate, double frequency, double quality = 0.7071067811865476, double gain = 0.0)
+			: coefficients(design<Type, T>(sample_rate, frequency, quality, gain)) {}
+
+		void set(double sample_rate, double frequency, double quality = 0.7071067811865476, double gain = 0.0)
+		{
+			coefficients = design<Type, T>(sample_rate, frequency, quality, gain);
+		}
+
+		void reset() { z1 = T(0); z2 = T(0); }
+		static constexpr int latency_samples() { return 0; }	// minimum phase, like px_biquad_latency_samples
+
+		inline T process(T input)
+		{
+			T out = input * coefficients.a0 + z1;
+			z1 = input * coefficients.a1 + z2 - coefficients.b1 * out;
+			z2 = input * coefficients.a2 - coefficients.b2 * out;
+			return out;
+		}
+
+		inline void process_block(T* input, int num_samples)
+		{
+			for (int i = 0; i < num_samples; ++i)
+				input[i] = process(input[i]);
+		}
+
+		biquad_coefficients<T> coefficients = { T(1), T(0), T(0), T(0), T(0) };
+
+	private:
+		T z1 = T(0);
+		T z2 = T(0);
+	};
+
+	// fixed parameters, Design::coefficients is a constant expression the compiler folds in
+	// ------------------------------------------------------------------------------------------
+
+	template <typename Design>
+	class fixed_biquad
+	{
+	public:
+		using sample_type = typename Design::sample_type;
+
+		void reset() { z1 = sample_type(0); z2 = sample_type(0); }
+		static constexpr int latency_samples() { return 0; }
+
+		inline sample_type process(sample_type input)
+		{
+			constexpr biquad_coefficients<sample_type> c = Design::coefficients;
+			sample_type out = input * c.a0 + z1;
+			z1 = input * c.a1 + z2 - c.b1 * out;
+			z2 = input * c.a2 - c.b2 * out;
+			return out;
+		}
+
+		inline void process_block(sample_type* input, int num_samples)
+		{
+			for (int i = 0; i < num_samples; ++i)
+				input[i] = process(input[i]);
+		}
+
+	private:
+		sample_type z1 = sample_type(0);
+		sample_type z2 = sample_type(0);
+	};
+
+	// integer template arguments keep these usable before C++20 floating point template parameters
+	// quality is in thousandths, gain in hundredths of a dB
+	template <BIQUAD_FILTER_TYPE Type, int SampleRate, int Frequency, int QualityMilli = 707, int GainCentidB = 0, typename T = float>
+	struct fixed_design
+	{
+		using sample_type = T;
+		static constexpr biquad_coefficients<T> coefficients =
+			design<Type, T>((double)SampleRate, (double)Frequency, QualityMilli / 1000.0, GainCentidB / 100.0);
+	};
+
+	// 5 Hz butterworth high-pass
+	template <int SampleRate, typename T = float>
+	using dc_blocker = fixed_design<BIQUAD_HIGHPASS, SampleRate, 5, 707, 0, T>;
+
+	// same shape as the sidechain band px_compressor_mono_initialize adds (high-pass, Q 1). that band starts
+	// at 0 Hz, effectively off, until set_frequency tunes it, this one needs a frequency and defaults to 20 Hz
+	template <int SampleRate, int Frequency = 20, typename T = float>
+	using sidechain_highpass = fixed_design<BIQUAD_HIGHPASS, SampleRate, Frequency, 1000, 0, T>;
+
+	// butterworth halves, two in a cascade make a linkwitz-riley 4th order crossover
+	template <int SampleRate, int Frequency, typename T = float>
+	using crossover_lowpass = fixed_design<BIQUAD_LOWPASS, SampleRate, Frequency, 707, 0, T>;
+
+	template <int SampleRate, int Frequency, typename T = float>
+	using crossover_highpass = fixed_design<BIQUAD_HIGHPASS, SampleRate, Frequency, 707, 0, T>;
+
+	// series sections, the fold expands into straight-line code with no loop over stages
+	// ------------------------------------------------------------------------------------------
+
+	template <typename First, typename... Rest>
+	class cascade
+	{
+	public:
+		using sample_type = typename First::sample_type;
+
+		void reset()
+		{
+			std::apply([](auto&... section) { (section.reset(), ...); }, sections);
+		}
+
+		static constexpr int latency_samples() { return (First::latency_samples() + ... + Rest::latency_samples()); }
+
+		inline sample_type process(sample_type input)
+		{
+			return std::apply([&](auto&... section) { ((input = section.process(input)), ...); return input; }, sections);
+		}
+
+		// section by section over the block keeps each recurrence in registers
+		inline void process_block(sample_type* input, int num_samples)
+		{
+			std::apply([&](auto&... section) { (section.process_block(input, num_samples), ...); }, sections);
+		}
+
+		template <size_t Index>
+		auto& get() { return std::get<Index>(sections); }
+
+	private:
+		std::tuple<First, Rest...> sections;
+	};
+}
+
+#endif
@@ -12,7 +12,7 @@
     //include
 
     //for double processing don't forget to define before header:
-    #define PX_DOUBLE_BUFFER //otherwise defaults to float processing 
+    #define PX_DOUBLE_BUFFER //otherwise defaults to float processing, applies to every px_ processor 
     
     #include "px_buffer.h"
 
@@ -58,8 +58,8 @@
 
 	get_pointer:
 
-		float* left_ptr = px_buffer_get_write_pointer(&buffer, 0);
-		float* right_ptr = px_buffer_get_write_pointer(&buffer, 1);
+		BUFFER_TYPE* left_ptr = px_buffer_get_write_pointer(&buffer, 0);
+		BUFFER_TYPE* right_ptr = px_buffer_get_write_pointer(&buffer, 1);
 
     
     interleaved:
@@ -69,15 +69,13 @@
 
 */
 
+// 16 covers 7.1.4 and third order ambisonics
 #ifndef MAX_CHANNELS
-	#define MAX_CHANNELS 4
+	#define MAX_CHANNELS 16
 #endif
 
-#ifdef PX_DOUBLE_BUFFER
-	typedef double BUFFER_TYPE;
-#else
-	typedef float BUFFER_TYPE;
-#endif
+// PX_DOUBLE_BUFFER switches SAMPLE_TYPE in px_globals.h, buffers follow the processors
+typedef SAMPLE_TYPE BUFFER_TYPE;
 
 typedef struct 
 {
@@ -114,7 +112,7 @@ static px_buffer* px_interleaved_to_buffer(const px_interleaved_buffer* src);
 static px_buffer* px_buffer_create(int num_channels, int num_samples)
 {
     px_buffer* buffer = (px_buffer*)px_malloc(sizeof(px_buffer));
-    px_buffer_initialize(buffer, num_samples, num_channels);
+    px_buffer_initialize(buffer, num_channels, num_samples);
     return buffer;
 }
 
@@ -147,6 +145,7 @@ static void px_buffer_destroy(px_buffer* buffer)
 static void px_buffer_initialize(px_buffer* buffer, int num_channels, int num_samples)
 {
     assert(buffer);
+    assert(num_channels <= MAX_CHANNELS);
     
     buffer->num_samples = num_samples;
     buffer->num_channels = num_channels;
@@ -348,4 +347,91 @@ static void px_circular_resize(px_circular_buffer* buffer, int new_size)
 
 }
 
+/*
+
+    px_sliding_max, maximum over the last length values in O(1) amortized
+
+    monotonic deque over a ring: values decrease from front to back, anything pushed behind a
+    larger value is dropped and the front is the window max. used by px_limiter and the
+    peak-hold / crest detectors
+*/
+
+typedef struct {
+    BUFFER_TYPE* values;
+    unsigned int* times;
+    int capacity;
+    int front;
+    int size;
+    int length;         // window, samples
+    unsigned int time;  // wraps, only differences are used
+} px_sliding_max;
+
+// -------------------------------------------------------------------------------
+
+static void px_sliding_max_initialize(px_sliding_max* window, int capacity);
+static void px_sliding_max_free(px_sliding_max* window);
+static void px_sliding_max_reset(px_sliding_max* window, int length);
+static inline BUFFER_TYPE px_sliding_max_push(px_sliding_max* window, BUFFER_TYPE value);
+
+// -------------------------------------------------------------------------------
+
+static void px_sliding_max_initialize(px_sliding_max* window, int capacity)
+{
+    assert(window && capacity > 0);
+    window->values = (BUFFER_TYPE*)px_malloc(sizeof(BUFFER_TYPE) * capacity);
+    window->times = (unsigned int*)px_malloc(sizeof(unsigned int) * capacity);
+    window->capacity = capacity;
+    px_sliding_max_reset(window, 1);
+}
+
+static void px_sliding_max_free(px_sliding_max* window)
+{
+    assert(window);
+    px_free(window->values);
+    px_free(window->times);
+}
+
+static void px_sliding_max_reset(px_sliding_max* window, int length)
+{
+    assert(window && length > 0 && length <= window->capacity);
+    window->front = 0;
+    window->size = 0;
+    window->length = length;
+    window->time = 0;
+}
+
+// push one value, return the maximum of the last window->length values
+static inline BUFFER_TYPE px_sliding_max_push(px_sliding_max* window, BUFFER_TYPE value)
+{
+    const int capacity = window->capacity;
+    unsigned int time = window->time++;
+
+    // expire the front once it leaves the window
+    if (window->size > 0 && time - window->times[window->front] >= (unsigned int)window->length)
+    {
+        window->front = (window->front + 1 < capacity) ? window->front + 1 : 0;
+        window->size--;
+    }
+
+    // anything at the back not larger than the new value can never be the max again
+    while (window->size > 0)
+    {
+        int back = window->front + window->size - 1;
+        if (back >= capacity)
+            back -= capacity;
+        if (window->values[back] > value)
+            break;
+        window->size--;
+    }
+
+    int slot = window->front + window->size;
+    if (slot >= capacity)
+        slot -= capacity;
+    window->values[slot] = value;
+    window->times[slot] = time;
+    window->size++;
+
+    return window->values[window->front];
+}
+
 #endif
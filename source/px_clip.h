@@ -1,4 +1,7 @@
 #include "px_globals.h"
+#include "px_simd.h"
+#include "px_silence.h"
+#include "px_profile.h"
 
 #ifndef PX_CLIP_H
 #define PX_CLIP_H
@@ -23,15 +26,25 @@ static void px_clipper_destroy(px_clipper* clipper);
 
 static void px_clipper_initialize(px_clipper* clipper);
 static void px_clipper_set_type(px_clipper* clipper, CLIP_TYPE in_type);
+static int px_clipper_latency_samples(const px_clipper* clipper); // 0
+static int px_clipper_tail_samples(const px_clipper* clipper); // 0
 
-static void px_clipper_mono_process(px_clipper* clipper, float* input);
-static void px_clipper_stereo_process(px_clipper* clipper, float* input_left, float* input_right);
+static void px_clipper_mono_process(px_clipper* clipper, SAMPLE_TYPE* input);
+static void px_clipper_stereo_process(px_clipper* clipper, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right);
+
+// block processing, curve is chosen once per block, silent blocks come back as zeros untouched
+static void px_clipper_mono_process_block(px_clipper* clipper, SAMPLE_TYPE* input, int num_samples);
+static void px_clipper_stereo_process_block(px_clipper* clipper, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples);
 
 // ---------------------------------------------------------------------------------------------
 // inline functions
-static inline float hard_clip(float input);
-static inline float quintic_clip(float input);
-static inline float arctangent_clip(float input);
+static inline SAMPLE_TYPE hard_clip(SAMPLE_TYPE input);
+static inline SAMPLE_TYPE quintic_clip(SAMPLE_TYPE input);
+static inline SAMPLE_TYPE arctangent_clip(SAMPLE_TYPE input);
+
+static inline void px_clip_hard_block(SAMPLE_TYPE* input, int num_samples);
+static inline void px_clip_quintic_block(SAMPLE_TYPE* input, int num_samples);
+static inline void px_clip_arctangent_block(SAMPLE_TYPE* input, int num_samples);
 // ---------------------------------------------------------------------------------------------
 
 static px_clipper* px_clipper_create()
@@ -59,10 +72,21 @@ static void px_clipper_set_type(px_clipper* clipper, CLIP_TYPE in_type)
     clipper->type = in_type;    
 }
 
-static void px_clipper_mono_process(px_clipper* clipper, float* input)
+static int px_clipper_latency_samples(const px_clipper* clipper)
+{
+    assert(clipper);
+    return 0;
+}
+
+static int px_clipper_tail_samples(const px_clipper* clipper)
+{
+    assert(clipper);
+    return 0;
+}
+
+static void px_clipper_mono_process(px_clipper* clipper, SAMPLE_TYPE* input)
 {
 	px_assert(clipper, input);
-	printf("%d", clipper->type);
 	switch (clipper->type)
 	{
 	case HARD:
@@ -88,10 +112,9 @@ static void px_clipper_mono_process(px_clipper* clipper, float* input)
 	}
 }
 
-static void px_clipper_stereo_process(px_clipper* clipper, float* input_left, float* input_right)
+static void px_clipper_stereo_process(px_clipper* clipper, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right)
 {
 	px_assert(clipper, input_left, input_right);
-	printf("%d", clipper->type);
 	switch (clipper->type)
 	{
 	case HARD:
@@ -120,12 +143,52 @@ static void px_clipper_stereo_process(px_clipper* clipper, float* input_left, fl
 	}
 }
 
-static inline float hard_clip(float input)
+static void px_clipper_mono_process_block(px_clipper* clipper, SAMPLE_TYPE* input, int num_samples)
+{
+	px_assert(clipper, input);
+	PX_PROFILE_BEGIN("px_clipper", clipper);
+
+	// memoryless, no tail to wait out
+	if (px_is_silent(input, num_samples))
+	{
+		memset(input, 0, sizeof(SAMPLE_TYPE) * num_samples);
+		PX_PROFILE_END(num_samples);
+		return;
+	}
+
+	switch (clipper->type)
+	{
+	case HARD:
+		px_clip_hard_block(input, num_samples);
+		break;
+	case SOFT:
+		px_clip_quintic_block(input, num_samples);
+		break;
+	case SMOOTH:
+		px_clip_arctangent_block(input, num_samples);
+		break;
+	default:
+		printf("clipper uninitialized");
+		break;
+	}
+	PX_PROFILE_END(num_samples);
+}
+
+static void px_clipper_stereo_process_block(px_clipper* clipper, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples)
+{
+	px_assert(clipper, input_left, input_right);
+	px_clipper_mono_process_block(clipper, input_left, num_samples);
+	px_clipper_mono_process_block(clipper, input_right, num_samples);
+}
+
+// ---------------------------------------------------------------------------------------------
+
+static inline SAMPLE_TYPE hard_clip(SAMPLE_TYPE input)
 {
 	return sgn(input) * fmin(fabs(input), 1.0f);
 }
 
-static inline float quintic_clip(float input)
+static inline SAMPLE_TYPE quintic_clip(SAMPLE_TYPE input)
 {
 	if (fabs(input) < 1.25f)
 		return input - (256.0f / 3125.0f) * powf(input, 5.0f);
@@ -133,11 +196,71 @@ static inline float quintic_clip(float input)
 		return sgn(input) * 1.0f;
 }
 
-static inline float arctangent_clip(float input)
+static inline SAMPLE_TYPE arctangent_clip(SAMPLE_TYPE input)
 {
 	return (2.0f / PI) * atan((1.6f * 0.6f) * input);
 }
 
+// block kernels
+// ---------------------------------------------------------------------------------------------
+
+static inline void px_clip_hard_block(SAMPLE_TYPE* input, int num_samples)
+{
+	px_simd upper = px_simd_set1(1.f);
+	px_simd lower = px_simd_set1(-1.f);
+
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+	{
+		px_simd x = px_simd_load(input + i);
+		px_simd_store(input + i, px_simd_min(px_simd_max(x, lower), upper));
+	}
+	for (; i < num_samples; ++i)
+		input[i] = px_fmin(px_fmax(input[i], -1.f), 1.f);
+}
+
+// the quintic reaches exactly +-1 at +-1.25, so clamping the input first
+// replaces the |x| < 1.25 branch
+static inline void px_clip_quintic_block(SAMPLE_TYPE* input, int num_samples)
+{
+	const SAMPLE_TYPE k = (SAMPLE_TYPE)256 / (SAMPLE_TYPE)3125;
+	px_simd upper = px_simd_set1(1.25f);
+	px_simd lower = px_simd_set1(-1.25f);
+	px_simd coefficient = px_simd_set1(-k);
+
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+	{
+		px_simd x = px_simd_min(px_simd_max(px_simd_load(input + i), lower), upper);
+		px_simd x2 = px_simd_mul(x, x);
+		px_simd x5 = px_simd_mul(px_simd_mul(x2, x2), x);
+		px_simd_store(input + i, px_simd_mul_add(coefficient, x5, x));
+	}
+	for (; i < num_samples; ++i)
+	{
+		SAMPLE_TYPE x = px_fmin(px_fmax(input[i], -1.25f), 1.25f);
+		SAMPLE_TYPE x2 = x * x;
+		input[i] = x - k * x2 * x2 * x;
+	}
+}
+
+static inline void px_clip_arctangent_block(SAMPLE_TYPE* input, int num_samples)
+{
+	const SAMPLE_TYPE drive = (SAMPLE_TYPE)(1.6 * 0.6);
+	const SAMPLE_TYPE scale = (SAMPLE_TYPE)(2.0 / PI);
+	px_simd drive_v = px_simd_set1(drive);
+	px_simd scale_v = px_simd_set1(scale);
+
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+	{
+		px_simd x = px_simd_mul(px_simd_load(input + i), drive_v);
+		px_simd_store(input + i, px_simd_mul(px_simd_atan(x), scale_v));
+	}
+	for (; i < num_samples; ++i)
+		input[i] = scale * px_fast_atan(drive * input[i]);
+}
+
 #endif
 
 
@@ -1,6 +1,12 @@
 #include "px_globals.h"
 #include "px_equalizer.h"
 #include "px_memory.h"
+#include "px_simd.h"
+#include "px_smoother.h"
+#include "px_detector.h"
+#include "px_profile.h"
+#include "px_meter.h"
+#include "px_gain_curve.h"
 
 #ifndef PX_COMPRESSOR_H
 #define PX_COMPRESSOR_H
@@ -15,6 +21,34 @@
 	px_compressor_parameters (float)
 		
 		threshold, ratio, knee width, makeup gain, attack and release
+
+	level detector (px_detector.h) in front of the envelope, peak by default
+		px_compressor_mono_set_detector(&compressor, DETECTOR_RMS);	// DETECTOR_PEAK_HOLD, DETECTOR_CREST
+		px_compressor_mono_set_detector_window(&compressor, 10.f);	// ms
+		windowed modes allocate, destroy() frees them; stack compressors call px_compressor_mono_free_detector()
+
+	metering (px_meter.h), output peak / RMS and gain reduction without makeup, NULL detaches
+		px_compressor_mono_set_meter(&compressor, &meter);
+
+	transfer curve (px_gain_curve.h), a table rebuilt when threshold-relative shape changes (ratio, knee)
+		the default is one segment at the threshold with the compressor's ratio and knee
+		px_gain_segment curve[] = { { -30.f, 1.f }, { 0.f, 4.f } };
+		px_compressor_mono_set_curve(&compressor, curve, 2, 0.5f);	// expand 1:2 under -30 dB over threshold
+		px_compressor_mono_set_curve(&compressor, NULL, 0, 1.f);	// back to ratio / knee
+		a ratio glide rebuilds the table every PX_COMPRESSOR_CURVE_STRIDE samples
+
+	lanes (px_compressor_lanes), PX_COMPRESSOR_LANES independent compressors in one SIMD vector
+		(8 on AVX float, 4 on SSE/NEON, 16 on AVX-512), for many instances or dual-mono multichannel.
+		one fused pass per sample: log2 of the level from the exponent field and a mantissa polynomial,
+		threshold, attack/release as a select, knee, then makeup folded into a single exp2. everything
+		stays in log2 units (dB / 6.02), so there are no dB conversions on the way through.
+		ratio and knee only (set_curve shapes are not read), peak detection, no sidechain eq.
+
+		px_compressor_lanes lanes;
+		px_compressor_lanes_initialize(&lanes);				// unity in every lane
+		px_compressor_lanes_set(&lanes, 0, &compressor);		// copy a compressor's settings into lane 0
+		px_compressor_lanes_process_channels(&lanes, channels, 8, num_samples);	// channel n on lane n
+		px_compressor_lanes_process(&lanes, levels, gains, num_samples);	// lane-interleaved levels, [sample][lane]
 	
 
 	init:
@@ -37,6 +71,21 @@
 		px_compressor_ms_process(&ms_compressor, &inpur_left, input_right, false)         // not dual mono
 		
 		REMEMBER: mid-side encoding done within px_ms_compressor_process() function
+
+		// blocks, the key defaults to the input itself
+		px_compressor_mono_process_block(&compressor, buffer, num_samples);
+		px_compressor_stereo_process_block(&stereo_compressor, left, right, num_samples, PX_STEREO);
+
+	external sidechain:
+
+		// key runs through the compressor's sidechain eq and detector instead of the input
+		px_compressor_mono_process_block_sidechain(&compressor, music, voice, num_samples);
+		px_compressor_stereo_process_block_sidechain(&stereo_compressor, left, right, key_left, key_right, num_samples, PX_STEREO);
+		px_compressor_stereo_process_block_sidechain(&stereo_compressor, left, right, voice, NULL, num_samples, PX_STEREO); // mono key
+
+		// one key, many streams: detector and gain computer run once, the gain is broadcast
+		px_compressor_mono_key_block(&ducker, voice, gain, num_samples);
+		px_compressor_apply_gain_block(gain, streams, num_streams, num_samples);
 */
 
 
@@ -68,11 +117,27 @@ typedef struct
 
 } px_compressor_parameters;
 
+// setters glide threshold, ratio and makeup gain when a smoothing time is set
+typedef struct
+{
+    px_smoother threshold;
+    px_smoother ratio;
+    px_smoother makeup_gain;
+} px_compressor_smoothing;
+
 typedef struct
 {
     px_compressor_parameters parameters;
     px_envelope_detector attack;
     px_envelope_detector release;
+    px_compressor_smoothing smoothing;
+    px_level_detector detector;
+    px_meter* meter;
+
+    px_gain_curve curve;
+    bool custom_curve;      // set_curve() owns the shape, ratio and knee no longer rebuild it
+    int curve_countdown;    // samples to the next rebuild during a ratio glide
+    float makeup;           // linear makeup_gain
 
     px_mono_equalizer sidechain_equalizer;
 } px_mono_compressor;
@@ -84,6 +149,7 @@ typedef struct
    
     px_compressor_parameters parameters; 
     px_stereo_equalizer sidechain_equalizer;
+    px_meter* meter;
 } px_stereo_compressor;
 
 typedef struct
@@ -93,7 +159,24 @@ typedef struct
     
     px_compressor_parameters parameters;
     px_ms_equalizer sidechain_equalizer;    
+    px_meter* meter;
 } px_ms_compressor;
+
+#define PX_COMPRESSOR_LANES PX_SIMD_WIDTH
+
+// log2-domain gain computers, one compressor per lane
+typedef struct
+{
+    SAMPLE_TYPE threshold[PX_COMPRESSOR_LANES];     // log2 units
+    SAMPLE_TYPE slope[PX_COMPRESSOR_LANES];         // log2 of gain per log2 over, 1 / ratio - 1
+    SAMPLE_TYPE knee_start[PX_COMPRESSOR_LANES];    // over threshold, -knee width / 2
+    SAMPLE_TYPE knee_width[PX_COMPRESSOR_LANES];
+    SAMPLE_TYPE knee_scale[PX_COMPRESSOR_LANES];    // 1 / (2 * knee width), 0 without a knee
+    SAMPLE_TYPE attack[PX_COMPRESSOR_LANES];        // envelope coefficients
+    SAMPLE_TYPE release[PX_COMPRESSOR_LANES];
+    SAMPLE_TYPE makeup[PX_COMPRESSOR_LANES];        // log2 units
+    SAMPLE_TYPE env[PX_COMPRESSOR_LANES];           // over threshold envelope, log2 units
+} px_compressor_lanes;
 	 
 // API functions
 // ----------------------------------------------------------------------------------------------------------------------
@@ -113,12 +196,23 @@ static void px_compressor_ms_destroy(px_ms_compressor* compressor);
 #define PX_STEREO    false
 #define PX_MID_SIDE  false
 
+#define PX_COMPRESSOR_CHUNK 64  // stack scratch for the stereo block paths
+#define PX_COMPRESSOR_CURVE_STRIDE 128  // samples between table rebuilds while the ratio glides
+#define PX_COMPRESSOR_LOG2_PER_DB 0.16609640474436813  // log2(10) / 20
+
 // ----------------------------------------------------------------------------------------------------------------------
 // mono
 
-static void px_compressor_mono_process(px_mono_compressor* compressor, float* input);
+static void px_compressor_mono_process(px_mono_compressor* compressor, SAMPLE_TYPE* input);
 static void px_compressor_mono_initialize(px_mono_compressor* compressor, float in_sample_rate);
 
+static void px_compressor_mono_process_block(px_mono_compressor* compressor, SAMPLE_TYPE* input, int num_samples);
+static void px_compressor_mono_process_block_sidechain(px_mono_compressor* compressor, SAMPLE_TYPE* input, const SAMPLE_TYPE* key, int num_samples);
+
+// key -> linear gain (reduction and makeup), for broadcasting one key to many streams
+static void px_compressor_mono_key_block(px_mono_compressor* compressor, const SAMPLE_TYPE* key, SAMPLE_TYPE* gain, int num_samples);
+static void px_compressor_apply_gain_block(const SAMPLE_TYPE* gain, SAMPLE_TYPE** streams, int num_streams, int num_samples);
+
 static void px_compressor_mono_set_parameters(px_mono_compressor* compressor, px_compressor_parameters in_parameters);
 static void px_compressor_mono_set_threshold(px_mono_compressor* compressor, float in_threshold);
 static void px_compressor_mono_set_ratio(px_mono_compressor* compressor, float in_ratio);
@@ -126,6 +220,13 @@ static void px_compressor_mono_set_knee(px_mono_compressor* compressor, float in
 static void px_compressor_mono_set_attack(px_mono_compressor* compressor, float in_attack);
 static void px_compressor_mono_set_release(px_mono_compressor* compressor, float in_release);
 static void px_compressor_mono_set_makeup_gain(px_mono_compressor* compressor, float in_gain);
+static void px_compressor_mono_set_smoothing(px_mono_compressor* compressor, float in_time); // ms, 0 = instant
+static void px_compressor_mono_set_detector(px_mono_compressor* compressor, DETECTOR_MODE in_mode);
+static void px_compressor_mono_set_detector_window(px_mono_compressor* compressor, float in_window); // ms
+static void px_compressor_mono_set_meter(px_mono_compressor* compressor, px_meter* in_meter); // NULL = off
+static void px_compressor_mono_free_detector(px_mono_compressor* compressor);
+static void px_compressor_mono_set_curve(px_mono_compressor* compressor, const px_gain_segment* in_segments, int in_num_segments, float in_below_ratio); // 0 segments = ratio / knee
+static int px_compressor_mono_latency_samples(const px_mono_compressor* compressor); // 0, no lookahead
 
 static void px_compressor_mono_set_sidechain_frequency(px_mono_compressor* compressor, float in_frequency);
 static void px_compressor_mono_set_sidechain_quality(px_mono_compressor* compressor, float in_quality);
@@ -134,9 +235,14 @@ static void px_compressor_mono_set_sidechain_type(px_mono_compressor* compressor
 
 // stereo
 
-static void px_compressor_stereo_process(px_stereo_compressor* compressor, float* input_left, float* input_right, bool dual_mono);
+static void px_compressor_stereo_process(px_stereo_compressor* compressor, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, bool dual_mono);
 static void px_compressor_stereo_initialize(px_stereo_compressor* compressor, float in_sample_rate);
 
+static void px_compressor_stereo_process_block(px_stereo_compressor* compressor, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples, bool dual_mono);
+// key_right NULL = mono key, it feeds both channels' sidechain eq and detector
+static void px_compressor_stereo_process_block_sidechain(px_stereo_compressor* compressor, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right,
+							  const SAMPLE_TYPE* key_left, const SAMPLE_TYPE* key_right, int num_samples, bool dual_mono);
+
 static void px_compressor_stereo_set_parameters(px_stereo_compressor* compressor, px_compressor_parameters in_parameters);
 static void px_compressor_stereo_set_threshold(px_stereo_compressor* compressor, float in_threshold);
 static void px_compressor_stereo_set_ratio(px_stereo_compressor* compressor, float in_ratio);
@@ -144,6 +250,12 @@ static void px_compressor_stereo_set_knee(px_stereo_compressor* compressor, floa
 static void px_compressor_stereo_set_attack(px_stereo_compressor* compressor, float in_attack);
 static void px_compressor_stereo_set_release(px_stereo_compressor* compressor, float in_release);
 static void px_compressor_stereo_set_makeup_gain(px_stereo_compressor* compressor, float in_gain);
+static void px_compressor_stereo_set_smoothing(px_stereo_compressor* compressor, float in_time); // ms, 0 = instant
+static void px_compressor_stereo_set_detector(px_stereo_compressor* compressor, DETECTOR_MODE in_mode);
+static void px_compressor_stereo_set_detector_window(px_stereo_compressor* compressor, float in_window); // ms
+static void px_compressor_stereo_set_meter(px_stereo_compressor* compressor, px_meter* in_meter); // NULL = off
+static void px_compressor_stereo_set_curve(px_stereo_compressor* compressor, const px_gain_segment* in_segments, int in_num_segments, float in_below_ratio);
+static int px_compressor_stereo_latency_samples(const px_stereo_compressor* compressor);
 
 static void px_compressor_stereo_set_sidechain_frequency(px_stereo_compressor* compressor, float in_frequency, CHANNEL_FLAG channel);
 static void px_compressor_stereo_set_sidechain_quality(px_stereo_compressor* compressor, float in_quality, CHANNEL_FLAG channel);
@@ -152,7 +264,7 @@ static void px_compressor_stereo_set_sidechain_type(px_stereo_compressor* compre
 
 // ms
 
-static void px_compressor_ms_process(px_ms_compressor* compressor, float* input_left, float* input_right, bool dual_mono);
+static void px_compressor_ms_process(px_ms_compressor* compressor, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, bool dual_mono);
 static void px_compressor_ms_initialize(px_ms_compressor* compressor, float in_sample_rate);
 
 static void px_compressor_ms_set_parameters(px_ms_compressor* compressor, px_compressor_parameters in_parameters);
@@ -162,11 +274,25 @@ static void px_compressor_ms_set_knee(px_ms_compressor* compressor, float in_kne
 static void px_compressor_ms_set_attack(px_ms_compressor* compressor, float in_attack);
 static void px_compressor_ms_set_release(px_ms_compressor* compressor, float in_release);
 static void px_compressor_ms_set_makeup_gain(px_ms_compressor* compressor, float in_gain);
+static void px_compressor_ms_set_smoothing(px_ms_compressor* compressor, float in_time); // ms, 0 = instant
+static void px_compressor_ms_set_detector(px_ms_compressor* compressor, DETECTOR_MODE in_mode);
+static void px_compressor_ms_set_detector_window(px_ms_compressor* compressor, float in_window); // ms
+static void px_compressor_ms_set_meter(px_ms_compressor* compressor, px_meter* in_meter); // NULL = off
+static void px_compressor_ms_set_curve(px_ms_compressor* compressor, const px_gain_segment* in_segments, int in_num_segments, float in_below_ratio);
+static int px_compressor_ms_latency_samples(const px_ms_compressor* compressor);
 
 static void px_compressor_ms_set_sidechain_frequency(px_ms_compressor* compressor, float in_frequency, CHANNEL_FLAG channel);
 static void px_compressor_ms_set_sidechain_quality(px_ms_compressor* compressor, float in_quality, CHANNEL_FLAG channel);
 static void px_compressor_ms_set_sidechain_gain(px_ms_compressor* compressor, float in_gain, CHANNEL_FLAG channel);
 static void px_compressor_ms_set_sidechain_type(px_ms_compressor* compressor, BIQUAD_FILTER_TYPE in_type, CHANNEL_FLAG channel);
+
+// lanes
+
+static void px_compressor_lanes_initialize(px_compressor_lanes* lanes);
+static void px_compressor_lanes_set(px_compressor_lanes* lanes, int lane, const px_mono_compressor* compressor); // settings only, the lane keeps its envelope
+static void px_compressor_lanes_clear(px_compressor_lanes* lanes, int lane); // unity gain
+static void px_compressor_lanes_process(px_compressor_lanes* lanes, const SAMPLE_TYPE* levels, SAMPLE_TYPE* gains, int num_samples); // [sample][lane], may alias
+static void px_compressor_lanes_process_channels(px_compressor_lanes* lanes, SAMPLE_TYPE** channels, int num_channels, int num_samples);
 // ----------------------------------------------------------------------------------------------------------------------
 
 // inline functions 
@@ -177,7 +303,16 @@ static inline void px_envelope_detector_run(const px_envelope_detector* envelope
 
 static inline void px_compressor_calculate_envelope(const px_mono_compressor* compressor, float in, float* state);
 static inline float px_compressor_calculate_knee(const px_mono_compressor* compressor, float overdB); // takes in dB value returns linear (.f)
-static inline float px_compressor_compress(px_mono_compressor* compressor, float input, float sidechain);
+static inline float px_compressor_calculate_over(px_mono_compressor* compressor, SAMPLE_TYPE sidechain); // detector level in, enveloped dB over threshold out
+static inline SAMPLE_TYPE px_compressor_compress(px_mono_compressor* compressor, SAMPLE_TYPE input, SAMPLE_TYPE sidechain);
+static inline float px_compressor_gain(px_mono_compressor* compressor, SAMPLE_TYPE sidechain); // detector level in, linear gain out
+static inline void px_compressor_key_gains(px_mono_compressor* compressor, const SAMPLE_TYPE* key, SAMPLE_TYPE* gain, int num_samples);
+static void px_compressor_gain_block(px_mono_compressor* compressor, const SAMPLE_TYPE* level, SAMPLE_TYPE* gain, int num_samples); // level may alias gain
+static void px_compressor_update_curve(px_mono_compressor* compressor);
+static inline px_simd px_compressor_lanes_run(px_simd level, px_simd* env, const px_simd* parameters); // parameters in px_compressor_lanes order
+
+static inline bool px_compressor_is_smoothing(const px_mono_compressor* compressor);
+static inline void px_compressor_smooth(px_mono_compressor* compressor);
 	
 // --------------------------------------------------------------------------------------------------------
 
@@ -210,47 +345,65 @@ static px_ms_compressor* px_compressor_ms_create(float in_sample_rate)
 static void px_compressor_mono_destroy(px_mono_compressor* compressor)
 {
     if (compressor)
+    {
+	px_compressor_mono_free_detector(compressor);
 	px_free(compressor);
+    }
 }
 
 static void px_compressor_stereo_destroy(px_stereo_compressor* compressor)
 {
     if (compressor)
+    {
+	px_compressor_mono_free_detector(&compressor->left);
+	px_compressor_mono_free_detector(&compressor->right);
 	px_free(compressor);
+    }
 }
 
 static void px_compressor_ms_destroy(px_ms_compressor* compressor)
 {
     if (compressor)
+    {
+	px_compressor_mono_free_detector(&compressor->mid);
+	px_compressor_mono_free_detector(&compressor->side);
 	px_free(compressor);
+    }
 }
 
-static void px_compressor_mono_process(px_mono_compressor* compressor, float* input)
+static void px_compressor_mono_process(px_mono_compressor* compressor, SAMPLE_TYPE* input)
 {
     // check the caclulate_envelope function
     px_assert(compressor, input);
     
     //sidechain eq
-    float sidechain = *input;
+    SAMPLE_TYPE sidechain = *input;
     px_equalizer_mono_process(&compressor->sidechain_equalizer, &sidechain);
+    sidechain = px_level_detector_run(&compressor->detector, sidechain);
     *input = px_compressor_compress(compressor, *input, sidechain);
+
+    if (compressor->meter)
+    {
+	px_meter_level(compressor->meter, *input);
+	px_meter_advance(compressor->meter, 1);
+    }
 }
 
-static void px_compressor_stereo_process(px_stereo_compressor* compressor, float* input_left, float* input_right, bool dual_mono)
+static void px_compressor_stereo_process(px_stereo_compressor* compressor, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, bool dual_mono)
 {
     px_assert(compressor, input_left, input_right);
 
     //sidechain eq
-    float sidechain_left = *input_left;
-    float sidechain_right = *input_right;
+    SAMPLE_TYPE sidechain_left = *input_left;
+    SAMPLE_TYPE sidechain_right = *input_right;
 
     px_equalizer_stereo_process(&compressor->sidechain_equalizer, &sidechain_left, &sidechain_right);
 
-    float input_absolute_left = fabsf(sidechain_left);
-    float input_absolute_right = fabsf(sidechain_right); /* put here: rms smoothing */
+    SAMPLE_TYPE input_absolute_left = px_level_detector_run(&compressor->left.detector, sidechain_left);
+    SAMPLE_TYPE input_absolute_right = px_level_detector_run(&compressor->right.detector, sidechain_right);
 
     //mono sum
-    float input_link = fabsf(fmaxf(input_absolute_left, input_absolute_right));
+    SAMPLE_TYPE input_link = px_fabs(px_fmax(input_absolute_left, input_absolute_right));
    
     if (dual_mono)
     {
@@ -262,21 +415,28 @@ static void px_compressor_stereo_process(px_stereo_compressor* compressor, float
     	*input_left = px_compressor_compress(&compressor->left, *input_left, input_link);
     	*input_right = px_compressor_compress(&compressor->right, *input_right, input_link);
     }
+
+    if (compressor->meter)
+    {
+	px_meter_level(compressor->meter, *input_left);
+	px_meter_level(compressor->meter, *input_right);
+	px_meter_advance(compressor->meter, 1);
+    }
 }
 
-static void px_compressor_ms_process(px_ms_compressor* compressor, float* input_left, float* input_right, bool dual_mono)
+static void px_compressor_ms_process(px_ms_compressor* compressor, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, bool dual_mono)
 {
     px_assert(compressor, input_left, input_right);
     
-    float sidechain_left = *input_left;
-    float sidechain_right = *input_right;
+    SAMPLE_TYPE sidechain_left = *input_left;
+    SAMPLE_TYPE sidechain_right = *input_right;
 
     px_ms_encoded encoded_sidechain = px_equalizer_ms_process_and_return(&compressor->sidechain_equalizer, sidechain_left, sidechain_right);
    
-    float absolute_mid = fabsf(encoded_sidechain.mid);
-    float absolute_side = fabsf(encoded_sidechain.side);
+    SAMPLE_TYPE absolute_mid = px_level_detector_run(&compressor->mid.detector, encoded_sidechain.mid);
+    SAMPLE_TYPE absolute_side = px_level_detector_run(&compressor->side.detector, encoded_sidechain.side);
 
-    float link = fabsf(fmaxf(absolute_mid, absolute_side));
+    SAMPLE_TYPE link = px_fabs(px_fmax(absolute_mid, absolute_side));
 
     px_ms_decoded decoded = { 0.f, 0.f };
 
@@ -301,6 +461,133 @@ static void px_compressor_ms_process(px_ms_compressor* compressor, float* input_
     *input_left = decoded.left;
     *input_right = decoded.right;
 
+    if (compressor->meter)
+    {
+	px_meter_level(compressor->meter, *input_left);
+	px_meter_level(compressor->meter, *input_right);
+	px_meter_advance(compressor->meter, 1);
+    }
+}
+
+static void px_compressor_mono_process_block(px_mono_compressor* compressor, SAMPLE_TYPE* input, int num_samples)
+{
+    px_compressor_mono_process_block_sidechain(compressor, input, input, num_samples);
+}
+
+static void px_compressor_mono_process_block_sidechain(px_mono_compressor* compressor, SAMPLE_TYPE* input, const SAMPLE_TYPE* key, int num_samples)
+{
+    px_assert(compressor, input, key);
+    PX_PROFILE_BEGIN("px_mono_compressor", compressor);
+    px_fp_mode mode = px_denormals_disable();
+
+    // gains for a chunk are done before the chunk is touched, so key may alias input
+    SAMPLE_TYPE gain[PX_COMPRESSOR_CHUNK];
+    for (int offset = 0; offset < num_samples; offset += PX_COMPRESSOR_CHUNK)
+    {
+	int chunk = (num_samples - offset < PX_COMPRESSOR_CHUNK) ? num_samples - offset : PX_COMPRESSOR_CHUNK;
+	SAMPLE_TYPE* stream = input + offset;
+
+	px_compressor_key_gains(compressor, key + offset, gain, chunk);
+	px_compressor_apply_gain_block(gain, &stream, 1, chunk);
+
+	if (compressor->meter)
+	{
+	    px_meter_level_block(compressor->meter, stream, chunk);
+	    px_meter_advance(compressor->meter, chunk);
+	}
+    }
+    px_denormals_restore(mode);
+    PX_PROFILE_END(num_samples);
+}
+
+// a meter on a key-only compressor reads gain reduction, the levels belong to the streams
+static void px_compressor_mono_key_block(px_mono_compressor* compressor, const SAMPLE_TYPE* key, SAMPLE_TYPE* gain, int num_samples)
+{
+    px_assert(compressor, key, gain);
+    px_compressor_key_gains(compressor, key, gain, num_samples);
+
+    if (compressor->meter)
+	px_meter_advance(compressor->meter, num_samples);
+}
+
+static void px_compressor_apply_gain_block(const SAMPLE_TYPE* gain, SAMPLE_TYPE** streams, int num_streams, int num_samples)
+{
+    assert(gain);
+    assert(streams);
+
+    for (int stream = 0; stream < num_streams; ++stream)
+    {
+	SAMPLE_TYPE* buffer = streams[stream];
+	assert(buffer);
+
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+	    px_simd_store(buffer + i, px_simd_mul(px_simd_load(buffer + i), px_simd_load(gain + i)));
+	for (; i < num_samples; ++i)
+	    buffer[i] *= gain[i];
+    }
+}
+
+static void px_compressor_stereo_process_block(px_stereo_compressor* compressor, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples, bool dual_mono)
+{
+    px_compressor_stereo_process_block_sidechain(compressor, input_left, input_right, input_left, input_right, num_samples, dual_mono);
+}
+
+static void px_compressor_stereo_process_block_sidechain(px_stereo_compressor* compressor, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right,
+							  const SAMPLE_TYPE* key_left, const SAMPLE_TYPE* key_right, int num_samples, bool dual_mono)
+{
+    px_assert(compressor, input_left, input_right);
+    assert(key_left);
+    PX_PROFILE_BEGIN("px_stereo_compressor", compressor);
+
+    // both sides always run, a later stereo or dual mono key picks up a live envelope and filter state
+    if (!key_right)
+	key_right = key_left;
+    px_fp_mode mode = px_denormals_disable();
+
+    SAMPLE_TYPE level_left[PX_COMPRESSOR_CHUNK];
+    SAMPLE_TYPE level_right[PX_COMPRESSOR_CHUNK];
+
+    for (int offset = 0; offset < num_samples; offset += PX_COMPRESSOR_CHUNK)
+    {
+	int chunk = (num_samples - offset < PX_COMPRESSOR_CHUNK) ? num_samples - offset : PX_COMPRESSOR_CHUNK;
+
+	//sidechain eq and detector
+	for (int i = 0; i < chunk; ++i)
+	{
+	    level_left[i] = key_left[offset + i];
+	    level_right[i] = key_right[offset + i];
+	    px_equalizer_stereo_process(&compressor->sidechain_equalizer, &level_left[i], &level_right[i]);
+	}
+	px_level_detector_process_block(&compressor->left.detector, level_left, level_left, chunk);
+	px_level_detector_process_block(&compressor->right.detector, level_right, level_right, chunk);
+
+	if (!dual_mono)
+	{
+	    for (int i = 0; i < chunk; ++i)
+	    {
+		level_left[i] = px_fmax(level_left[i], level_right[i]);
+		level_right[i] = level_left[i];
+	    }
+	}
+
+	px_compressor_gain_block(&compressor->left, level_left, level_left, chunk);
+	px_compressor_gain_block(&compressor->right, level_right, level_right, chunk);
+
+	SAMPLE_TYPE* stream = input_left + offset;
+	px_compressor_apply_gain_block(level_left, &stream, 1, chunk);
+	stream = input_right + offset;
+	px_compressor_apply_gain_block(level_right, &stream, 1, chunk);
+
+	if (compressor->meter)
+	{
+	    px_meter_level_block(compressor->meter, input_left + offset, chunk);
+	    px_meter_level_block(compressor->meter, input_right + offset, chunk);
+	    px_meter_advance(compressor->meter, chunk);
+	}
+    }
+    px_denormals_restore(mode);
+    PX_PROFILE_END(num_samples);
 }
 
 static void px_compressor_mono_initialize(px_mono_compressor* compressor, float in_sample_rate)
@@ -310,6 +597,7 @@ static void px_compressor_mono_initialize(px_mono_compressor* compressor, float
     px_mono_equalizer equalizer;
     px_equalizer_mono_initialize(&equalizer, in_sample_rate);
     px_equalizer_mono_add_band(&equalizer, 0.f, 1.f, 0.f, BIQUAD_HIGHPASS);
+    px_equalizer_mono_set_topology(&equalizer, 0, BIQUAD_SVF);  // sidechain cutoffs sit far below fs
     compressor->sidechain_equalizer = equalizer;
 
     px_compressor_parameters new_parameters = INITIALIZED_PARAMETERS;
@@ -323,6 +611,18 @@ static void px_compressor_mono_initialize(px_mono_compressor* compressor, float
 
     px_envelope_detector_calculate_coefficient(&compressor->attack);
     px_envelope_detector_calculate_coefficient(&compressor->release);
+
+    px_smoother_initialize(&compressor->smoothing.threshold, in_sample_rate, 0.f, SMOOTHER_LINEAR, new_parameters.threshold);
+    px_smoother_initialize(&compressor->smoothing.ratio, in_sample_rate, 0.f, SMOOTHER_LINEAR, new_parameters.ratio);
+    px_smoother_initialize(&compressor->smoothing.makeup_gain, in_sample_rate, 0.f, SMOOTHER_LINEAR, new_parameters.makeup_gain);
+
+    px_level_detector_initialize(&compressor->detector, in_sample_rate);
+    compressor->meter = NULL;
+
+    compressor->custom_curve = false;
+    compressor->curve_countdown = 0;
+    compressor->makeup = dB2lin(new_parameters.makeup_gain);
+    px_compressor_update_curve(compressor);
 }
 
 static void px_compressor_stereo_initialize(px_stereo_compressor* compressor, float in_sample_rate)
@@ -332,6 +632,7 @@ static void px_compressor_stereo_initialize(px_stereo_compressor* compressor, fl
     px_stereo_equalizer equalizer;
     px_equalizer_stereo_initialize(&equalizer, in_sample_rate);
     px_equalizer_stereo_add_band(&equalizer, 0.f, 1.f, 0.f, BIQUAD_HIGHPASS);
+    px_equalizer_stereo_set_topology(&equalizer, 0, BIQUAD_SVF, BOTH);
 
     compressor->sidechain_equalizer = equalizer;
 
@@ -341,6 +642,7 @@ static void px_compressor_stereo_initialize(px_stereo_compressor* compressor, fl
 
     px_compressor_mono_initialize(&compressor->left, in_sample_rate);
     px_compressor_mono_initialize(&compressor->right, in_sample_rate);
+    compressor->meter = NULL;
 
 }
 
@@ -351,6 +653,7 @@ static void px_compressor_ms_initialize(px_ms_compressor* compressor, float in_s
     px_ms_equalizer equalizer;
     px_equalizer_ms_initialize(&equalizer, in_sample_rate);
     px_equalizer_ms_add_band(&equalizer, 0.f, 1.f, 0.f, BIQUAD_HIGHPASS);
+    px_equalizer_ms_set_topology(&equalizer, 0, BIQUAD_SVF, BOTH);
     
     compressor->sidechain_equalizer = equalizer;
 
@@ -359,6 +662,7 @@ static void px_compressor_ms_initialize(px_ms_compressor* compressor, float in_s
 
     px_compressor_mono_initialize(&compressor->mid, in_sample_rate);
     px_compressor_mono_initialize(&compressor->side, in_sample_rate);
+    compressor->meter = NULL;
 
 }
 
@@ -366,6 +670,14 @@ static void px_compressor_mono_set_parameters(px_mono_compressor* compressor, px
 {
     assert(compressor);
     compressor->parameters = in_parameters;
+
+    // whole-parameter sets are instant
+    px_smoother_reset(&compressor->smoothing.threshold, in_parameters.threshold);
+    px_smoother_reset(&compressor->smoothing.ratio, in_parameters.ratio);
+    px_smoother_reset(&compressor->smoothing.makeup_gain, in_parameters.makeup_gain);
+
+    compressor->makeup = dB2lin(in_parameters.makeup_gain);
+    px_compressor_update_curve(compressor);
 }
 
 static void px_compressor_stereo_set_parameters(px_stereo_compressor* compressor, px_compressor_parameters in_parameters)
@@ -387,7 +699,9 @@ static void px_compressor_ms_set_parameters(px_ms_compressor* compressor, px_com
 static void px_compressor_mono_set_threshold(px_mono_compressor* compressor, float in_threshold)
 {
     assert(compressor);
-    compressor->parameters.threshold = in_threshold;
+    px_smoother_set_target(&compressor->smoothing.threshold, in_threshold);
+    if (!px_smoother_is_smoothing(&compressor->smoothing.threshold))
+        compressor->parameters.threshold = in_threshold;
 }
 
 static void px_compressor_stereo_set_threshold(px_stereo_compressor* compressor, float in_threshold)
@@ -409,7 +723,14 @@ static void px_compressor_ms_set_threshold(px_ms_compressor* compressor, float i
 static void px_compressor_mono_set_ratio(px_mono_compressor* compressor, float in_ratio)
 {
     assert(compressor);
-    compressor->parameters.ratio = in_ratio;
+    px_smoother_set_target(&compressor->smoothing.ratio, in_ratio);
+    if (!px_smoother_is_smoothing(&compressor->smoothing.ratio))
+    {
+        compressor->parameters.ratio = in_ratio;
+        px_compressor_update_curve(compressor);
+    }
+    else
+        compressor->curve_countdown = 0;
 }
 
 static void px_compressor_stereo_set_ratio(px_stereo_compressor* compressor, float in_ratio)
@@ -432,6 +753,7 @@ static void px_compressor_mono_set_knee(px_mono_compressor* compressor, float in
 {
     assert(compressor);
     compressor->parameters.knee_width = in_knee_width;
+    px_compressor_update_curve(compressor);
 }
 
 static void px_compressor_stereo_set_knee(px_stereo_compressor* compressor, float in_knee_width)
@@ -501,7 +823,12 @@ static void px_compressor_ms_set_release(px_ms_compressor* compressor, float in_
 static void px_compressor_mono_set_makeup_gain(px_mono_compressor* compressor, float in_gain)
 {
     assert(compressor);
-    compressor->parameters.makeup_gain = in_gain;
+    px_smoother_set_target(&compressor->smoothing.makeup_gain, in_gain);
+    if (!px_smoother_is_smoothing(&compressor->smoothing.makeup_gain))
+    {
+        compressor->parameters.makeup_gain = in_gain;
+        compressor->makeup = dB2lin(in_gain);
+    }
 }
 
 static void px_compressor_stereo_set_makeup_gain(px_stereo_compressor* compressor, float in_gain)
@@ -520,6 +847,144 @@ static void px_compressor_ms_set_makeup_gain(px_ms_compressor* compressor, float
     px_compressor_mono_set_makeup_gain(&compressor->side, in_gain);
 }
 
+static void px_compressor_mono_set_smoothing(px_mono_compressor* compressor, float in_time)
+{
+    assert(compressor);
+    px_smoother_set_time(&compressor->smoothing.threshold, in_time);
+    px_smoother_set_time(&compressor->smoothing.ratio, in_time);
+    px_smoother_set_time(&compressor->smoothing.makeup_gain, in_time);
+    px_equalizer_mono_set_smoothing(&compressor->sidechain_equalizer, in_time);
+}
+
+static void px_compressor_stereo_set_smoothing(px_stereo_compressor* compressor, float in_time)
+{
+    assert(compressor);
+    px_compressor_mono_set_smoothing(&compressor->left, in_time);
+    px_compressor_mono_set_smoothing(&compressor->right, in_time);
+    px_equalizer_stereo_set_smoothing(&compressor->sidechain_equalizer, in_time);
+}
+
+static void px_compressor_ms_set_smoothing(px_ms_compressor* compressor, float in_time)
+{
+    assert(compressor);
+    px_compressor_mono_set_smoothing(&compressor->mid, in_time);
+    px_compressor_mono_set_smoothing(&compressor->side, in_time);
+    px_equalizer_ms_set_smoothing(&compressor->sidechain_equalizer, in_time);
+}
+
+static void px_compressor_mono_set_detector(px_mono_compressor* compressor, DETECTOR_MODE in_mode)
+{
+    assert(compressor);
+    px_level_detector_set_mode(&compressor->detector, in_mode);
+}
+
+static void px_compressor_stereo_set_detector(px_stereo_compressor* compressor, DETECTOR_MODE in_mode)
+{
+    assert(compressor);
+    px_compressor_mono_set_detector(&compressor->left, in_mode);
+    px_compressor_mono_set_detector(&compressor->right, in_mode);
+}
+
+static void px_compressor_ms_set_detector(px_ms_compressor* compressor, DETECTOR_MODE in_mode)
+{
+    assert(compressor);
+    px_compressor_mono_set_detector(&compressor->mid, in_mode);
+    px_compressor_mono_set_detector(&compressor->side, in_mode);
+}
+
+static void px_compressor_mono_set_detector_window(px_mono_compressor* compressor, float in_window)
+{
+    assert(compressor);
+    px_level_detector_set_window(&compressor->detector, in_window);
+}
+
+static void px_compressor_stereo_set_detector_window(px_stereo_compressor* compressor, float in_window)
+{
+    assert(compressor);
+    px_compressor_mono_set_detector_window(&compressor->left, in_window);
+    px_compressor_mono_set_detector_window(&compressor->right, in_window);
+}
+
+static void px_compressor_ms_set_detector_window(px_ms_compressor* compressor, float in_window)
+{
+    assert(compressor);
+    px_compressor_mono_set_detector_window(&compressor->mid, in_window);
+    px_compressor_mono_set_detector_window(&compressor->side, in_window);
+}
+
+// the inner compressors share the meter for gain reduction, levels are metered on the stereo output
+static void px_compressor_mono_set_meter(px_mono_compressor* compressor, px_meter* in_meter)
+{
+    assert(compressor);
+    compressor->meter = in_meter;
+}
+
+static void px_compressor_stereo_set_meter(px_stereo_compressor* compressor, px_meter* in_meter)
+{
+    assert(compressor);
+    compressor->meter = in_meter;
+    compressor->left.meter = in_meter;
+    compressor->right.meter = in_meter;
+}
+
+static void px_compressor_ms_set_meter(px_ms_compressor* compressor, px_meter* in_meter)
+{
+    assert(compressor);
+    compressor->meter = in_meter;
+    compressor->mid.meter = in_meter;
+    compressor->side.meter = in_meter;
+}
+
+static void px_compressor_mono_free_detector(px_mono_compressor* compressor)
+{
+    assert(compressor);
+    px_level_detector_free(&compressor->detector);
+}
+
+static void px_compressor_mono_set_curve(px_mono_compressor* compressor, const px_gain_segment* in_segments, int in_num_segments, float in_below_ratio)
+{
+    assert(compressor);
+    compressor->custom_curve = in_num_segments > 0;
+    if (compressor->custom_curve)
+        px_gain_curve_set(&compressor->curve, in_segments, in_num_segments, in_below_ratio, compressor->parameters.knee_width);
+    else
+        px_compressor_update_curve(compressor);
+}
+
+static void px_compressor_stereo_set_curve(px_stereo_compressor* compressor, const px_gain_segment* in_segments, int in_num_segments, float in_below_ratio)
+{
+    assert(compressor);
+    px_compressor_mono_set_curve(&compressor->left, in_segments, in_num_segments, in_below_ratio);
+    px_compressor_mono_set_curve(&compressor->right, in_segments, in_num_segments, in_below_ratio);
+}
+
+static void px_compressor_ms_set_curve(px_ms_compressor* compressor, const px_gain_segment* in_segments, int in_num_segments, float in_below_ratio)
+{
+    assert(compressor);
+    px_compressor_mono_set_curve(&compressor->mid, in_segments, in_num_segments, in_below_ratio);
+    px_compressor_mono_set_curve(&compressor->side, in_segments, in_num_segments, in_below_ratio);
+}
+
+// latency
+
+static int px_compressor_mono_latency_samples(const px_mono_compressor* compressor)
+{
+    assert(compressor);
+    return 0;
+}
+
+static int px_compressor_stereo_latency_samples(const px_stereo_compressor* compressor)
+{
+    assert(compressor);
+    return 0;
+}
+
+static int px_compressor_ms_latency_samples(const px_ms_compressor* compressor)
+{
+    assert(compressor);
+    return 0;
+}
+
 // sidechain 
 
 static void px_compressor_mono_set_sidechain_frequency(px_mono_compressor* compressor, float in_frequency)
@@ -619,73 +1084,244 @@ static inline void px_compressor_calculate_envelope(const px_mono_compressor* co
     }
 }
 
-// takes in dB value returns linear (.f)
+// takes in dB over threshold, returns linear (.f)
 static inline float px_compressor_calculate_knee(const px_mono_compressor* compressor, float overdB)
 {
-    float knee_start = compressor->parameters.threshold - compressor->parameters.knee_width / 2.0;
-    float knee_end = compressor->parameters.threshold + compressor->parameters.knee_width / 2.0;
+    return (float)px_gain_curve_lookup(&compressor->curve, overdB);
+}
 
-    
-    float gain = 1.0;
-        // no compression
-    if (overdB <= knee_start) {
-        gain = 1.0;
-    }
-    else if (overdB >= knee_end) {
-        // Full compression above the knee
-        float reduced_level = overdB / compressor->parameters.ratio;
-        gain = dB2lin(-(overdB - reduced_level));
+
+static inline bool px_compressor_is_smoothing(const px_mono_compressor* compressor)
+{
+    return px_smoother_is_smoothing(&compressor->smoothing.threshold)
+        || px_smoother_is_smoothing(&compressor->smoothing.ratio)
+        || px_smoother_is_smoothing(&compressor->smoothing.makeup_gain);
+}
+
+// the table is relative to the threshold, so only a ratio glide rebuilds it
+static inline void px_compressor_smooth(px_mono_compressor* compressor)
+{
+    compressor->parameters.threshold = px_smoother_next(&compressor->smoothing.threshold);
+
+    if (px_smoother_is_smoothing(&compressor->smoothing.makeup_gain))
+    {
+        compressor->parameters.makeup_gain = px_smoother_next(&compressor->smoothing.makeup_gain);
+        compressor->makeup = dB2lin(compressor->parameters.makeup_gain);
     }
-    else {
-        // soft knee
-        // Within the knee, interpolate the gain reduction
-        float blend = (overdB - knee_start) / compressor->parameters.knee_width; 
-        float uncompressed_gain = 1.0;
-        float reduced_level = overdB / compressor->parameters.ratio;
-        float compressed_gain = dB2lin(-(overdB - reduced_level));
-        gain = uncompressed_gain + blend * (compressed_gain - uncompressed_gain);
+
+    if (px_smoother_is_smoothing(&compressor->smoothing.ratio))
+    {
+        compressor->parameters.ratio = px_smoother_next(&compressor->smoothing.ratio);
+        if (--compressor->curve_countdown <= 0 || !px_smoother_is_smoothing(&compressor->smoothing.ratio))
+        {
+            px_compressor_update_curve(compressor);
+            compressor->curve_countdown = PX_COMPRESSOR_CURVE_STRIDE;
+        }
     }
+}
 
-    return gain;
+static inline SAMPLE_TYPE px_compressor_compress(px_mono_compressor* compressor, SAMPLE_TYPE input, SAMPLE_TYPE sidechain)
+{
+    return input * px_compressor_gain(compressor, sidechain);
 }
 
+static inline float px_compressor_gain(px_mono_compressor* compressor, SAMPLE_TYPE sidechain)
+{
+    float overdB = px_compressor_calculate_over(compressor, sidechain);
+
+    //transfer function
+    float gain_reduction = px_compressor_calculate_knee(compressor, overdB);
+
+    if (compressor->meter)
+	px_meter_gain(compressor->meter, gain_reduction);
 
-static inline float px_compressor_compress(px_mono_compressor* compressor, float input, float sidechain)
+    //makeup gain
+    return gain_reduction * compressor->makeup;
+}
+
+static inline float px_compressor_calculate_over(px_mono_compressor* compressor, SAMPLE_TYPE sidechain)
 {
+    if (px_compressor_is_smoothing(compressor))
+        px_compressor_smooth(compressor);
+
     // if hit, check the caclulate_envelope function
    // assert(!isnan(compressor->parameters.env));
 
     sidechain += DC_OFFSET;   // avoid log( 0 )
-    float keydB = lin2dB(sidechain); 
+    float keydB = lin2dB((float)sidechain); 
 
-    //threshold
+    //threshold, the envelope rests on the curve's floor (0 dB over for a plain compressor)
     float overdB = keydB - compressor->parameters.threshold;
-    if (overdB < 0.f)
-        overdB = 0.f;
+    if (overdB < compressor->curve.floor)
+        overdB = compressor->curve.floor;
     
     //attack/release
     overdB += DC_OFFSET;  // avoid denormal
     px_compressor_calculate_envelope(compressor, overdB, &compressor->parameters.env);
-    overdB = compressor->parameters.env - DC_OFFSET;
+    return compressor->parameters.env - DC_OFFSET;
+}
 
-    //transfer function
-    float gain_reduction;
-    if (compressor->parameters.knee_width > 0.f)
+// gain doubles as scratch: key -> sidechain eq -> detector -> gain computer
+static inline void px_compressor_key_gains(px_mono_compressor* compressor, const SAMPLE_TYPE* key, SAMPLE_TYPE* gain, int num_samples)
+{
+    for (int i = 0; i < num_samples; ++i)
     {
-        gain_reduction = px_compressor_calculate_knee(compressor, overdB); //return linear
+	gain[i] = key[i];
+	px_equalizer_mono_process(&compressor->sidechain_equalizer, &gain[i]);
     }
-    else
+
+    px_level_detector_process_block(&compressor->detector, gain, gain, num_samples);
+    px_compressor_gain_block(compressor, gain, gain, num_samples);
+}	
+
+// same result as px_compressor_gain per sample; with no glide running the envelope pass is
+// separated from the table lookups and the makeup, which then run over the whole block
+static void px_compressor_gain_block(px_mono_compressor* compressor, const SAMPLE_TYPE* level, SAMPLE_TYPE* gain, int num_samples)
+{
+    if (px_compressor_is_smoothing(compressor))
     {
-        gain_reduction = dB2lin(-overdB);
+	for (int i = 0; i < num_samples; ++i)
+	    gain[i] = px_compressor_gain(compressor, level[i]);
+	return;
     }
 
-    float output = input * gain_reduction;
+    for (int i = 0; i < num_samples; ++i)
+	gain[i] = px_compressor_calculate_over(compressor, level[i]);
 
-    //makeup gain
-    float makeup = dB2lin(compressor->parameters.makeup_gain);
-    output *= makeup;
-    return output;
+    px_gain_curve_lookup_block(&compressor->curve, gain, gain, num_samples);
 
-}	
+    if (compressor->meter)
+	px_meter_gain_block(compressor->meter, gain, num_samples);
+
+    const px_simd makeup = px_simd_set1(compressor->makeup);
+    int i = 0;
+    for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+	px_simd_store(gain + i, px_simd_mul(px_simd_load(gain + i), makeup));
+    for (; i < num_samples; ++i)
+	gain[i] *= compressor->makeup;
+}
+
+// ratio-driven compressors only, a custom curve keeps its own segments and gets the knee
+static void px_compressor_update_curve(px_mono_compressor* compressor)
+{
+    if (compressor->custom_curve)
+    {
+	px_gain_curve_set_knee(&compressor->curve, compressor->parameters.knee_width);
+	return;
+    }
+
+    px_gain_segment segment = { 0.f, compressor->parameters.ratio };
+    px_gain_curve_set(&compressor->curve, &segment, 1, 1.f, compressor->parameters.knee_width);
+}
+
+// ----------------------------------------------------------------------------------------------------------------------
+
+static void px_compressor_lanes_initialize(px_compressor_lanes* lanes)
+{
+    assert(lanes);
+    for (int lane = 0; lane < PX_COMPRESSOR_LANES; ++lane)
+    {
+	px_compressor_lanes_clear(lanes, lane);
+	lanes->env[lane] = 0.f;
+    }
+}
+
+// same transfer as the compressor's default gain curve, scaled to log2 units
+static void px_compressor_lanes_set(px_compressor_lanes* lanes, int lane, const px_mono_compressor* compressor)
+{
+    px_assert(lanes, compressor);
+    assert(lane >= 0 && lane < PX_COMPRESSOR_LANES);
+
+    const px_compressor_parameters parameters = compressor->parameters;
+    const SAMPLE_TYPE knee_width = px_fmax(parameters.knee_width, 0.f) * (SAMPLE_TYPE)PX_COMPRESSOR_LOG2_PER_DB;
+
+    lanes->threshold[lane] = parameters.threshold * (SAMPLE_TYPE)PX_COMPRESSOR_LOG2_PER_DB;
+    lanes->slope[lane] = 1.f / parameters.ratio - 1.f;
+    lanes->knee_start[lane] = -0.5f * knee_width;
+    lanes->knee_width[lane] = knee_width;
+    lanes->knee_scale[lane] = (knee_width > 0.f) ? 0.5f / knee_width : 0.f;
+    lanes->attack[lane] = compressor->attack.coefficient;
+    lanes->release[lane] = compressor->release.coefficient;
+    lanes->makeup[lane] = parameters.makeup_gain * (SAMPLE_TYPE)PX_COMPRESSOR_LOG2_PER_DB;
+}
+
+static void px_compressor_lanes_clear(px_compressor_lanes* lanes, int lane)
+{
+    assert(lanes);
+    assert(lane >= 0 && lane < PX_COMPRESSOR_LANES);
+
+    lanes->threshold[lane] = 0.f;
+    lanes->slope[lane] = 0.f;
+    lanes->knee_start[lane] = 0.f;
+    lanes->knee_width[lane] = 0.f;
+    lanes->knee_scale[lane] = 0.f;
+    lanes->attack[lane] = 0.f;
+    lanes->release[lane] = 0.f;
+    lanes->makeup[lane] = 0.f;
+}
+
+// parameters stay in registers for the whole block, the envelope is written back once
+static void px_compressor_lanes_process(px_compressor_lanes* lanes, const SAMPLE_TYPE* levels, SAMPLE_TYPE* gains, int num_samples)
+{
+    px_assert(lanes, levels, gains);
+
+    const px_simd parameters[8] = {
+	px_simd_load(lanes->threshold), px_simd_load(lanes->slope), px_simd_load(lanes->knee_start), px_simd_load(lanes->knee_width),
+	px_simd_load(lanes->knee_scale), px_simd_load(lanes->attack), px_simd_load(lanes->release), px_simd_load(lanes->makeup) };
+    px_simd env = px_simd_load(lanes->env);
+
+    for (int i = 0; i < num_samples; ++i)
+	px_simd_store(gains + i * PX_COMPRESSOR_LANES, px_compressor_lanes_run(px_simd_load(levels + i * PX_COMPRESSOR_LANES), &env, parameters));
+
+    px_simd_store(lanes->env, env);
+}
+
+// channel n compressed by lane n, the transpose to lanes goes through a stack chunk
+static void px_compressor_lanes_process_channels(px_compressor_lanes* lanes, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+    px_assert(lanes, channels);
+    assert(num_channels >= 1 && num_channels <= PX_COMPRESSOR_LANES);
+
+    SAMPLE_TYPE levels[PX_COMPRESSOR_CHUNK * PX_COMPRESSOR_LANES];
+    memset(levels, 0, sizeof(levels));  // unused lanes read silence
+
+    for (int offset = 0; offset < num_samples; offset += PX_COMPRESSOR_CHUNK)
+    {
+	int chunk = (num_samples - offset < PX_COMPRESSOR_CHUNK) ? num_samples - offset : PX_COMPRESSOR_CHUNK;
+
+	for (int channel = 0; channel < num_channels; ++channel)
+	    for (int i = 0; i < chunk; ++i)
+		levels[i * PX_COMPRESSOR_LANES + channel] = px_fabs(channels[channel][offset + i]);
+
+	px_compressor_lanes_process(lanes, levels, levels, chunk);
+
+	for (int channel = 0; channel < num_channels; ++channel)
+	    for (int i = 0; i < chunk; ++i)
+		channels[channel][offset + i] *= levels[i * PX_COMPRESSOR_LANES + channel];
+    }
+}
+
+// one sample for every lane: level -> log2 -> over -> envelope -> knee -> makeup -> linear gain
+static inline px_simd px_compressor_lanes_run(px_simd level, px_simd* env, const px_simd* parameters)
+{
+    const px_simd zero = px_simd_set1(0.f);
+    const px_simd offset = px_simd_set1((SAMPLE_TYPE)DC_OFFSET);
+
+    // log2 from the exponent field and a polynomial over the mantissa, offset avoids log( 0 )
+    px_simd key = px_simd_log2(px_simd_add(level, offset));
+
+    // threshold, the envelope rests on the knee start, offset keeps it out of denormals
+    px_simd over = px_simd_add(px_simd_max(px_simd_sub(key, parameters[0]), parameters[2]), offset);
+    px_simd coefficient = px_simd_select(px_simd_greater(over, *env), parameters[5], parameters[6]);
+    *env = px_simd_mul_add(coefficient, px_simd_sub(*env, over), over);
+
+    // ramp = distance^2 / (2 * knee) inside the knee, distance - knee / 2 past it
+    px_simd distance = px_simd_max(px_simd_sub(px_simd_sub(*env, offset), parameters[2]), zero);
+    px_simd inside = px_simd_min(distance, parameters[3]);
+    px_simd ramp = px_simd_mul_add(px_simd_mul(inside, inside), parameters[4], px_simd_sub(distance, inside));
+
+    // reduction and makeup in one exp2
+    return px_simd_exp2(px_simd_mul_add(ramp, parameters[1], parameters[7]));
+}
 
 #endif
@@ -1,5 +1,8 @@
 #include "px_globals.h"
 #include "px_buffer.h"
+#include "px_smoother.h"
+#include "px_silence.h"
+#include "px_profile.h"
 
 #ifndef PX_DELAY_H
 #define PX_DELAY_H
@@ -26,6 +29,8 @@ typedef struct
 {
     px_delay_parameters parameters;
     px_circular_buffer buffer;
+    px_smoother time_smoother;  // glides delay time (seconds) when a smoothing time is set
+    px_silence silence;         // block API tail skipping, the stereo delay keeps it in left
 
 } px_delay_line;
 
@@ -45,7 +50,12 @@ static void px_delay_mono_initialize(px_delay_line* delay, float sample_rate, fl
 static void px_delay_mono_prepare(px_delay_line* delay, float sample_rate);
 static void px_delay_mono_set_time(px_delay_line* delay, float time);
 static void px_delay_mono_set_feedback(px_delay_line* delay, float feedback);
-static void px_delay_mono_process(px_delay_line* delay, float* input);
+static void px_delay_mono_set_smoothing(px_delay_line* delay, float smoothing); // ms, 0 = instant
+static int px_delay_mono_latency_samples(const px_delay_line* delay); // 0, the echoes are the effect
+static int px_delay_mono_tail_samples(const px_delay_line* delay); // max_time per echo until the feedback falls PX_SILENCE_DECAY
+static void px_delay_mono_reset(px_delay_line* delay); // clears the line, the echoes stop
+static void px_delay_mono_process(px_delay_line* delay, SAMPLE_TYPE* input);
+static void px_delay_mono_process_block(px_delay_line* delay, SAMPLE_TYPE* input, int num_samples);
 
 static px_stereo_delay* px_create_stereo_delay(float sample_rate, float max_time, bool ping_pong);
 static void px_destroy_stereo_delay(px_stereo_delay* delay);
@@ -56,7 +66,15 @@ static void px_delay_stereo_prepare(px_stereo_delay* delay, float sample_rate);
 static void px_delay_stereo_set_time(px_stereo_delay* delay, float time, CHANNEL_FLAG channel);
 static void px_delay_stereo_set_feedback(px_stereo_delay* delay, float feedback, CHANNEL_FLAG channel);
 static void px_delay_stereo_set_ping_pong(px_stereo_delay* delay, bool ping_pong);
-static void px_delay_stereo_process(px_stereo_delay* delay, float* input_left, float* input_right);
+static int px_delay_stereo_latency_samples(const px_stereo_delay* delay);
+static int px_delay_stereo_tail_samples(const px_stereo_delay* delay);
+static void px_delay_stereo_reset(px_stereo_delay* delay);
+static void px_delay_stereo_set_smoothing(px_stereo_delay* delay, float smoothing);
+static void px_delay_stereo_process(px_stereo_delay* delay, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right);
+static void px_delay_stereo_process_block(px_stereo_delay* delay, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples);
+
+static inline void px_delay_split_time(px_delay_line* delay, float time);
+static inline void px_delay_smooth_time(px_delay_line* delay);
 
 
 static px_delay_line* px_create_mono_delay(float sample_rate, float max_time)
@@ -100,17 +118,12 @@ static void px_destroy_stereo_delay(px_stereo_delay* delay)
 static void px_delay_mono_initialize(px_delay_line* delay, float sample_rate, float max_time)
 {
    assert(delay);
-  
-   // TODO REMOVE THIS 
-   if (delay->parameters.max_time == max_time)
-   {
-		px_delay_mono_prepare(delay, sample_rate);
-		return;
-   }
+   px_silence_reset(&delay->silence);
 
    delay_time time = { 1.f, 0.f, 1 };
    px_delay_parameters parameters = {  sample_rate, 0.5f, time, max_time, 0.5f };
    delay->parameters = parameters;
+   px_smoother_initialize(&delay->time_smoother, sample_rate, 0.f, SMOOTHER_LINEAR, time.seconds);
 
    int max_samples = sample_rate * max_time;
    px_circular_initialize(&delay->buffer, max_samples);
@@ -124,8 +137,12 @@ static void px_delay_stereo_initialize(px_stereo_delay* delay, float sample_rate
 	px_delay_parameters parameters = { sample_rate, 0.5f, time, max_time, 0.5f };
 	
 	delay->ping_pong = ping_pong;
+	px_silence_reset(&delay->left.silence);
+	px_silence_reset(&delay->right.silence);
 	delay->left.parameters = parameters;
 	delay->right.parameters = parameters;
+	px_smoother_initialize(&delay->left.time_smoother, sample_rate, 0.f, SMOOTHER_LINEAR, time.seconds);
+	px_smoother_initialize(&delay->right.time_smoother, sample_rate, 0.f, SMOOTHER_LINEAR, time.seconds);
 
 	int max_samples = sample_rate * max_time;
 	px_circular_initialize(&delay->left.buffer, max_samples);
@@ -154,6 +171,7 @@ static void px_delay_mono_prepare(px_delay_line* delay, float sample_rate)
     assert(delay);
 	
 	delay->parameters.sample_rate = sample_rate;
+	px_smoother_set_sample_rate(&delay->time_smoother, sample_rate);
 	int max_samples = sample_rate * delay->parameters.max_time;
 	px_circular_initialize(&delay->buffer, max_samples);
 }
@@ -164,6 +182,8 @@ static void px_delay_stereo_prepare(px_stereo_delay* delay, float sample_rate)
 	
 	delay->left.parameters.sample_rate = sample_rate;
 	delay->right.parameters.sample_rate = sample_rate;
+	px_smoother_set_sample_rate(&delay->left.time_smoother, sample_rate);
+	px_smoother_set_sample_rate(&delay->right.time_smoother, sample_rate);
 
 	//error with initialization
 	assert(delay->left.parameters.max_time == delay->right.parameters.max_time);
@@ -177,11 +197,36 @@ static void px_delay_mono_set_time(px_delay_line* delay, float time)
 {
    assert(delay);
    assert(time > 0 && time < delay->parameters.max_time);
-   delay->parameters.time.seconds = time;
-   
-   float time_in_samples = delay->parameters.sample_rate * time;
-   delay->parameters.time.whole = (int)floorf(time_in_samples);
-   delay->parameters.time.fraction = time_in_samples - delay->parameters.time.whole;
+
+   px_smoother_set_target(&delay->time_smoother, time);
+   if (!px_smoother_is_smoothing(&delay->time_smoother))
+	   px_delay_split_time(delay, time);
+}
+
+static void px_delay_mono_set_smoothing(px_delay_line* delay, float smoothing)
+{
+	assert(delay);
+	px_smoother_set_time(&delay->time_smoother, smoothing);
+}
+
+static void px_delay_stereo_set_smoothing(px_stereo_delay* delay, float smoothing)
+{
+	assert(delay);
+	px_delay_mono_set_smoothing(&delay->left, smoothing);
+	px_delay_mono_set_smoothing(&delay->right, smoothing);
+}
+
+static void px_delay_mono_reset(px_delay_line* delay)
+{
+	assert(delay);
+	memset(delay->buffer.data, 0, sizeof(BUFFER_TYPE) * delay->buffer.max_length);
+}
+
+static void px_delay_stereo_reset(px_stereo_delay* delay)
+{
+	assert(delay);
+	px_delay_mono_reset(&delay->left);
+	px_delay_mono_reset(&delay->right);
 }
 
 static void px_delay_stereo_set_time(px_stereo_delay* delay, float time, CHANNEL_FLAG channel)
@@ -252,51 +297,85 @@ static void px_delay_stereo_set_ping_pong(px_stereo_delay* delay, bool ping_pong
 	delay->ping_pong = ping_pong;
 }
 
-static void px_delay_mono_process(px_delay_line* delay, float* input)
+// the dry signal passes straight through, the echoes are the effect rather than latency to compensate
+static int px_delay_mono_latency_samples(const px_delay_line* delay)
+{
+	assert(delay);
+	return 0;
+}
+
+static int px_delay_stereo_latency_samples(const px_stereo_delay* delay)
+{
+	assert(delay);
+	return 0;
+}
+
+// every read lands inside the buffer, so max_time bounds the loop whatever the time is set to
+static int px_delay_mono_tail_samples(const px_delay_line* delay)
+{
+	assert(delay);
+	return px_silence_tail_echoes(delay->buffer.max_length, delay->parameters.feedback);
+}
+
+// ping-pong hops between the lines, each hop still fits in one buffer and loses one feedback
+static int px_delay_stereo_tail_samples(const px_stereo_delay* delay)
+{
+	assert(delay);
+	return px_silence_longer(px_delay_mono_tail_samples(&delay->left), px_delay_mono_tail_samples(&delay->right));
+}
+
+static void px_delay_mono_process(px_delay_line* delay, SAMPLE_TYPE* input)
 {
     px_assert(delay, input);
+    if (px_smoother_is_smoothing(&delay->time_smoother))
+	px_delay_smooth_time(delay);
 
     int read1 = (delay->buffer.head - delay->parameters.time.whole + delay->buffer.max_length) % delay->buffer.max_length;
     int read2 = (read1 + 1) % delay->buffer.max_length;
 
-    float delayed1 = px_circular_get_sample(&delay->buffer, (size_t) read1);
-    float delayed2 = px_circular_get_sample(&delay->buffer, (size_t) read2);
+    SAMPLE_TYPE delayed1 = px_circular_get_sample(&delay->buffer, (size_t) read1);
+    SAMPLE_TYPE delayed2 = px_circular_get_sample(&delay->buffer, (size_t) read2);
     
     // linear interpolation
-    float delayed_interp = delayed1 + delay->parameters.time.fraction * (delayed2 - delayed1);
+    SAMPLE_TYPE delayed_interp = delayed1 + delay->parameters.time.fraction * (delayed2 - delayed1);
     
-    float feedback = (*input) + (delay->parameters.feedback * delayed_interp);
-    px_circular_push(&delay->buffer, feedback);
+    SAMPLE_TYPE feedback = (*input) + (delay->parameters.feedback * delayed_interp);
+    px_circular_push(&delay->buffer, px_flush_denormal(feedback));	// the loop decays toward zero forever
 
-    float output = ((1.0f - delay->parameters.dry_wet) * (*input)) + (delay->parameters.dry_wet * delayed_interp);
+    SAMPLE_TYPE output = ((1.0f - delay->parameters.dry_wet) * (*input)) + (delay->parameters.dry_wet * delayed_interp);
     *input = output;
 }
 
-static void px_delay_stereo_process(px_stereo_delay* delay, float* input_left, float* input_right)
+static void px_delay_stereo_process(px_stereo_delay* delay, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right)
 {
 	px_assert(delay, input_left, input_right);
 	
 	if (delay->ping_pong)
 	{
+		if (px_smoother_is_smoothing(&delay->left.time_smoother))
+			px_delay_smooth_time(&delay->left);
+		if (px_smoother_is_smoothing(&delay->right.time_smoother))
+			px_delay_smooth_time(&delay->right);
+
         int read_left1 = (delay->left.buffer.head - delay->left.parameters.time.whole + delay->left.buffer.max_length) % delay->left.buffer.max_length;
         int read_right1 = (delay->right.buffer.head - (delay->right.parameters.time.whole + (delay->left.parameters.time.whole / 2)) + delay->right.buffer.max_length) % delay->left.buffer.max_length; 
 		int read_left2 = (read_left1 + 1) % delay->left.buffer.max_length;
 		int read_right2 = (read_right1 + 1) % delay->right.buffer.max_length;
 
-		float delayed_left1 = px_circular_get_sample(&delay->left.buffer, (size_t) read_left1);
-		float delayed_left2 = px_circular_get_sample(&delay->left.buffer, (size_t) read_left2);
-		float delayed_right1 = px_circular_get_sample(&delay->right.buffer, (size_t) read_right1);
-		float delayed_right2 = px_circular_get_sample(&delay->right.buffer, (size_t) read_right2);
+		SAMPLE_TYPE delayed_left1 = px_circular_get_sample(&delay->left.buffer, (size_t) read_left1);
+		SAMPLE_TYPE delayed_left2 = px_circular_get_sample(&delay->left.buffer, (size_t) read_left2);
+		SAMPLE_TYPE delayed_right1 = px_circular_get_sample(&delay->right.buffer, (size_t) read_right1);
+		SAMPLE_TYPE delayed_right2 = px_circular_get_sample(&delay->right.buffer, (size_t) read_right2);
 
-		float delayed_interp_left = delayed_left1 + delay->left.parameters.time.fraction * (delayed_left2 - delayed_left1);
-		float delayed_interp_right = delayed_right1 + delay->right.parameters.time.fraction * (delayed_right2 - delayed_right1);
+		SAMPLE_TYPE delayed_interp_left = delayed_left1 + delay->left.parameters.time.fraction * (delayed_left2 - delayed_left1);
+		SAMPLE_TYPE delayed_interp_right = delayed_right1 + delay->right.parameters.time.fraction * (delayed_right2 - delayed_right1);
 
-    	float feedback_left = (*input_left) + (delay->left.parameters.feedback * delayed_interp_right); // Right feedback to left
-    	float feedback_right = (*input_right) + (delay->right.parameters.feedback * delayed_interp_left); // Left feedback to right
+    	SAMPLE_TYPE feedback_left = (*input_left) + (delay->left.parameters.feedback * delayed_interp_right); // Right feedback to left
+    	SAMPLE_TYPE feedback_right = (*input_right) + (delay->right.parameters.feedback * delayed_interp_left); // Left feedback to right
 
     	// Push feedback into respective buffers
-    	px_circular_push(&delay->left.buffer, feedback_left);
-    	px_circular_push(&delay->right.buffer, feedback_right);
+    	px_circular_push(&delay->left.buffer, px_flush_denormal(feedback_left));
+    	px_circular_push(&delay->right.buffer, px_flush_denormal(feedback_right));
 
 		*input_left = ((1.0f - delay->left.parameters.dry_wet) * (*input_left)) + (delay->left.parameters.dry_wet * delayed_interp_left);
 		*input_right = ((1.0f - delay->right.parameters.dry_wet) * (*input_right)) + (delay->right.parameters.dry_wet * delayed_interp_right);
@@ -308,4 +387,69 @@ static void px_delay_stereo_process(px_stereo_delay* delay, float* input_left, f
 	}
 }
 
+// per sample underneath, the block call adds the tail skipping
+static void px_delay_mono_process_block(px_delay_line* delay, SAMPLE_TYPE* input, int num_samples)
+{
+	px_assert(delay, input);
+	PX_PROFILE_BEGIN("px_delay_line", delay);
+
+	const bool asleep = delay->silence.asleep;
+	const bool silent = px_is_silent(input, num_samples);
+	if (px_silence_skip(&delay->silence, silent, num_samples, silent ? px_delay_mono_tail_samples(delay) : PX_TAIL_INFINITE))
+	{
+		if (!asleep)
+			px_delay_mono_reset(delay);
+		memset(input, 0, sizeof(SAMPLE_TYPE) * num_samples);
+		PX_PROFILE_END(num_samples);
+		return;
+	}
+
+	px_fp_mode mode = px_denormals_disable();
+	for (int i = 0; i < num_samples; ++i)
+		px_delay_mono_process(delay, input + i);
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+static void px_delay_stereo_process_block(px_stereo_delay* delay, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples)
+{
+	px_assert(delay, input_left, input_right);
+	PX_PROFILE_BEGIN("px_stereo_delay", delay);
+
+	const bool asleep = delay->left.silence.asleep;
+	const bool silent = px_is_silent(input_left, num_samples) && px_is_silent(input_right, num_samples);
+	if (px_silence_skip(&delay->left.silence, silent, num_samples, silent ? px_delay_stereo_tail_samples(delay) : PX_TAIL_INFINITE))
+	{
+		if (!asleep)
+			px_delay_stereo_reset(delay);
+		memset(input_left, 0, sizeof(SAMPLE_TYPE) * num_samples);
+		memset(input_right, 0, sizeof(SAMPLE_TYPE) * num_samples);
+		PX_PROFILE_END(num_samples);
+		return;
+	}
+
+	px_fp_mode mode = px_denormals_disable();
+	for (int i = 0; i < num_samples; ++i)
+		px_delay_stereo_process(delay, input_left + i, input_right + i);
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+// seconds -> whole samples + fraction for the interpolated read
+static inline void px_delay_split_time(px_delay_line* delay, float time)
+{
+	delay->parameters.time.seconds = time;
+
+	float time_in_samples = delay->parameters.sample_rate * time;
+	delay->parameters.time.whole = (int)floorf(time_in_samples);
+	delay->parameters.time.fraction = time_in_samples - delay->parameters.time.whole;
+}
+
+static inline void px_delay_smooth_time(px_delay_line* delay)
+{
+	px_delay_split_time(delay, px_smoother_next(&delay->time_smoother));
+}
+
 #endif
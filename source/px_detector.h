@@ -0,0 +1,243 @@
+#include "px_globals.h"
+#include "px_buffer.h"
+#include "px_memory.h"
+
+#ifndef PX_DETECTOR_H
+#define PX_DETECTOR_H
+
+/*
+	px_detector.h
+
+	level detector in front of the compressor envelope, every mode is O(1) per sample
+
+	DETECTOR_PEAK       |x|, no state, the default
+	DETECTOR_RMS        sqrt of the mean square over the window, running sum over a ring of squares
+	                    resynced once per lap of the ring so float error can't drift: a second sum
+	                    adds each square as it goes in and replaces the running sum when the lap ends
+	DETECTOR_PEAK_HOLD  max |x| over the window (px_sliding_max)
+	DETECTOR_CREST      blends the windowed RMS and the windowed peak by crest factor (peak / rms):
+	                    steady material (crest PX_DETECTOR_CREST_SINE and below) reads as RMS,
+	                    transients (PX_DETECTOR_CREST_PEAK and above) read as peak
+
+	init:
+		px_level_detector detector;
+		px_level_detector_initialize(&detector, sample_rate);
+		px_level_detector_set_mode(&detector, DETECTOR_RMS);	// allocates the window the first time
+		px_level_detector_set_window(&detector, 10.f);		// ms, up to PX_DETECTOR_MAX_WINDOW
+
+		px_level_detector_free(&detector);
+
+	use:
+		SAMPLE_TYPE level = px_level_detector_run(&detector, sidechain);
+		px_level_detector_process_block(&detector, sidechain, levels, num_samples);
+*/
+
+#ifndef PX_DETECTOR_MAX_WINDOW
+	#define PX_DETECTOR_MAX_WINDOW 100.f	// ms
+#endif
+
+#define PX_DETECTOR_CREST_SINE 1.41421356f	// crest factor read fully as RMS
+#define PX_DETECTOR_CREST_PEAK 4.f		// crest factor (~12 dB) read fully as peak
+
+typedef enum
+{
+	DETECTOR_PEAK,
+	DETECTOR_RMS,
+	DETECTOR_PEAK_HOLD,
+	DETECTOR_CREST
+} DETECTOR_MODE;
+
+typedef struct
+{
+	DETECTOR_MODE mode;
+	float sample_rate;
+	float window;		// ms
+
+	int length;		// window, samples
+	int capacity;		// 0 until a windowed mode is set
+
+	SAMPLE_TYPE* squares;	// ring, RMS and crest
+	double sum;
+	double lap;		// squares pushed since the ring last wrapped, the resynced sum
+	int position;
+
+	px_sliding_max maximum;	// peak hold and crest
+} px_level_detector;
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_level_detector_initialize(px_level_detector* detector, float sample_rate);
+static void px_level_detector_free(px_level_detector* detector);
+static void px_level_detector_reset(px_level_detector* detector);
+static void px_level_detector_set_mode(px_level_detector* detector, DETECTOR_MODE mode);
+static void px_level_detector_set_window(px_level_detector* detector, float window);
+static void px_level_detector_process_block(px_level_detector* detector, const SAMPLE_TYPE* input, SAMPLE_TYPE* output, int num_samples);
+
+static inline SAMPLE_TYPE px_level_detector_run(px_level_detector* detector, SAMPLE_TYPE input);
+static inline SAMPLE_TYPE px_level_detector_mean_square(px_level_detector* detector, SAMPLE_TYPE input);
+static inline SAMPLE_TYPE px_level_detector_crest(SAMPLE_TYPE peak, SAMPLE_TYPE mean_square);
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_level_detector_initialize(px_level_detector* detector, float sample_rate)
+{
+	assert(detector);
+	detector->mode = DETECTOR_PEAK;
+	detector->sample_rate = sample_rate;
+	detector->window = 10.f;
+	detector->length = 1;
+	detector->capacity = 0;
+	detector->squares = NULL;
+	detector->sum = 0.0;
+	detector->lap = 0.0;
+	detector->position = 0;
+}
+
+static void px_level_detector_free(px_level_detector* detector)
+{
+	assert(detector);
+	if (detector->capacity > 0)
+	{
+		px_free(detector->squares);
+		px_sliding_max_free(&detector->maximum);
+		detector->capacity = 0;
+	}
+	detector->mode = DETECTOR_PEAK;
+}
+
+static void px_level_detector_reset(px_level_detector* detector)
+{
+	assert(detector);
+	if (detector->capacity == 0)
+		return;
+
+	int length = (int)(detector->window * 0.001f * detector->sample_rate + 0.5f);
+	detector->length = (length < 1) ? 1 : ((length > detector->capacity) ? detector->capacity : length);
+
+	memset(detector->squares, 0, sizeof(SAMPLE_TYPE) * detector->capacity);
+	detector->sum = 0.0;
+	detector->lap = 0.0;
+	detector->position = 0;
+	px_sliding_max_reset(&detector->maximum, detector->length);
+}
+
+static void px_level_detector_set_mode(px_level_detector* detector, DETECTOR_MODE mode)
+{
+	assert(detector);
+	if (mode < DETECTOR_PEAK || mode > DETECTOR_CREST)
+	{
+		printf("Invalid detector mode");
+		return;
+	}
+
+	// windowed modes allocate once, peak never does
+	if (mode != DETECTOR_PEAK && detector->capacity == 0)
+	{
+		int capacity = (int)(PX_DETECTOR_MAX_WINDOW * 0.001f * detector->sample_rate) + 1;
+		detector->squares = (SAMPLE_TYPE*)px_malloc(sizeof(SAMPLE_TYPE) * capacity);
+		px_sliding_max_initialize(&detector->maximum, capacity);
+		detector->capacity = capacity;
+	}
+
+	detector->mode = mode;
+	px_level_detector_reset(detector);
+}
+
+static void px_level_detector_set_window(px_level_detector* detector, float window)
+{
+	assert(detector);
+	detector->window = px_fmin(px_fmax(window, 0.f), PX_DETECTOR_MAX_WINDOW);
+	px_level_detector_reset(detector);
+}
+
+// mode switch hoisted out of the loop
+static void px_level_detector_process_block(px_level_detector* detector, const SAMPLE_TYPE* input, SAMPLE_TYPE* output, int num_samples)
+{
+	px_assert(detector, input, output);
+
+	switch (detector->mode)
+	{
+	case DETECTOR_PEAK:
+		for (int i = 0; i < num_samples; ++i)
+			output[i] = px_fabs(input[i]);
+		break;
+
+	case DETECTOR_RMS:
+		for (int i = 0; i < num_samples; ++i)
+			output[i] = px_sqrt(px_level_detector_mean_square(detector, input[i]));
+		break;
+
+	case DETECTOR_PEAK_HOLD:
+		for (int i = 0; i < num_samples; ++i)
+			output[i] = px_sliding_max_push(&detector->maximum, px_fabs(input[i]));
+		break;
+
+	case DETECTOR_CREST:
+		for (int i = 0; i < num_samples; ++i)
+		{
+			SAMPLE_TYPE mean_square = px_level_detector_mean_square(detector, input[i]);
+			SAMPLE_TYPE peak = px_sliding_max_push(&detector->maximum, px_fabs(input[i]));
+			output[i] = px_level_detector_crest(peak, mean_square);
+		}
+		break;
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static inline SAMPLE_TYPE px_level_detector_run(px_level_detector* detector, SAMPLE_TYPE input)
+{
+	switch (detector->mode)
+	{
+	case DETECTOR_RMS:
+		return px_sqrt(px_level_detector_mean_square(detector, input));
+
+	case DETECTOR_PEAK_HOLD:
+		return px_sliding_max_push(&detector->maximum, px_fabs(input));
+
+	case DETECTOR_CREST:
+	{
+		SAMPLE_TYPE mean_square = px_level_detector_mean_square(detector, input);
+		SAMPLE_TYPE peak = px_sliding_max_push(&detector->maximum, px_fabs(input));
+		return px_level_detector_crest(peak, mean_square);
+	}
+
+	default:
+		return px_fabs(input);
+	}
+}
+
+// push one square into the ring, return the window mean
+static inline SAMPLE_TYPE px_level_detector_mean_square(px_level_detector* detector, SAMPLE_TYPE input)
+{
+	SAMPLE_TYPE square = input * input;
+	detector->sum += square - detector->squares[detector->position];
+	detector->squares[detector->position] = square;
+	detector->lap += square;
+
+	if (++detector->position == detector->length)
+	{
+		// a lap later the ring holds exactly the squares summed into lap, the running sum's
+		// error never outlives a window and no sample pays for a pass over the ring
+		detector->position = 0;
+		detector->sum = detector->lap;
+		detector->lap = 0.0;
+	}
+
+	// subtracting can leave a tiny negative behind before the next resync
+	double mean = detector->sum / (double)detector->length;
+	return (mean > 0.0) ? (SAMPLE_TYPE)mean : 0.f;
+}
+
+static inline SAMPLE_TYPE px_level_detector_crest(SAMPLE_TYPE peak, SAMPLE_TYPE mean_square)
+{
+	SAMPLE_TYPE rms = px_sqrt(mean_square);
+	if (rms <= 0.f)
+		return peak;
+
+	SAMPLE_TYPE blend = (peak / rms - PX_DETECTOR_CREST_SINE) / (PX_DETECTOR_CREST_PEAK - PX_DETECTOR_CREST_SINE);
+	blend = px_fmin(px_fmax(blend, 0.f), 1.f);
+	return rms + blend * (peak - rms);
+}
+
+#endif
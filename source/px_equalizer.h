@@ -2,6 +2,7 @@
 #include "px_biquad.h"
 #include "px_vector.h"
 #include "px_globals.h"
+#include "px_meter.h"
 
 #ifndef PX_EQUALIZER_H
 #define PX_EQUALIZER_H
@@ -34,19 +35,26 @@
 	{
 		px_vector filter_bank;  // type-generic vector filled with px_mono_biquad filters
 		float sample_rate;
+		float smoothing;	// ms, applied to every band
+		int control_block;	// biquad modulation mode, 0 = off
+		bool lookup;		// bands take K and V from the px_biquad lookup tables, off = exact design
 		int num_bands;
+		px_meter* meter;	// output level, NULL = off
+		px_silence silence;	// block API tail skipping, the bands keep their own as well
 	} px_mono_equalizer;
 
 	typedef struct px_stereo_equalizer
 	{
 		px_mono_equalizer left;
 		px_mono_equalizer right;
+		px_meter* meter;
 	} px_stereo_equalizer;
 
 	typedef struct px_ms_equalizer
 	{
 		px_mono_equalizer mid;
 		px_mono_equalizer side;
+		px_meter* meter;
 	} px_ms_equalizer;
 
 	// ----------------------------------------------------------------------------------------------------
@@ -101,10 +109,17 @@
 	px_stereo_equalizer*: px_equalizer_stereo_set_type,		\
 	px_ms_equalizer*: px_equalizer_ms_set_type)			\
 		(a,b,c,__VA_ARGS__)
+
+#define px_equalizer_set_topology(a,b,c,...) _Generic((a),		\
+	px_mono_equalizer*: px_equalizer_mono_set_topology,		\
+	px_stereo_equalizer*: px_equalizer_stereo_set_topology,	\
+	px_ms_equalizer*: px_equalizer_ms_set_topology)		\
+		(a,b,c,__VA_ARGS__)
 #endif
 
 // mono
-	static void px_equalizer_mono_process(px_mono_equalizer* equalizer, float* input);
+	static void px_equalizer_mono_process(px_mono_equalizer* equalizer, SAMPLE_TYPE* input);
+	static void px_equalizer_mono_process_block(px_mono_equalizer* equalizer, SAMPLE_TYPE* input, int num_samples);
 	static void px_equalizer_mono_initialize(px_mono_equalizer* equalizer, float sample_rate);
 	static void px_equalizer_mono_add_band(px_mono_equalizer* equalizer, float frequency, float quality, float gain, BIQUAD_FILTER_TYPE type);
 	static void px_equalizer_mono_remove_band(px_mono_equalizer* equalizer, size_t index);
@@ -113,9 +128,18 @@
 	static void px_equalizer_mono_set_quality(px_mono_equalizer* equalizer, size_t index, float in_quality);
 	static void px_equalizer_mono_set_gain(px_mono_equalizer* equalizer, size_t index, float in_gain);
 	static void px_equalizer_mono_set_type(px_mono_equalizer* equalizer, size_t index, BIQUAD_FILTER_TYPE in_type);
+	static void px_equalizer_mono_set_topology(px_mono_equalizer* equalizer, size_t index, BIQUAD_TOPOLOGY in_topology);
+	static void px_equalizer_mono_set_smoothing(px_mono_equalizer* equalizer, float in_time);
+	static void px_equalizer_mono_set_modulation(px_mono_equalizer* equalizer, int control_block);
+	static void px_equalizer_mono_set_lookup(px_mono_equalizer* equalizer, bool lookup);	// faster coefficient updates, see px_biquad.h
+	static void px_equalizer_mono_set_meter(px_mono_equalizer* equalizer, px_meter* meter);
+	static int px_equalizer_mono_latency_samples(const px_mono_equalizer* equalizer);	// 0
+	static int px_equalizer_mono_tail_samples(const px_mono_equalizer* equalizer);	// longest band
+	static void px_equalizer_mono_reset(px_mono_equalizer* equalizer);	// clears every band's state
 
 	// stereo
-	static void px_equalizer_stereo_process(px_stereo_equalizer* stereo_equalizer, float* input_left, float* input_right);
+	static void px_equalizer_stereo_process(px_stereo_equalizer* stereo_equalizer, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right);
+	static void px_equalizer_stereo_process_block(px_stereo_equalizer* stereo_equalizer, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples);
 	static void px_equalizer_stereo_initialize(px_stereo_equalizer* stereo_equalizer, float sample_rate);
 	static void px_equalizer_stereo_add_band(px_stereo_equalizer* stereo_equalizer, float frequency, float quality, float gain, BIQUAD_FILTER_TYPE type);
 	static void px_equalizer_stereo_remove_band(px_stereo_equalizer* stereo_equalizer, size_t index);
@@ -124,10 +148,18 @@
 	static void px_equalizer_stereo_set_quality(px_stereo_equalizer* stereo_equalizer, size_t index, float in_quality, CHANNEL_FLAG channel);
 	static void px_equalizer_stereo_set_gain(px_stereo_equalizer* stereo_equalizer, size_t index, float in_gain, CHANNEL_FLAG channel);
 	static void px_equalizer_stereo_set_type(px_stereo_equalizer* stereo_equalizer, size_t index, BIQUAD_FILTER_TYPE in_type, CHANNEL_FLAG channel);
+	static void px_equalizer_stereo_set_topology(px_stereo_equalizer* stereo_equalizer, size_t index, BIQUAD_TOPOLOGY in_topology, CHANNEL_FLAG channel);
+	static void px_equalizer_stereo_set_smoothing(px_stereo_equalizer* stereo_equalizer, float in_time);
+	static void px_equalizer_stereo_set_modulation(px_stereo_equalizer* stereo_equalizer, int control_block);
+	static void px_equalizer_stereo_set_lookup(px_stereo_equalizer* stereo_equalizer, bool lookup);
+	static void px_equalizer_stereo_set_meter(px_stereo_equalizer* stereo_equalizer, px_meter* meter);
+	static int px_equalizer_stereo_latency_samples(const px_stereo_equalizer* stereo_equalizer);
+	static int px_equalizer_stereo_tail_samples(const px_stereo_equalizer* stereo_equalizer);
+	static void px_equalizer_stereo_reset(px_stereo_equalizer* stereo_equalizer);
 
 	// mid/side
-	static void px_equalizer_ms_process(px_ms_equalizer* ms_equalizer, float* input_left, float* input_right);
-	static px_ms_encoded px_equalizer_ms_process_and_return(px_ms_equalizer* ms_equalizer, float input_left, float input_right);
+	static void px_equalizer_ms_process(px_ms_equalizer* ms_equalizer, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right);
+	static px_ms_encoded px_equalizer_ms_process_and_return(px_ms_equalizer* ms_equalizer, SAMPLE_TYPE input_left, SAMPLE_TYPE input_right);
 	static void px_equalizer_ms_initialize(px_ms_equalizer* ms_equalizer, float sample_rate);
 	static void px_equalizer_ms_add_band(px_ms_equalizer* ms_equalizer, float frequency, float quality, float gain, BIQUAD_FILTER_TYPE type);
 	static void px_equalizer_ms_remove_band(px_ms_equalizer* ms_equalizer, size_t index);
@@ -136,28 +168,101 @@
 	static void px_equalizer_ms_set_quality(px_ms_equalizer* ms_equalizer, size_t index, float in_quality, CHANNEL_FLAG channel);
 	static void px_equalizer_ms_set_gain(px_ms_equalizer* ms_equalizer, size_t index, float in_gain, CHANNEL_FLAG channel);
 	static void px_equalizer_ms_set_type(px_ms_equalizer* ms_equalizer, size_t index, BIQUAD_FILTER_TYPE in_type, CHANNEL_FLAG channel);
+	static void px_equalizer_ms_set_topology(px_ms_equalizer* ms_equalizer, size_t index, BIQUAD_TOPOLOGY in_topology, CHANNEL_FLAG channel);
+	static void px_equalizer_ms_set_smoothing(px_ms_equalizer* ms_equalizer, float in_time);
+	static void px_equalizer_ms_set_modulation(px_ms_equalizer* ms_equalizer, int control_block);
+	static void px_equalizer_ms_set_lookup(px_ms_equalizer* ms_equalizer, bool lookup);
+	static void px_equalizer_ms_set_meter(px_ms_equalizer* ms_equalizer, px_meter* meter);
+	static int px_equalizer_ms_latency_samples(const px_ms_equalizer* ms_equalizer);
+	static int px_equalizer_ms_tail_samples(const px_ms_equalizer* ms_equalizer);
+	static void px_equalizer_ms_reset(px_ms_equalizer* ms_equalizer);
 
 
 	// ----------------------------------------------------------------------------------------------------
 
-	static void px_equalizer_mono_process(px_mono_equalizer* equalizer, float* input)
+	static void px_equalizer_mono_process(px_mono_equalizer* equalizer, SAMPLE_TYPE* input)
 	{
 		px_assert(equalizer, input);
 		for (int i = 0; i < equalizer->num_bands; ++i)
 		{
 			px_biquad_process((px_biquad*)px_vector_get(&equalizer->filter_bank, i), input);
 		}
+
+		if (equalizer->meter)
+		{
+			px_meter_level(equalizer->meter, *input);
+			px_meter_advance(equalizer->meter, 1);
+		}
 	}
 
-	static void px_equalizer_stereo_process(px_stereo_equalizer* stereo_equalizer, float* input_left, float* input_right)
+	static void px_equalizer_stereo_process(px_stereo_equalizer* stereo_equalizer, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right)
 	{
 		px_assert(stereo_equalizer, input_left, input_right);
 		px_equalizer_mono_process(&stereo_equalizer->left, input_left);
 		px_equalizer_mono_process(&stereo_equalizer->right, input_right);
 
+		if (stereo_equalizer->meter)
+		{
+			px_meter_level(stereo_equalizer->meter, *input_left);
+			px_meter_level(stereo_equalizer->meter, *input_right);
+			px_meter_advance(stereo_equalizer->meter, 1);
+		}
+
+	}
+
+	// band by band over the whole block, each biquad keeps its state in registers
+	static void px_equalizer_mono_process_block(px_mono_equalizer* equalizer, SAMPLE_TYPE* input, int num_samples)
+	{
+		px_assert(equalizer, input);
+		PX_PROFILE_BEGIN("px_mono_equalizer", equalizer);
+
+		// one scan for every band, skipped bands start from a cleared state
+		const bool asleep = equalizer->silence.asleep;
+		const bool silent = px_is_silent(input, num_samples);
+		if (px_silence_skip(&equalizer->silence, silent, num_samples, silent ? px_equalizer_mono_tail_samples(equalizer) : PX_TAIL_INFINITE))
+		{
+			if (!asleep)
+				px_equalizer_mono_reset(equalizer);
+			memset(input, 0, sizeof(SAMPLE_TYPE) * num_samples);
+			if (equalizer->meter)
+			{
+				px_meter_level_block(equalizer->meter, input, num_samples);
+				px_meter_advance(equalizer->meter, num_samples);
+			}
+			PX_PROFILE_END(num_samples);
+			return;
+		}
+
+		px_fp_mode mode = px_denormals_disable();
+		for (int i = 0; i < equalizer->num_bands; ++i)
+		{
+			px_biquad_process_block((px_biquad*)px_vector_get(&equalizer->filter_bank, i), input, num_samples);
+		}
+
+		if (equalizer->meter)
+		{
+			px_meter_level_block(equalizer->meter, input, num_samples);
+			px_meter_advance(equalizer->meter, num_samples);
+		}
+		px_denormals_restore(mode);
+		PX_PROFILE_END(num_samples);
 	}
 
-	static void px_equalizer_ms_process(px_ms_equalizer* ms_equalizer, float* input_left, float* input_right)
+	static void px_equalizer_stereo_process_block(px_stereo_equalizer* stereo_equalizer, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples)
+	{
+		px_assert(stereo_equalizer, input_left, input_right);
+		px_equalizer_mono_process_block(&stereo_equalizer->left, input_left, num_samples);
+		px_equalizer_mono_process_block(&stereo_equalizer->right, input_right, num_samples);
+
+		if (stereo_equalizer->meter)
+		{
+			px_meter_level_block(stereo_equalizer->meter, input_left, num_samples);
+			px_meter_level_block(stereo_equalizer->meter, input_right, num_samples);
+			px_meter_advance(stereo_equalizer->meter, num_samples);
+		}
+	}
+
+	static void px_equalizer_ms_process(px_ms_equalizer* ms_equalizer, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right)
 	{
 		px_assert(ms_equalizer, input_left, input_right);
 		px_ms_decoded decoded = { 0.f, 0.f };
@@ -174,9 +279,16 @@
 
 		*input_left = decoded.left;
 		*input_right = decoded.right;
+
+		if (ms_equalizer->meter)
+		{
+			px_meter_level(ms_equalizer->meter, *input_left);
+			px_meter_level(ms_equalizer->meter, *input_right);
+			px_meter_advance(ms_equalizer->meter, 1);
+		}
 	}
 	
-	static px_ms_encoded px_equalizer_ms_process_and_return(px_ms_equalizer* ms_equalizer, float input_left, float input_right)
+	static px_ms_encoded px_equalizer_ms_process_and_return(px_ms_equalizer* ms_equalizer, SAMPLE_TYPE input_left, SAMPLE_TYPE input_right)
 	{
 		assert(ms_equalizer);
 		px_ms_decoded decoded = { 0.f, 0.f };
@@ -196,7 +308,13 @@
 	{
 		assert(equalizer);
 		equalizer->sample_rate = sample_rate;
+		equalizer->smoothing = 0.f;
+		equalizer->control_block = 0;
+		equalizer->lookup = false;
 		equalizer->num_bands = 0;
+		equalizer->meter = NULL;
+		px_silence_reset(&equalizer->silence);
+		px_biquad_lookup_initialize();
 
 		px_vector_initialize(&equalizer->filter_bank);
 	}
@@ -206,6 +324,7 @@
 		assert(stereo_equalizer);
 		px_equalizer_mono_initialize(&stereo_equalizer->left, sample_rate);
 		px_equalizer_mono_initialize(&stereo_equalizer->right, sample_rate);
+		stereo_equalizer->meter = NULL;
 	}
 
 	static void px_equalizer_ms_initialize(px_ms_equalizer* ms_equalizer, float sample_rate)
@@ -213,6 +332,7 @@
 		assert(ms_equalizer);
 		px_equalizer_mono_initialize(&ms_equalizer->mid, sample_rate);
 		px_equalizer_mono_initialize(&ms_equalizer->side, sample_rate);
+		ms_equalizer->meter = NULL;
 	}
 
 
@@ -220,10 +340,13 @@
 	{
 		assert(equalizer);
 		px_biquad* new_filter = px_biquad_create(equalizer->sample_rate, type);
+		px_biquad_set_lookup(new_filter, equalizer->lookup);
 
 		px_biquad_set_frequency(new_filter, frequency);
 		px_biquad_set_quality(new_filter, quality);
 		px_biquad_set_gain(new_filter, gain);
+		px_biquad_set_smoothing(new_filter, equalizer->smoothing);
+		px_biquad_set_modulation(new_filter, equalizer->control_block);
 
 		px_vector_push(&equalizer->filter_bank, new_filter);
 		equalizer->num_bands++;
@@ -507,4 +630,215 @@
 		}
 	}
 
+	// BIQUAD_SVF for bands far below the sample rate, sub-bass shelves and high-passes
+	static void px_equalizer_mono_set_topology(px_mono_equalizer* equalizer, size_t index, BIQUAD_TOPOLOGY in_topology)
+	{
+		assert(equalizer);
+		if (index < equalizer->num_bands)
+		{
+			px_biquad* filter = (px_biquad*)px_vector_get(&equalizer->filter_bank, index);
+			px_biquad_set_topology(filter, in_topology);
+		}
+	}
+
+	static void px_equalizer_stereo_set_topology(px_stereo_equalizer* stereo_equalizer, size_t index, BIQUAD_TOPOLOGY in_topology, CHANNEL_FLAG channel)
+	{
+		assert(stereo_equalizer);
+		switch (channel) {
+		case BOTH: {
+			px_equalizer_mono_set_topology(&stereo_equalizer->left, index, in_topology);
+			px_equalizer_mono_set_topology(&stereo_equalizer->right, index, in_topology);
+			break;
+		}
+		case LEFT: {
+			px_equalizer_mono_set_topology(&stereo_equalizer->left, index, in_topology);
+			break;
+		}
+		case RIGHT:	{
+			px_equalizer_mono_set_topology(&stereo_equalizer->right, index, in_topology);
+			break;
+		}
+		default: {
+        	printf("Invalid Channel Flag");
+        	break;
+    	}
+		}
+	}
+
+	static void px_equalizer_ms_set_topology(px_ms_equalizer* ms_equalizer, size_t index, BIQUAD_TOPOLOGY in_topology, CHANNEL_FLAG channel)
+	{
+		assert(ms_equalizer);
+		switch (channel)
+		{
+		case BOTH:{
+			px_equalizer_mono_set_topology(&ms_equalizer->mid, index, in_topology);
+			px_equalizer_mono_set_topology(&ms_equalizer->side, index, in_topology);
+			break;
+		}
+		case MID:{
+			px_equalizer_mono_set_topology(&ms_equalizer->mid, index, in_topology);
+			break;
+		}
+		case SIDE:{
+			px_equalizer_mono_set_topology(&ms_equalizer->side, index, in_topology);
+			break;
+		}
+		default: {
+        	printf("Invalid Channel Flag");
+        	break;
+    	}
+		}
+	}
+
+	static void px_equalizer_mono_set_smoothing(px_mono_equalizer* equalizer, float in_time)
+	{
+		assert(equalizer);
+		equalizer->smoothing = in_time;
+		for (int i = 0; i < equalizer->num_bands; ++i)
+		{
+			px_biquad_set_smoothing((px_biquad*)px_vector_get(&equalizer->filter_bank, i), in_time);
+		}
+	}
+
+	static void px_equalizer_stereo_set_smoothing(px_stereo_equalizer* stereo_equalizer, float in_time)
+	{
+		assert(stereo_equalizer);
+		px_equalizer_mono_set_smoothing(&stereo_equalizer->left, in_time);
+		px_equalizer_mono_set_smoothing(&stereo_equalizer->right, in_time);
+	}
+
+	static void px_equalizer_ms_set_smoothing(px_ms_equalizer* ms_equalizer, float in_time)
+	{
+		assert(ms_equalizer);
+		px_equalizer_mono_set_smoothing(&ms_equalizer->mid, in_time);
+		px_equalizer_mono_set_smoothing(&ms_equalizer->side, in_time);
+	}
+
+	static void px_equalizer_mono_set_modulation(px_mono_equalizer* equalizer, int control_block)
+	{
+		assert(equalizer);
+		equalizer->control_block = control_block;
+		for (int i = 0; i < equalizer->num_bands; ++i)
+		{
+			px_biquad_set_modulation((px_biquad*)px_vector_get(&equalizer->filter_bank, i), control_block);
+		}
+	}
+
+	static void px_equalizer_stereo_set_modulation(px_stereo_equalizer* stereo_equalizer, int control_block)
+	{
+		assert(stereo_equalizer);
+		px_equalizer_mono_set_modulation(&stereo_equalizer->left, control_block);
+		px_equalizer_mono_set_modulation(&stereo_equalizer->right, control_block);
+	}
+
+	static void px_equalizer_ms_set_modulation(px_ms_equalizer* ms_equalizer, int control_block)
+	{
+		assert(ms_equalizer);
+		px_equalizer_mono_set_modulation(&ms_equalizer->mid, control_block);
+		px_equalizer_mono_set_modulation(&ms_equalizer->side, control_block);
+	}
+
+	static void px_equalizer_mono_set_lookup(px_mono_equalizer* equalizer, bool lookup)
+	{
+		assert(equalizer);
+		equalizer->lookup = lookup;
+		for (int i = 0; i < equalizer->num_bands; ++i)
+		{
+			px_biquad_set_lookup((px_biquad*)px_vector_get(&equalizer->filter_bank, i), lookup);
+		}
+	}
+
+	static void px_equalizer_stereo_set_lookup(px_stereo_equalizer* stereo_equalizer, bool lookup)
+	{
+		assert(stereo_equalizer);
+		px_equalizer_mono_set_lookup(&stereo_equalizer->left, lookup);
+		px_equalizer_mono_set_lookup(&stereo_equalizer->right, lookup);
+	}
+
+	static void px_equalizer_ms_set_lookup(px_ms_equalizer* ms_equalizer, bool lookup)
+	{
+		assert(ms_equalizer);
+		px_equalizer_mono_set_lookup(&ms_equalizer->mid, lookup);
+		px_equalizer_mono_set_lookup(&ms_equalizer->side, lookup);
+	}
+
+	static void px_equalizer_mono_set_meter(px_mono_equalizer* equalizer, px_meter* meter)
+	{
+		assert(equalizer);
+		equalizer->meter = meter;
+	}
+
+	static void px_equalizer_stereo_set_meter(px_stereo_equalizer* stereo_equalizer, px_meter* meter)
+	{
+		assert(stereo_equalizer);
+		stereo_equalizer->meter = meter;
+	}
+
+	static void px_equalizer_ms_set_meter(px_ms_equalizer* ms_equalizer, px_meter* meter)
+	{
+		assert(ms_equalizer);
+		ms_equalizer->meter = meter;
+	}
+
+	static void px_equalizer_mono_reset(px_mono_equalizer* equalizer)
+	{
+		assert(equalizer);
+		for (int i = 0; i < equalizer->num_bands; ++i)
+			px_biquad_reset((px_biquad*)px_vector_get(&equalizer->filter_bank, i));
+	}
+
+	static void px_equalizer_stereo_reset(px_stereo_equalizer* stereo_equalizer)
+	{
+		assert(stereo_equalizer);
+		px_equalizer_mono_reset(&stereo_equalizer->left);
+		px_equalizer_mono_reset(&stereo_equalizer->right);
+	}
+
+	static void px_equalizer_ms_reset(px_ms_equalizer* ms_equalizer)
+	{
+		assert(ms_equalizer);
+		px_equalizer_mono_reset(&ms_equalizer->mid);
+		px_equalizer_mono_reset(&ms_equalizer->side);
+	}
+
+	// biquads are minimum phase, their group delay is part of the response, not latency
+	static int px_equalizer_mono_latency_samples(const px_mono_equalizer* equalizer)
+	{
+		assert(equalizer);
+		return 0;
+	}
+
+	static int px_equalizer_stereo_latency_samples(const px_stereo_equalizer* stereo_equalizer)
+	{
+		assert(stereo_equalizer);
+		return 0;
+	}
+
+	static int px_equalizer_ms_latency_samples(const px_ms_equalizer* ms_equalizer)
+	{
+		assert(ms_equalizer);
+		return 0;
+	}
+
+	static int px_equalizer_mono_tail_samples(const px_mono_equalizer* equalizer)
+	{
+		assert(equalizer);
+		int tail = 0;
+		for (int i = 0; i < equalizer->num_bands; ++i)
+			tail = px_silence_longer(tail, px_biquad_tail_samples((px_biquad*)px_vector_get((px_vector*)&equalizer->filter_bank, i)));
+		return tail;
+	}
+
+	static int px_equalizer_stereo_tail_samples(const px_stereo_equalizer* stereo_equalizer)
+	{
+		assert(stereo_equalizer);
+		return px_silence_longer(px_equalizer_mono_tail_samples(&stereo_equalizer->left), px_equalizer_mono_tail_samples(&stereo_equalizer->right));
+	}
+
+	static int px_equalizer_ms_tail_samples(const px_ms_equalizer* ms_equalizer)
+	{
+		assert(ms_equalizer);
+		return px_silence_longer(px_equalizer_mono_tail_samples(&ms_equalizer->mid), px_equalizer_mono_tail_samples(&ms_equalizer->side));
+	}
+
 #endif
@@ -0,0 +1,525 @@
+#include "px_globals.h"
+#include "px_memory.h"
+#include "px_graph.h"
+#include "px_profile.h"
+
+// threads and semaphores for the pool, only the executor pulls these in
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#if defined(__APPLE__)
+		#include <dispatch/dispatch.h>
+	#else
+		#include <semaphore.h>
+	#endif
+#endif
+
+#ifndef PX_EXECUTOR_H
+#define PX_EXECUTOR_H
+
+/*
+	px_executor.h
+
+	runs a compiled px_graph across a fixed pool of threads, so independent branches (parallel
+	compression, multiband splits, tracks ahead of a bus) share the block between cores. the
+	calling (audio) thread is worker 0 and works too, it returns once the block is done.
+
+	real-time
+		px_executor_process doesn't allocate, lock or wait on the os. every step has a dependency
+		counter, reset per block from the graph's compiled dependencies, a step that finishes
+		counts its successors down and queues the ones that hit zero (the last one it runs
+		straight away). queues are lock-free chase-lev deques, one per worker: the owner pushes
+		and pops at the bottom, idle workers steal from the top of the others.
+
+		between blocks workers spin for spin iterations, then park on a semaphore. a parked worker
+		costs one semaphore post to wake at the start of the next block, a spinning one nothing.
+		short callbacks: raise spin so the pool stays hot, the price is idle cores burning
+		between callbacks. spin 0 parks right away.
+
+		the pool threads are plain threads, promote them with the host's real-time api (priority,
+		audio workgroup) if it has one.
+
+	init:
+		px_executor executor;
+		px_executor_initialize(&executor, 4);		// threads, including the caller
+		px_executor_set_spin(&executor, 20000);		// pause iterations before parking
+		px_executor_free(&executor);			// joins the pool
+
+	use:
+		px_graph_compile(&graph);
+		px_executor_process(&executor, &graph, inputs, outputs, num_samples);	// instead of px_graph_process
+*/
+
+#define PX_EXECUTOR_MAX_THREADS 64
+#define PX_EXECUTOR_SPIN 10000		// default pause iterations before a worker parks
+#define PX_EXECUTOR_CACHE_LINE 64
+
+// threads
+//
+// just enough to run the pool: start / join, and a semaphore to park on.
+// px_thread stays where it is while the thread runs, it carries the entry point
+
+typedef void (*px_thread_function)(void* argument);
+
+typedef struct
+{
+#if defined(_WIN32)
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+	px_thread_function function;
+	void* argument;
+} px_thread;
+
+typedef struct
+{
+#if defined(_WIN32)
+	HANDLE handle;
+#elif defined(__APPLE__)
+	dispatch_semaphore_t handle;
+#else
+	sem_t handle;
+#endif
+} px_semaphore;
+
+#if defined(_WIN32)
+static DWORD WINAPI px_thread_entry(LPVOID argument)
+{
+	px_thread* thread = (px_thread*)argument;
+	thread->function(thread->argument);
+	return 0;
+}
+#else
+static void* px_thread_entry(void* argument)
+{
+	px_thread* thread = (px_thread*)argument;
+	thread->function(thread->argument);
+	return NULL;
+}
+#endif
+
+static bool px_thread_start(px_thread* thread, px_thread_function function, void* argument)
+{
+	thread->function = function;
+	thread->argument = argument;
+#if defined(_WIN32)
+	thread->handle = CreateThread(NULL, 0, px_thread_entry, thread, 0, NULL);
+	return thread->handle != NULL;
+#else
+	return pthread_create(&thread->handle, NULL, px_thread_entry, thread) == 0;
+#endif
+}
+
+static void px_thread_join(px_thread* thread)
+{
+#if defined(_WIN32)
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+#else
+	pthread_join(thread->handle, NULL);
+#endif
+}
+
+static void px_semaphore_initialize(px_semaphore* semaphore)
+{
+#if defined(_WIN32)
+	semaphore->handle = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
+#elif defined(__APPLE__)
+	semaphore->handle = dispatch_semaphore_create(0);
+#else
+	sem_init(&semaphore->handle, 0, 0);
+#endif
+}
+
+static void px_semaphore_free(px_semaphore* semaphore)
+{
+#if defined(_WIN32)
+	CloseHandle(semaphore->handle);
+#elif defined(__APPLE__)
+	dispatch_release(semaphore->handle);
+#else
+	sem_destroy(&semaphore->handle);
+#endif
+}
+
+static void px_semaphore_post(px_semaphore* semaphore)
+{
+#if defined(_WIN32)
+	ReleaseSemaphore(semaphore->handle, 1, NULL);
+#elif defined(__APPLE__)
+	dispatch_semaphore_signal(semaphore->handle);
+#else
+	sem_post(&semaphore->handle);
+#endif
+}
+
+static void px_semaphore_wait(px_semaphore* semaphore)
+{
+#if defined(_WIN32)
+	WaitForSingleObject(semaphore->handle, INFINITE);
+#elif defined(__APPLE__)
+	dispatch_semaphore_wait(semaphore->handle, DISPATCH_TIME_FOREVER);
+#else
+	while (sem_wait(&semaphore->handle) != 0)
+		;	// EINTR
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// chase-lev deque of step indices, holds a whole block so it never grows
+typedef struct
+{
+	px_atomic_int64 top;		// thieves
+	char padding[PX_EXECUTOR_CACHE_LINE];
+	px_atomic_int64 bottom;		// owner
+	px_atomic_int* items;
+	int mask;
+} px_executor_deque;
+
+typedef struct
+{
+	px_executor_deque deque;
+	px_thread thread;
+	px_semaphore wake;
+	px_atomic_int parked;
+	struct px_executor* executor;
+	int index;
+	char padding[PX_EXECUTOR_CACHE_LINE];
+} px_executor_worker;
+
+typedef struct px_executor
+{
+	int num_threads;	// including the caller
+	px_atomic_int spin;
+
+	px_executor_worker* workers;	// [num_threads], 0 = caller
+	px_atomic_int* pending;		// unfinished dependencies per step
+	px_graph* graph;
+
+	px_atomic_int remaining;	// steps left in the block
+	px_atomic_int generation;	// bumped per block
+	px_atomic_int quit;
+} px_executor;
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_executor* px_executor_create(int num_threads);
+static void px_executor_destroy(px_executor* executor);
+static void px_executor_initialize(px_executor* executor, int num_threads);
+static void px_executor_free(px_executor* executor);
+
+static void px_executor_set_spin(px_executor* executor, int spin);
+static void px_executor_process(px_executor* executor, px_graph* graph, SAMPLE_TYPE** input, SAMPLE_TYPE** output, int num_samples);
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_executor_run(px_executor* executor, int index);
+static void px_executor_worker_main(void* argument);
+static bool px_executor_wait(px_executor* executor, px_executor_worker* worker, int* seen);
+static void px_executor_wake(px_executor* executor);
+
+static void px_executor_deque_initialize(px_executor_deque* deque, int capacity);
+static void px_executor_deque_free(px_executor_deque* deque);
+static void px_executor_deque_push(px_executor_deque* deque, int item);
+static int px_executor_deque_pop(px_executor_deque* deque);	// -1 = empty
+static int px_executor_deque_steal(px_executor_deque* deque);	// -1 = empty or lost the race
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_executor* px_executor_create(int num_threads)
+{
+	px_executor* executor = (px_executor*)px_malloc(sizeof(px_executor));
+	if (executor)
+		px_executor_initialize(executor, num_threads);
+	return executor;
+}
+
+static void px_executor_destroy(px_executor* executor)
+{
+	if (executor)
+	{
+		px_executor_free(executor);
+		px_free(executor);
+	}
+}
+
+static void px_executor_initialize(px_executor* executor, int num_threads)
+{
+	assert(executor);
+	assert(num_threads >= 1 && num_threads <= PX_EXECUTOR_MAX_THREADS);
+
+	// a block never queues more than every step once
+	int capacity = 1;
+	while (capacity < PX_GRAPH_MAX_NODES)
+		capacity <<= 1;
+
+	executor->num_threads = num_threads;
+	px_atomic_init(&executor->spin, PX_EXECUTOR_SPIN);
+	executor->graph = NULL;
+	executor->workers = (px_executor_worker*)px_malloc(sizeof(px_executor_worker) * num_threads);
+	executor->pending = (px_atomic_int*)px_malloc(sizeof(px_atomic_int) * PX_GRAPH_MAX_NODES);
+
+	px_atomic_init(&executor->remaining, 0);
+	px_atomic_init(&executor->generation, 0);
+	px_atomic_init(&executor->quit, 0);
+	for (int step = 0; step < PX_GRAPH_MAX_NODES; ++step)
+		px_atomic_init(&executor->pending[step], 0);
+
+	for (int index = 0; index < num_threads; ++index)
+	{
+		px_executor_worker* worker = &executor->workers[index];
+		px_executor_deque_initialize(&worker->deque, capacity);
+		px_semaphore_initialize(&worker->wake);
+		px_atomic_init(&worker->parked, 0);
+		worker->executor = executor;
+		worker->index = index;
+	}
+
+	// worker 0 is whoever calls process
+	for (int index = 1; index < num_threads; ++index)
+	{
+		if (!px_thread_start(&executor->workers[index].thread, px_executor_worker_main, &executor->workers[index]))
+		{
+			printf("Invalid executor thread");
+			for (int unused = index; unused < num_threads; ++unused)
+			{
+				px_executor_deque_free(&executor->workers[unused].deque);
+				px_semaphore_free(&executor->workers[unused].wake);
+			}
+			executor->num_threads = index;
+			break;
+		}
+	}
+}
+
+static void px_executor_free(px_executor* executor)
+{
+	assert(executor);
+
+	px_atomic_store(&executor->quit, 1);
+	px_atomic_fetch_add(&executor->generation, 1);
+	px_executor_wake(executor);
+	for (int index = 1; index < executor->num_threads; ++index)
+		px_thread_join(&executor->workers[index].thread);
+
+	for (int index = 0; index < executor->num_threads; ++index)
+	{
+		px_executor_deque_free(&executor->workers[index].deque);
+		px_semaphore_free(&executor->workers[index].wake);
+	}
+	px_free(executor->workers);
+	px_free(executor->pending);
+	executor->num_threads = 0;
+}
+
+static void px_executor_set_spin(px_executor* executor, int spin)
+{
+	assert(executor);
+	px_atomic_store(&executor->spin, (spin > 0) ? spin : 0);
+}
+
+// same result as px_graph_process, same max_block pieces
+static void px_executor_process(px_executor* executor, px_graph* graph, SAMPLE_TYPE** input, SAMPLE_TYPE** output, int num_samples)
+{
+	px_assert(executor, graph);
+	px_assert(graph, input, output);
+	assert(graph->compiled);
+	PX_PROFILE_BEGIN("px_executor", executor);
+	px_fp_mode mode = px_denormals_disable();
+
+	const int num_steps = graph->num_nodes;
+	executor->graph = graph;
+	graph->input = input;
+	graph->output = output;
+
+	for (int offset = 0; offset < num_samples; offset += graph->max_block)
+	{
+		graph->offset = offset;
+		graph->block = (num_samples - offset < graph->max_block) ? num_samples - offset : graph->max_block;
+
+		// the previous block is done, nobody touches the counters
+		for (int step = 0; step < num_steps; ++step)
+			px_atomic_store_relaxed(&executor->pending[step], graph->steps[step].num_dependencies);
+		px_atomic_store(&executor->remaining, num_steps);
+
+		for (int step = 0; step < num_steps; ++step)
+			if (graph->steps[step].num_dependencies == 0)
+				px_executor_deque_push(&executor->workers[0].deque, step);
+
+		px_atomic_fetch_add(&executor->generation, 1);
+		px_executor_wake(executor);
+
+		px_executor_run(executor, 0);
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// work until the block's last step is done: own queue first, then steal
+static void px_executor_run(px_executor* executor, int index)
+{
+	px_executor_worker* workers = executor->workers;
+	const int num_threads = executor->num_threads;
+
+	while (px_atomic_load(&executor->remaining) > 0)
+	{
+		int step = px_executor_deque_pop(&workers[index].deque);
+		for (int victim = 1; step < 0 && victim < num_threads; ++victim)
+			step = px_executor_deque_steal(&workers[(index + victim) % num_threads].deque);
+
+		if (step < 0)
+		{
+			px_pause();
+			continue;
+		}
+
+		// a step hands its last ready successor to itself, the rest go on the queue
+		px_graph* graph = executor->graph;
+		while (step >= 0)
+		{
+			px_graph_run_step(graph, step);
+
+			const px_graph_step* done = &graph->steps[step];
+			int next = -1;
+			for (int successor = done->first_successor; successor < done->first_successor + done->num_successors; ++successor)
+			{
+				const int later = graph->successors[successor];
+				if (px_atomic_fetch_add(&executor->pending[later], -1) == 1)
+				{
+					if (next >= 0)
+						px_executor_deque_push(&workers[index].deque, next);
+					next = later;
+				}
+			}
+			px_atomic_fetch_add(&executor->remaining, -1);
+			step = next;
+		}
+	}
+}
+
+static void px_executor_worker_main(void* argument)
+{
+	px_executor_worker* worker = (px_executor_worker*)argument;
+	px_executor* executor = worker->executor;
+
+	// pool threads only ever run graph steps, the mode stays set for their lifetime
+	px_denormals_disable();
+	px_profile_thread_begin();
+
+	// from the initial generation, not the current one: a thread that starts late still sees the
+	// bumps it missed, quit included
+	int seen = 0;
+	while (px_executor_wait(executor, worker, &seen))
+		px_executor_run(executor, worker->index);
+}
+
+// spin, then park until the generation moves. false = quit
+static bool px_executor_wait(px_executor* executor, px_executor_worker* worker, int* seen)
+{
+	const int max_spin = px_atomic_load_relaxed(&executor->spin);
+	int spin = 0;
+	while (px_atomic_load(&executor->generation) == *seen)
+	{
+		if (spin++ < max_spin)
+		{
+			px_pause();
+			continue;
+		}
+
+		// park, then check again: the generation may have moved before the flag was seen
+		px_atomic_store(&worker->parked, 1);
+		px_atomic_fence();
+		if (px_atomic_load(&executor->generation) == *seen || px_atomic_exchange(&worker->parked, 0) == 0)
+			px_semaphore_wait(&worker->wake);	// woken, or a post is on its way
+		spin = 0;
+	}
+
+	*seen = px_atomic_load(&executor->generation);
+	return px_atomic_load(&executor->quit) == 0;
+}
+
+static void px_executor_wake(px_executor* executor)
+{
+	px_atomic_fence();
+	for (int index = 1; index < executor->num_threads; ++index)
+		if (px_atomic_exchange(&executor->workers[index].parked, 0) == 1)
+			px_semaphore_post(&executor->workers[index].wake);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// chase-lev, with the c11 orderings from le, pop, cohen, zappa nardelli (ppopp 2013). the indices
+// only grow, 64 bits never wrap
+
+static void px_executor_deque_initialize(px_executor_deque* deque, int capacity)
+{
+	deque->items = (px_atomic_int*)px_malloc(sizeof(px_atomic_int) * capacity);
+	deque->mask = capacity - 1;
+	for (int i = 0; i < capacity; ++i)
+		px_atomic_init(&deque->items[i], -1);
+	px_atomic_init(&deque->top, 0);
+	px_atomic_init(&deque->bottom, 0);
+}
+
+static void px_executor_deque_free(px_executor_deque* deque)
+{
+	px_free(deque->items);
+}
+
+static void px_executor_deque_push(px_executor_deque* deque, int item)
+{
+	const long long bottom = px_atomic_load_relaxed(&deque->bottom);
+	px_atomic_store_relaxed(&deque->items[bottom & deque->mask], item);
+	px_atomic_store(&deque->bottom, bottom + 1);	// release, publishes the item
+}
+
+static int px_executor_deque_pop(px_executor_deque* deque)
+{
+	const long long bottom = px_atomic_load_relaxed(&deque->bottom) - 1;
+	px_atomic_store_relaxed(&deque->bottom, bottom);
+	px_atomic_fence();
+	long long top = px_atomic_load_relaxed(&deque->top);
+
+	if (top > bottom)
+	{
+		px_atomic_store_relaxed(&deque->bottom, bottom + 1);
+		return -1;
+	}
+
+	int item = px_atomic_load_relaxed(&deque->items[bottom & deque->mask]);
+	if (top == bottom)
+	{
+		// last one, race the thieves for it
+		if (!px_atomic_compare_exchange(&deque->top, &top, top + 1))
+			item = -1;
+		px_atomic_store_relaxed(&deque->bottom, bottom + 1);
+	}
+	return item;
+}
+
+static int px_executor_deque_steal(px_executor_deque* deque)
+{
+	long long top = px_atomic_load(&deque->top);
+	px_atomic_fence();
+	const long long bottom = px_atomic_load(&deque->bottom);
+
+	if (top >= bottom)
+		return -1;
+
+	const int item = px_atomic_load_relaxed(&deque->items[top & deque->mask]);
+	if (!px_atomic_compare_exchange(&deque->top, &top, top + 1))
+		return -1;
+	return item;
+}
+
+#endif
@@ -0,0 +1,616 @@
+#include "px_globals.h"
+#include "px_biquad.h"
+#include "px_profile.h"
+
+#ifndef PX_FILTER_DESIGN_H
+#define PX_FILTER_DESIGN_H
+
+/*
+	px_filter_design.h
+
+	higher-order low- and high-pass design, output is a cascade of second-order sections (sos)
+	in the px_biquad_coefficients order (a = feedforward, b = feedback) that runs as one block call
+
+	families and what frequency means:
+
+		FILTER_BUTTERWORTH       -3 dB point
+		FILTER_LINKWITZ_RILEY    -6 dB point, two butterworths of half the order, order must be even
+		FILTER_CHEBYSHEV_1       passband edge, passband_ripple dB of equiripple below it
+		FILTER_CHEBYSHEV_2       stopband edge, at least stopband_attenuation dB above it
+		FILTER_ELLIPTIC          passband edge, passband_ripple and stopband_attenuation both apply
+
+	use:
+
+		px_filter_specification specification = PX_FILTER_SPECIFICATION(FILTER_LINKWITZ_RILEY, BIQUAD_LOWPASS, 8, sample_rate, 250.f);
+		px_sos_cascade crossover;
+		px_filter_design(specification, &crossover);
+
+		px_sos_cascade_process_block(&crossover, buffer, num_samples);
+
+	the design runs in double: analog prototype -> bilinear transform (prewarped at frequency) ->
+	pole pairs matched with their nearest zeros, sections ordered from the lowest to the highest Q so the
+	resonant sections sit at the end of the chain. every section has unity gain at DC (low-pass) or
+	nyquist (high-pass), the passband ripple of even-order chebyshev 1 / elliptic goes into the first one.
+
+	elliptic design follows Orfanidis, "Lecture Notes on Elliptic Filter Design" (landen transformations).
+	design allocates nothing and can be called from a non-audio thread into a spare cascade.
+*/
+
+#define PX_FILTER_MAX_ORDER 32
+#define PX_SOS_MAX_SECTIONS (PX_FILTER_MAX_ORDER / 2)
+#define PX_SOS_STRIDE 5		// a0 a1 a2 b1 b2
+
+typedef enum
+{
+	FILTER_BUTTERWORTH,
+	FILTER_LINKWITZ_RILEY,
+	FILTER_CHEBYSHEV_1,
+	FILTER_CHEBYSHEV_2,
+	FILTER_ELLIPTIC
+} FILTER_FAMILY;
+
+typedef struct
+{
+	FILTER_FAMILY family;
+	BIQUAD_FILTER_TYPE type;	// BIQUAD_LOWPASS or BIQUAD_HIGHPASS
+	int order;
+	float sample_rate;
+	float frequency;
+	float passband_ripple;		// dB, chebyshev 1 and elliptic
+	float stopband_attenuation;	// dB, chebyshev 2 and elliptic
+} px_filter_specification;
+
+#define PX_FILTER_SPECIFICATION(family, type, order, sample_rate, frequency) { family, type, order, sample_rate, frequency, 1.f, 60.f }
+
+// packed sections, sos[i * PX_SOS_STRIDE + 0..4] = a0 a1 a2 b1 b2
+typedef struct
+{
+	int num_sections;
+	SAMPLE_TYPE sos[PX_SOS_MAX_SECTIONS * PX_SOS_STRIDE];
+	SAMPLE_TYPE state[PX_SOS_MAX_SECTIONS * 2];		// z1 z2 per section
+} px_sos_cascade;
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_filter_design(const px_filter_specification specification, px_sos_cascade* cascade);
+
+static void px_sos_cascade_reset(px_sos_cascade* cascade);
+static void px_sos_cascade_process(px_sos_cascade* cascade, SAMPLE_TYPE* input);
+static void px_sos_cascade_process_block(px_sos_cascade* cascade, SAMPLE_TYPE* input, int num_samples);
+
+// ----------------------------------------------------------------------------------------------------
+// design internals, double precision complex arithmetic
+
+typedef struct
+{
+	double re;
+	double im;
+} px_complex;
+
+// one entry per conjugate pair (im > 0) or per real root (im == 0)
+typedef struct
+{
+	int num_poles;
+	int num_zeros;
+	px_complex poles[PX_FILTER_MAX_ORDER];
+	px_complex zeros[PX_FILTER_MAX_ORDER];
+} px_filter_roots;
+
+#define PX_LANDEN_STEPS 8
+
+static void px_filter_butterworth(px_filter_roots* roots, int order);
+static void px_filter_chebyshev_1(px_filter_roots* roots, int order, double ripple);
+static void px_filter_chebyshev_2(px_filter_roots* roots, int order, double attenuation);
+static void px_filter_elliptic(px_filter_roots* roots, int order, double ripple, double attenuation);
+static void px_filter_bilinear(px_filter_roots* roots, int order, bool highpass, double warped);
+static void px_filter_pair_sections(px_filter_roots* roots, px_sos_cascade* cascade);
+static void px_filter_normalize_sections(px_sos_cascade* cascade, double reference, double passband_gain);
+
+static inline px_complex px_complex_make(double re, double im);
+static inline px_complex px_complex_add(px_complex a, px_complex b);
+static inline px_complex px_complex_sub(px_complex a, px_complex b);
+static inline px_complex px_complex_mul(px_complex a, px_complex b);
+static inline px_complex px_complex_div(px_complex a, px_complex b);
+static inline px_complex px_complex_sqrt(px_complex a);
+static inline double px_complex_abs(px_complex a);
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_filter_design(const px_filter_specification specification, px_sos_cascade* cascade)
+{
+	assert(cascade);
+	assert(specification.order >= 1 && specification.order <= PX_FILTER_MAX_ORDER);
+	assert(specification.frequency > 0.f && specification.frequency < 0.5f * specification.sample_rate);
+
+	cascade->num_sections = 0;
+	px_sos_cascade_reset(cascade);
+
+	if (specification.type != BIQUAD_LOWPASS && specification.type != BIQUAD_HIGHPASS)
+	{
+		printf("Invalid filter type, only BIQUAD_LOWPASS and BIQUAD_HIGHPASS");
+		return;
+	}
+
+	int order = specification.order;
+	double ripple = specification.passband_ripple;
+	double passband_gain = 1.0;
+
+	px_filter_roots roots;
+	roots.num_poles = 0;
+	roots.num_zeros = 0;
+
+	switch (specification.family)
+	{
+	case FILTER_BUTTERWORTH:
+		px_filter_butterworth(&roots, order);
+		break;
+
+	case FILTER_LINKWITZ_RILEY:
+		assert(order % 2 == 0);
+		px_filter_butterworth(&roots, order / 2);
+		px_filter_butterworth(&roots, order / 2);
+		break;
+
+	case FILTER_CHEBYSHEV_1:
+		px_filter_chebyshev_1(&roots, order, ripple);
+		if (order % 2 == 0)
+			passband_gain = pow(10.0, -ripple / 20.0);
+		break;
+
+	case FILTER_CHEBYSHEV_2:
+		px_filter_chebyshev_2(&roots, order, specification.stopband_attenuation);
+		break;
+
+	case FILTER_ELLIPTIC:
+		px_filter_elliptic(&roots, order, ripple, specification.stopband_attenuation);
+		if (order % 2 == 0)
+			passband_gain = pow(10.0, -ripple / 20.0);
+		break;
+
+	default:
+		printf("Invalid filter family");
+		return;
+	}
+
+	bool highpass = specification.type == BIQUAD_HIGHPASS;
+	px_filter_bilinear(&roots, order, highpass, tan(PI * (double)specification.frequency / (double)specification.sample_rate));
+	px_filter_pair_sections(&roots, cascade);
+	px_filter_normalize_sections(cascade, highpass ? -1.0 : 1.0, passband_gain);
+}
+
+static void px_sos_cascade_reset(px_sos_cascade* cascade)
+{
+	assert(cascade);
+	for (int i = 0; i < PX_SOS_MAX_SECTIONS * 2; ++i)
+		cascade->state[i] = 0.f;
+}
+
+static void px_sos_cascade_process(px_sos_cascade* cascade, SAMPLE_TYPE* input)
+{
+	px_assert(cascade, input);
+	SAMPLE_TYPE x = *input;
+	for (int s = 0; s < cascade->num_sections; ++s)
+	{
+		const SAMPLE_TYPE* c = cascade->sos + s * PX_SOS_STRIDE;
+		SAMPLE_TYPE* z = cascade->state + s * 2;
+
+		SAMPLE_TYPE out = x * c[0] + z[0];
+		z[0] = x * c[1] + z[1] - c[3] * out;
+		z[1] = x * c[2] - c[4] * out;
+		x = out;
+	}
+	*input = x;
+}
+
+// section by section over the whole block: each section's coefficients and state stay in
+// registers for num_samples iterations and the block stays in L1 between sections
+static void px_sos_cascade_process_block(px_sos_cascade* cascade, SAMPLE_TYPE* input, int num_samples)
+{
+	px_assert(cascade, input);
+	PX_PROFILE_BEGIN("px_sos_cascade", cascade);
+	px_fp_mode mode = px_denormals_disable();
+	for (int s = 0; s < cascade->num_sections; ++s)
+	{
+		const SAMPLE_TYPE* c = cascade->sos + s * PX_SOS_STRIDE;
+		const SAMPLE_TYPE a0 = c[0], a1 = c[1], a2 = c[2], b1 = c[3], b2 = c[4];
+		SAMPLE_TYPE z1 = cascade->state[s * 2];
+		SAMPLE_TYPE z2 = cascade->state[s * 2 + 1];
+
+		for (int i = 0; i < num_samples; ++i)
+		{
+			SAMPLE_TYPE in = input[i];
+			SAMPLE_TYPE out = in * a0 + z1;
+			z1 = in * a1 + z2 - b1 * out;
+			z2 = in * a2 - b2 * out;
+			input[i] = out;
+		}
+		cascade->state[s * 2] = px_flush_denormal(z1);
+		cascade->state[s * 2 + 1] = px_flush_denormal(z2);
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// analog prototypes, normalized to 1 rad/s
+
+static void px_filter_butterworth(px_filter_roots* roots, int order)
+{
+	for (int k = 0; k < order / 2; ++k)
+	{
+		double theta = PI * (2.0 * k + 1.0) / (2.0 * order);
+		roots->poles[roots->num_poles++] = px_complex_make(-sin(theta), cos(theta));
+	}
+	if (order % 2)
+		roots->poles[roots->num_poles++] = px_complex_make(-1.0, 0.0);
+}
+
+static void px_filter_chebyshev_1(px_filter_roots* roots, int order, double ripple)
+{
+	double epsilon = sqrt(pow(10.0, ripple / 10.0) - 1.0);
+	double mu = asinh(1.0 / epsilon) / order;
+
+	for (int k = 0; k < order / 2; ++k)
+	{
+		double theta = PI * (2.0 * k + 1.0) / (2.0 * order);
+		roots->poles[roots->num_poles++] = px_complex_make(-sinh(mu) * sin(theta), cosh(mu) * cos(theta));
+	}
+	if (order % 2)
+		roots->poles[roots->num_poles++] = px_complex_make(-sinh(mu), 0.0);
+}
+
+// inverse chebyshev: reciprocal poles, zeros on the imaginary axis, stopband edge at 1 rad/s
+static void px_filter_chebyshev_2(px_filter_roots* roots, int order, double attenuation)
+{
+	double epsilon = 1.0 / sqrt(pow(10.0, attenuation / 10.0) - 1.0);
+	double mu = asinh(1.0 / epsilon) / order;
+	px_complex one = px_complex_make(1.0, 0.0);
+
+	for (int k = 0; k < order / 2; ++k)
+	{
+		double theta = PI * (2.0 * k + 1.0) / (2.0 * order);
+		px_complex pole = px_complex_make(-sinh(mu) * sin(theta), cosh(mu) * cos(theta));
+		pole = px_complex_div(one, pole);
+		roots->poles[roots->num_poles++] = px_complex_make(pole.re, fabs(pole.im));
+		roots->zeros[roots->num_zeros++] = px_complex_make(0.0, 1.0 / cos(theta));
+	}
+	if (order % 2)
+		roots->poles[roots->num_poles++] = px_complex_make(-1.0 / sinh(mu), 0.0);
+}
+
+// descending landen moduli of k
+static int px_filter_landen(double k, double* moduli)
+{
+	int n = 0;
+	while (n < PX_LANDEN_STEPS && k > 1.0E-15)
+	{
+		k = k / (1.0 + sqrt(1.0 - k * k));
+		k *= k;
+		moduli[n++] = k;
+	}
+	return n;
+}
+
+// cd(u K, k) and sn(u K, k) for complex u, by ascending from the k -> 0 limit
+static px_complex px_filter_elliptic_ascend(px_complex w, double k)
+{
+	double moduli[PX_LANDEN_STEPS];
+	int n = px_filter_landen(k, moduli);
+	px_complex one = px_complex_make(1.0, 0.0);
+
+	for (int i = n - 1; i >= 0; --i)
+	{
+		double v = moduli[i];
+		px_complex numerator = px_complex_mul(px_complex_make(1.0 + v, 0.0), w);
+		px_complex denominator = px_complex_add(one, px_complex_mul(px_complex_make(v, 0.0), px_complex_mul(w, w)));
+		w = px_complex_div(numerator, denominator);
+	}
+	return w;
+}
+
+static px_complex px_filter_cde(px_complex u, double k)
+{
+	// cos(u * PI / 2)
+	double a = u.re * PI / 2.0, b = u.im * PI / 2.0;
+	return px_filter_elliptic_ascend(px_complex_make(cos(a) * cosh(b), -sin(a) * sinh(b)), k);
+}
+
+static px_complex px_filter_sne(px_complex u, double k)
+{
+	// sin(u * PI / 2)
+	double a = u.re * PI / 2.0, b = u.im * PI / 2.0;
+	return px_filter_elliptic_ascend(px_complex_make(sin(a) * cosh(b), cos(a) * sinh(b)), k);
+}
+
+// inverse of sne, u such that sn(u K, k) = w
+static px_complex px_filter_asne(px_complex w, double k)
+{
+	double moduli[PX_LANDEN_STEPS];
+	int n = px_filter_landen(k, moduli);
+	px_complex one = px_complex_make(1.0, 0.0);
+
+	double previous = k;
+	for (int i = 0; i < n; ++i)
+	{
+		px_complex root = px_complex_sqrt(px_complex_sub(one, px_complex_mul(px_complex_mul(w, w), px_complex_make(previous * previous, 0.0))));
+		w = px_complex_div(w, px_complex_add(one, root));
+		w = px_complex_mul(w, px_complex_make(2.0 / (1.0 + moduli[i]), 0.0));
+		previous = moduli[i];
+	}
+
+	// asin(w) = -j log(j w + sqrt(1 - w^2))
+	px_complex root = px_complex_sqrt(px_complex_sub(one, px_complex_mul(w, w)));
+	px_complex argument = px_complex_add(px_complex_make(-w.im, w.re), root);
+	px_complex asin_w = px_complex_make(atan2(argument.im, argument.re), -log(px_complex_abs(argument)));
+	return px_complex_make(asin_w.re * 2.0 / PI, asin_w.im * 2.0 / PI);
+}
+
+static void px_filter_elliptic(px_filter_roots* roots, int order, double ripple, double attenuation)
+{
+	double epsilon_pass = sqrt(pow(10.0, ripple / 10.0) - 1.0);
+	double epsilon_stop = sqrt(pow(10.0, attenuation / 10.0) - 1.0);
+	double k1 = epsilon_pass / epsilon_stop;
+	double k1_complement = sqrt(1.0 - k1 * k1);
+	int half = order / 2;
+
+	// degree equation: selectivity k from order and k1
+	double product = 1.0;
+	for (int i = 1; i <= half; ++i)
+	{
+		double u = (2.0 * i - 1.0) / order;
+		product *= px_filter_sne(px_complex_make(u, 0.0), k1_complement).re;
+	}
+	double k_complement = pow(k1_complement, order) * pow(product, 4.0);
+	double k = sqrt(1.0 - k_complement * k_complement);
+
+	// v0 from the passband ripple, asne(j / epsilon_pass, k1) is imaginary
+	double v0 = px_filter_asne(px_complex_make(0.0, 1.0 / epsilon_pass), k1).im / order;
+
+	for (int i = 1; i <= half; ++i)
+	{
+		double u = (2.0 * i - 1.0) / order;
+		double zeta = px_filter_cde(px_complex_make(u, 0.0), k).re;
+		roots->zeros[roots->num_zeros++] = px_complex_make(0.0, 1.0 / (k * zeta));
+
+		// j * cd((u - j v0) K, k)
+		px_complex cd = px_filter_cde(px_complex_make(u, -v0), k);
+		roots->poles[roots->num_poles++] = px_complex_make(-fabs(cd.im), fabs(cd.re));
+	}
+	if (order % 2)
+	{
+		// j * sn(j v0 K, k)
+		px_complex sn = px_filter_sne(px_complex_make(0.0, v0), k);
+		roots->poles[roots->num_poles++] = px_complex_make(-fabs(sn.im), 0.0);
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// analog -> z with the frequency prewarped into warped = tan(PI f / fs),
+// zeros at infinity land on nyquist (low-pass) or DC (high-pass)
+static void px_filter_bilinear(px_filter_roots* roots, int order, bool highpass, double warped)
+{
+	px_complex one = px_complex_make(1.0, 0.0);
+	px_complex scale = px_complex_make(warped, 0.0);
+
+	for (int i = 0; i < roots->num_poles + roots->num_zeros; ++i)
+	{
+		px_complex* root = (i < roots->num_poles) ? &roots->poles[i] : &roots->zeros[i - roots->num_poles];
+		px_complex s = *root;
+		if (highpass)
+			s = px_complex_div(one, s);
+
+		s = px_complex_mul(s, scale);
+		px_complex z = px_complex_div(px_complex_add(one, s), px_complex_sub(one, s));
+		z.im = fabs(z.im) < 1.0E-12 ? 0.0 : fabs(z.im);
+		*root = z;
+	}
+
+	int num_zeros = 0;
+	for (int i = 0; i < roots->num_zeros; ++i)
+		num_zeros += (roots->zeros[i].im > 0.0) ? 2 : 1;
+
+	for (; num_zeros < order; ++num_zeros)
+		roots->zeros[roots->num_zeros++] = px_complex_make(highpass ? 1.0 : -1.0, 0.0);
+}
+
+// nearest zero for a pole, complex zeros first, returns the index or -1
+static int px_filter_nearest_zero(const px_filter_roots* roots, const bool* used, px_complex pole, bool complex_zero)
+{
+	int nearest = -1;
+	double distance = 0.0;
+	for (int i = 0; i < roots->num_zeros; ++i)
+	{
+		if (used[i] || (roots->zeros[i].im > 0.0) != complex_zero)
+			continue;
+
+		double d = px_complex_abs(px_complex_sub(roots->zeros[i], pole));
+		if (nearest < 0 || d < distance)
+		{
+			nearest = i;
+			distance = d;
+		}
+	}
+	return nearest;
+}
+
+/*
+	pole pairs closest to the unit circle pick their zeros first, so the resonances are
+	damped by the nearest notch. sections are then sorted by pole radius, lowest Q first
+*/
+static void px_filter_pair_sections(px_filter_roots* roots, px_sos_cascade* cascade)
+{
+	bool pole_used[PX_FILTER_MAX_ORDER] = { false };
+	bool zero_used[PX_FILTER_MAX_ORDER] = { false };
+	double radius[PX_SOS_MAX_SECTIONS];
+	int sections = 0;
+
+	while (true)
+	{
+		// most resonant pole left, complex before real
+		int pole = -1;
+		for (int i = 0; i < roots->num_poles; ++i)
+		{
+			if (pole_used[i])
+				continue;
+			bool complex_i = roots->poles[i].im > 0.0;
+			bool complex_best = pole >= 0 && roots->poles[pole].im > 0.0;
+			if (pole < 0 || (complex_i && !complex_best)
+				|| (complex_i == complex_best && px_complex_abs(roots->poles[i]) > px_complex_abs(roots->poles[pole])))
+				pole = i;
+		}
+		if (pole < 0)
+			break;
+		pole_used[pole] = true;
+
+		px_complex p = roots->poles[pole];
+		double a1, a2, b1, b2;
+
+		if (p.im > 0.0)
+		{
+			b1 = -2.0 * p.re;
+			b2 = p.re * p.re + p.im * p.im;
+		}
+		else
+		{
+			// second real pole if there is one, otherwise a first-order section
+			int partner = -1;
+			for (int i = 0; i < roots->num_poles && partner < 0; ++i)
+				if (!pole_used[i] && roots->poles[i].im == 0.0)
+					partner = i;
+
+			if (partner >= 0)
+			{
+				pole_used[partner] = true;
+				b1 = -(p.re + roots->poles[partner].re);
+				b2 = p.re * roots->poles[partner].re;
+			}
+			else
+			{
+				b1 = -p.re;
+				b2 = 0.0;
+			}
+		}
+
+		int zero = px_filter_nearest_zero(roots, zero_used, p, true);
+		if (zero >= 0 && b2 != 0.0)
+		{
+			zero_used[zero] = true;
+			px_complex z = roots->zeros[zero];
+			a1 = -2.0 * z.re;
+			a2 = z.re * z.re + z.im * z.im;
+		}
+		else
+		{
+			zero = px_filter_nearest_zero(roots, zero_used, p, false);
+			assert(zero >= 0);
+			zero_used[zero] = true;
+			double first = roots->zeros[zero].re;
+
+			if (b2 != 0.0)
+			{
+				int second = px_filter_nearest_zero(roots, zero_used, p, false);
+				assert(second >= 0);
+				zero_used[second] = true;
+				a1 = -(first + roots->zeros[second].re);
+				a2 = first * roots->zeros[second].re;
+			}
+			else
+			{
+				a1 = -first;
+				a2 = 0.0;
+			}
+		}
+
+		SAMPLE_TYPE* c = cascade->sos + sections * PX_SOS_STRIDE;
+		c[0] = 1.f;
+		c[1] = (SAMPLE_TYPE)a1;
+		c[2] = (SAMPLE_TYPE)a2;
+		c[3] = (SAMPLE_TYPE)b1;
+		c[4] = (SAMPLE_TYPE)b2;
+		radius[sections] = sqrt(fabs(b2)) + (b2 == 0.0 ? -1.0 : 0.0);	// first-order sections go first
+		++sections;
+	}
+
+	// insertion sort by radius, at most 16 sections
+	for (int i = 1; i < sections; ++i)
+	{
+		for (int j = i; j > 0 && radius[j] < radius[j - 1]; --j)
+		{
+			double r = radius[j];
+			radius[j] = radius[j - 1];
+			radius[j - 1] = r;
+
+			for (int n = 0; n < PX_SOS_STRIDE; ++n)
+			{
+				SAMPLE_TYPE t = cascade->sos[j * PX_SOS_STRIDE + n];
+				cascade->sos[j * PX_SOS_STRIDE + n] = cascade->sos[(j - 1) * PX_SOS_STRIDE + n];
+				cascade->sos[(j - 1) * PX_SOS_STRIDE + n] = t;
+			}
+		}
+	}
+	cascade->num_sections = sections;
+}
+
+// unity gain per section at z = reference (1 DC, -1 nyquist), passband_gain on the first
+static void px_filter_normalize_sections(px_sos_cascade* cascade, double reference, double passband_gain)
+{
+	for (int s = 0; s < cascade->num_sections; ++s)
+	{
+		SAMPLE_TYPE* c = cascade->sos + s * PX_SOS_STRIDE;
+		double numerator = (double)c[0] + (double)c[1] * reference + (double)c[2];
+		double denominator = 1.0 + (double)c[3] * reference + (double)c[4];
+
+		double gain = (fabs(numerator) > 1.0E-30) ? denominator / numerator : 1.0;
+		if (s == 0)
+			gain *= passband_gain;
+
+		c[0] = (SAMPLE_TYPE)(c[0] * gain);
+		c[1] = (SAMPLE_TYPE)(c[1] * gain);
+		c[2] = (SAMPLE_TYPE)(c[2] * gain);
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static inline px_complex px_complex_make(double re, double im)
+{
+	px_complex c = { re, im };
+	return c;
+}
+
+static inline px_complex px_complex_add(px_complex a, px_complex b)
+{
+	return px_complex_make(a.re + b.re, a.im + b.im);
+}
+
+static inline px_complex px_complex_sub(px_complex a, px_complex b)
+{
+	return px_complex_make(a.re - b.re, a.im - b.im);
+}
+
+static inline px_complex px_complex_mul(px_complex a, px_complex b)
+{
+	return px_complex_make(a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re);
+}
+
+static inline px_complex px_complex_div(px_complex a, px_complex b)
+{
+	double d = b.re * b.re + b.im * b.im;
+	return px_complex_make((a.re * b.re + a.im * b.im) / d, (a.im * b.re - a.re * b.im) / d);
+}
+
+static inline px_complex px_complex_sqrt(px_complex a)
+{
+	double r = px_complex_abs(a);
+	double re = sqrt(0.5 * (r + a.re));
+	double im = sqrt(0.5 * (r - a.re));
+	return px_complex_make(re, (a.im < 0.0) ? -im : im);
+}
+
+static inline double px_complex_abs(px_complex a)
+{
+	return hypot(a.re, a.im);
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include "px_globals.h"
+#include "px_simd.h"
+
+#ifndef PX_GAIN_CURVE_H
+#define PX_GAIN_CURVE_H
+
+/*
+	px_gain_curve.h
+
+	static transfer curve of a compressor / expander, tabulated as linear gain over the detector level
+	in dB relative to the threshold. a lookup is a clamp, a truncation and one interpolation, no branches,
+	divides or dB2lin. the table is rebuilt only when the curve changes.
+
+	the curve is piecewise linear in dB: segments start at breakpoints (dB over threshold) and hold a ratio
+	until the next one, below the first breakpoint below_ratio applies. ratio > 1 compresses, < 1 expands,
+	so the same table covers downward / upward compression and expansion. every breakpoint gets the same
+	soft knee (quadratic in dB, knee_width wide and centred on the breakpoint). the hard-knee curve passes
+	through 0 dB of gain at the threshold.
+
+		compressor 4:1                { { 0, 4 } }, below_ratio 1
+		expander 1:2 under -30 dB     { { -30, 1 } }, below_ratio 0.5
+		both, then limiting at +12    { { -30, 1 }, { 0, 4 }, { 12, 20 } }, below_ratio 0.5
+
+	the table starts at floor: the lowest level that still changes the gain (first knee start), or
+	PX_GAIN_CURVE_BELOW dB under it when below_ratio isn't 1. callers clamp the envelope to floor so
+	attack starts from there rather than from silence. the table spans PX_GAIN_CURVE_RANGE dB from floor
+	and holds its last gain above that.
+
+	init:
+		px_gain_curve curve;
+		px_gain_segment segments[] = { { 0.f, 4.f } };
+		px_gain_curve_set(&curve, segments, 1, 1.f, 6.f);	// 6 dB knee
+
+	use:
+		SAMPLE_TYPE gain = px_gain_curve_lookup(&curve, over_dB);
+		px_gain_curve_lookup_block(&curve, over_dB, gains, num_samples);
+*/
+
+#define PX_GAIN_CURVE_SIZE 512
+#define PX_GAIN_CURVE_RANGE 144.f		// dB
+#define PX_GAIN_CURVE_BELOW 60.f		// dB tracked under the first breakpoint when below_ratio != 1
+#define PX_GAIN_CURVE_MAX_SEGMENTS 8
+
+typedef struct
+{
+	float start;	// dB over threshold
+	float ratio;	// dB in per dB out above start
+} px_gain_segment;
+
+typedef struct
+{
+	px_gain_segment segments[PX_GAIN_CURVE_MAX_SEGMENTS];
+	int num_segments;
+	float below_ratio;
+	float knee_width;	// dB
+
+	float floor;		// dB over threshold at table[0]
+	float scale;		// table steps per dB
+	SAMPLE_TYPE table[PX_GAIN_CURVE_SIZE];	// linear gain
+} px_gain_curve;
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_gain_curve_set(px_gain_curve* curve, const px_gain_segment* segments, int num_segments, float below_ratio, float knee_width);
+static void px_gain_curve_set_knee(px_gain_curve* curve, float knee_width);
+static float px_gain_curve_evaluate(const px_gain_curve* curve, float over);	// dB of gain, exact
+
+static inline SAMPLE_TYPE px_gain_curve_lookup(const px_gain_curve* curve, SAMPLE_TYPE over);
+static void px_gain_curve_lookup_block(const px_gain_curve* curve, const SAMPLE_TYPE* over, SAMPLE_TYPE* gain, int num_samples);
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_gain_curve_build(px_gain_curve* curve);
+static inline float px_gain_curve_ramp(float distance, float knee_width);
+static inline SAMPLE_TYPE px_gain_curve_interpolate(const px_gain_curve* curve, SAMPLE_TYPE position);
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_gain_curve_set(px_gain_curve* curve, const px_gain_segment* segments, int num_segments, float below_ratio, float knee_width)
+{
+	assert(curve);
+	assert(segments || num_segments == 0);
+
+	bool valid = num_segments >= 0 && num_segments <= PX_GAIN_CURVE_MAX_SEGMENTS && below_ratio > 0.f;
+	for (int i = 0; valid && i < num_segments; ++i)
+		valid = segments[i].ratio > 0.f && (i == 0 || segments[i].start > segments[i - 1].start);
+
+	if (!valid)
+	{
+		printf("Invalid gain curve");
+		return;
+	}
+
+	memcpy(curve->segments, segments, sizeof(px_gain_segment) * num_segments);
+	curve->num_segments = num_segments;
+	curve->below_ratio = below_ratio;
+	curve->knee_width = px_fmax(knee_width, 0.f);
+	px_gain_curve_build(curve);
+}
+
+static void px_gain_curve_set_knee(px_gain_curve* curve, float knee_width)
+{
+	assert(curve);
+	curve->knee_width = px_fmax(knee_width, 0.f);
+	px_gain_curve_build(curve);
+}
+
+// sum of the slope changes at each breakpoint, each smoothed by the knee, minus the hard-knee gain
+// at the threshold so the threshold stays at 0 dB
+static float px_gain_curve_evaluate(const px_gain_curve* curve, float over)
+{
+	float slope = 1.f / curve->below_ratio - 1.f;	// dB of gain per dB in
+	float gain = slope * over;
+	float anchor = 0.f;
+
+	for (int i = 0; i < curve->num_segments; ++i)
+	{
+		float next = 1.f / curve->segments[i].ratio - 1.f;
+		gain += (next - slope) * px_gain_curve_ramp(over - curve->segments[i].start, curve->knee_width);
+		anchor += (next - slope) * px_gain_curve_ramp(-curve->segments[i].start, 0.f);
+		slope = next;
+	}
+	return gain - anchor;
+}
+
+static inline SAMPLE_TYPE px_gain_curve_lookup(const px_gain_curve* curve, SAMPLE_TYPE over)
+{
+	SAMPLE_TYPE position = (over - curve->floor) * curve->scale;
+	position = px_fmin(px_fmax(position, 0.f), (SAMPLE_TYPE)(PX_GAIN_CURVE_SIZE - 1));
+	return px_gain_curve_interpolate(curve, position);
+}
+
+// table positions in px_simd, the table reads stay scalar (px_simd has no gather)
+static void px_gain_curve_lookup_block(const px_gain_curve* curve, const SAMPLE_TYPE* over, SAMPLE_TYPE* gain, int num_samples)
+{
+	px_assert(curve, over, gain);
+
+	const px_simd lowest = px_simd_set1(curve->floor);
+	const px_simd scale = px_simd_set1(curve->scale);
+	const px_simd zero = px_simd_set1(0.f);
+	const px_simd last = px_simd_set1((SAMPLE_TYPE)(PX_GAIN_CURVE_SIZE - 1));
+
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+	{
+		px_simd position = px_simd_mul(px_simd_sub(px_simd_load(over + i), lowest), scale);
+		px_simd_store(gain + i, px_simd_min(px_simd_max(position, zero), last));
+	}
+	for (; i < num_samples; ++i)
+		gain[i] = px_fmin(px_fmax((over[i] - curve->floor) * curve->scale, 0.f), (SAMPLE_TYPE)(PX_GAIN_CURVE_SIZE - 1));
+
+	for (i = 0; i < num_samples; ++i)
+		gain[i] = px_gain_curve_interpolate(curve, gain[i]);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_gain_curve_build(px_gain_curve* curve)
+{
+	float lowest = 0.f;
+	if (curve->num_segments > 0)
+	{
+		lowest = curve->segments[0].start - 0.5f * curve->knee_width;
+		if (curve->below_ratio != 1.f)
+			lowest -= PX_GAIN_CURVE_BELOW;
+	}
+	else if (curve->below_ratio != 1.f)
+		lowest = -PX_GAIN_CURVE_BELOW;
+
+	curve->floor = lowest;
+	curve->scale = (float)(PX_GAIN_CURVE_SIZE - 1) / PX_GAIN_CURVE_RANGE;
+
+	const float step = PX_GAIN_CURVE_RANGE / (float)(PX_GAIN_CURVE_SIZE - 1);
+	for (int i = 0; i < PX_GAIN_CURVE_SIZE; ++i)
+		curve->table[i] = dB2lin(px_gain_curve_evaluate(curve, lowest + step * i));
+}
+
+// integral of a unit slope step at 0 smoothed over knee_width: 0 below, quadratic through the knee, linear above
+static inline float px_gain_curve_ramp(float distance, float knee_width)
+{
+	float half = 0.5f * knee_width;
+	if (distance <= -half)
+		return 0.f;
+	if (distance >= half)
+		return distance;
+	return (distance + half) * (distance + half) / (2.f * knee_width);
+}
+
+static inline SAMPLE_TYPE px_gain_curve_interpolate(const px_gain_curve* curve, SAMPLE_TYPE position)
+{
+	int index = (int)position;
+	index = (index < PX_GAIN_CURVE_SIZE - 2) ? index : PX_GAIN_CURVE_SIZE - 2;
+	SAMPLE_TYPE fraction = position - (SAMPLE_TYPE)index;
+	return curve->table[index] + fraction * (curve->table[index + 1] - curve->table[index]);
+}
+
+#endif
@@ -6,6 +6,45 @@
 #include <string.h>
 #include <stdio.h>
 
+#ifdef __cplusplus
+#include <atomic>
+#else
+#include <stdatomic.h>
+#endif
+
+// px_pause
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if !defined(PX_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <immintrin.h>
+#elif !defined(PX_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#endif
+
+// MXCSR access for the denormal guard, scalar x86 code runs on SSE too
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#endif
+
+// timestamps for px_profile, only profiling builds pull in windows.h here
+#ifdef PX_PROFILE
+#include <time.h>
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#endif
+#if !defined(_MSC_VER) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+#endif
+
 
 
 #ifndef PX_GLOBALS_H
@@ -17,6 +56,33 @@
 #define PI 3.141592653589793
 #define sgn(val) ((0 < val) - (val < 0))
 // ---------------------------------
+// Sample Type
+//
+// processors run on SAMPLE_TYPE, define PX_DOUBLE_BUFFER before including for double precision
+// (same flag as px_buffer). control values (dB, Hz, ms) stay float either way
+
+#ifdef PX_DOUBLE_BUFFER
+	typedef double SAMPLE_TYPE;
+	#define px_fabs fabs
+	#define px_sqrt sqrt
+	#define px_fmin fmin
+	#define px_fmax fmax
+	#define px_copysign copysign
+	#define px_floor floor
+	#define px_atan atan
+	#define px_tanh tanh
+#else
+	typedef float SAMPLE_TYPE;
+	#define px_fabs fabsf
+	#define px_sqrt sqrtf
+	#define px_fmin fminf
+	#define px_fmax fmaxf
+	#define px_copysign copysignf
+	#define px_floor floorf
+	#define px_atan atanf
+	#define px_tanh tanhf
+#endif
+// ---------------------------------
 // Gain
 
 // linear -> dB conversion
@@ -48,22 +114,22 @@ static inline float dB2lin(float dB) {
 
 typedef struct
 {
-    float left;
-    float right;
+    SAMPLE_TYPE left;
+    SAMPLE_TYPE right;
 } px_ms_decoded;
 
 typedef struct
 {
-    float mid;
-    float side;
+    SAMPLE_TYPE mid;
+    SAMPLE_TYPE side;
 } px_ms_encoded;
 
 
 static inline px_ms_encoded px_ms_encode(px_ms_decoded decoded)
 {
 	px_ms_encoded encoded;
-	encoded.mid = 0.5f * (decoded.left + decoded.right);
-	encoded.side = 0.5f * (decoded.left - decoded.right);
+	encoded.mid = (SAMPLE_TYPE)0.5 * (decoded.left + decoded.right);
+	encoded.side = (SAMPLE_TYPE)0.5 * (decoded.left - decoded.right);
 	return encoded;
 }
 
@@ -75,26 +141,155 @@ static inline px_ms_decoded px_ms_decode(px_ms_encoded encoded)
 	return decoded;
 }
 
+// Denormals
+//
+// recursive state (biquads, crossovers, feedback delays) decays into the subnormal range after
+// the input goes silent, and subnormal math runs ~100x slower on x86. two lines of defence:
+//
+//	px_denormals_disable / px_denormals_restore
+//		set flush-to-zero and denormals-are-zero for the calling thread (MXCSR FTZ|DAZ on x86,
+//		FPCR.FZ on arm), hand back the previous mode. every block entry point wraps itself in
+//		the pair, nested calls see the mode already set and skip the write. no-op where there
+//		is no such mode (PX_FTZ undefined)
+//
+//		px_fp_mode mode = px_denormals_disable();
+//		...
+//		px_denormals_restore(mode);
+//
+//		px_denormal_scope scope;	// C++, same thing for the enclosing scope
+//
+//	px_flush_denormal
+//		zeroes a state value below PX_DENORMAL_THRESHOLD (~ -300 dB), applied to recursive state
+//		at the end of each block whatever the fp mode, so hosts that reset the mode between
+//		callbacks or targets without one don't stall either
+
+#define PX_DENORMAL_THRESHOLD 1.0E-15
+
+typedef unsigned long long px_fp_mode;
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define PX_FTZ
+	#define PX_FTZ_BITS 0x8040ull	// FTZ (bit 15) | DAZ (bit 6)
+	static inline px_fp_mode px_fp_mode_get(void) { return _mm_getcsr(); }
+	static inline void px_fp_mode_set(px_fp_mode mode) { _mm_setcsr((unsigned int)mode); }
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+	#define PX_FTZ
+	#define PX_FTZ_BITS (1ull << 24)	// FPCR.FZ
+	static inline px_fp_mode px_fp_mode_get(void) { unsigned long long mode; __asm__ __volatile__("mrs %0, fpcr" : "=r"(mode)); return mode; }
+	static inline void px_fp_mode_set(px_fp_mode mode) { __asm__ __volatile__("msr fpcr, %0" : : "r"(mode)); }
+#elif defined(__arm__) && defined(__ARM_FP) && !defined(_MSC_VER)
+	#define PX_FTZ
+	#define PX_FTZ_BITS (1ull << 24)	// FPSCR.FZ
+	static inline px_fp_mode px_fp_mode_get(void) { unsigned int mode; __asm__ __volatile__("vmrs %0, fpscr" : "=r"(mode)); return mode; }
+	static inline void px_fp_mode_set(px_fp_mode mode) { __asm__ __volatile__("vmsr fpscr, %0" : : "r"((unsigned int)mode)); }
+#endif
+
+static inline px_fp_mode px_denormals_disable(void)
+{
+#ifdef PX_FTZ
+	px_fp_mode mode = px_fp_mode_get();
+	if ((mode & PX_FTZ_BITS) != PX_FTZ_BITS)
+		px_fp_mode_set(mode | PX_FTZ_BITS);
+	return mode;
+#else
+	return 0;
+#endif
+}
+
+static inline void px_denormals_restore(px_fp_mode mode)
+{
+#ifdef PX_FTZ
+	if ((mode & PX_FTZ_BITS) != PX_FTZ_BITS)
+		px_fp_mode_set(mode);
+#else
+	(void)mode;
+#endif
+}
+
+static inline SAMPLE_TYPE px_flush_denormal(SAMPLE_TYPE value)
+{
+	return (px_fabs(value) < (SAMPLE_TYPE)PX_DENORMAL_THRESHOLD) ? (SAMPLE_TYPE)0 : value;
+}
+
+#ifdef __cplusplus
+struct px_denormal_scope
+{
+	px_fp_mode mode;
+	px_denormal_scope() : mode(px_denormals_disable()) {}
+	~px_denormal_scope() { px_denormals_restore(mode); }
+	px_denormal_scope(const px_denormal_scope&) = delete;
+	px_denormal_scope& operator=(const px_denormal_scope&) = delete;
+};
+#endif
+
+// Atomics
+//
+// lock-free handoff between the audio thread and readers (px_meter, px_profile) or workers (px_executor),
+// same calls from C11 and C++, for px_atomic_int and px_atomic_int64 alike
+
+#ifdef __cplusplus
+	typedef std::atomic<int> px_atomic_int;
+	typedef std::atomic<long long> px_atomic_int64;
+	#define px_atomic_init(object, value) (object)->store(value, std::memory_order_relaxed)
+	#define px_atomic_load(object) (object)->load(std::memory_order_acquire)
+	#define px_atomic_store(object, value) (object)->store(value, std::memory_order_release)
+	#define px_atomic_exchange(object, value) (object)->exchange(value, std::memory_order_acq_rel)
+	#define px_atomic_fetch_add(object, value) (object)->fetch_add(value, std::memory_order_acq_rel)
+	#define px_atomic_compare_exchange(object, expected, desired) (object)->compare_exchange_strong(*(expected), desired)
+	#define px_atomic_load_relaxed(object) (object)->load(std::memory_order_relaxed)
+	#define px_atomic_store_relaxed(object, value) (object)->store(value, std::memory_order_relaxed)
+	#define px_atomic_fence() std::atomic_thread_fence(std::memory_order_seq_cst)
+	#define px_atomic_fence_release() std::atomic_thread_fence(std::memory_order_release)
+	#define px_atomic_fence_acquire() std::atomic_thread_fence(std::memory_order_acquire)
+#else
+	typedef atomic_int px_atomic_int;
+	typedef atomic_llong px_atomic_int64;
+	#define px_atomic_init(object, value) atomic_init(object, value)
+	#define px_atomic_load(object) atomic_load_explicit(object, memory_order_acquire)
+	#define px_atomic_store(object, value) atomic_store_explicit(object, value, memory_order_release)
+	#define px_atomic_exchange(object, value) atomic_exchange_explicit(object, value, memory_order_acq_rel)
+	#define px_atomic_fetch_add(object, value) atomic_fetch_add_explicit(object, value, memory_order_acq_rel)
+	#define px_atomic_compare_exchange(object, expected, desired) atomic_compare_exchange_strong(object, expected, desired)
+	#define px_atomic_load_relaxed(object) atomic_load_explicit(object, memory_order_relaxed)
+	#define px_atomic_store_relaxed(object, value) atomic_store_explicit(object, value, memory_order_relaxed)
+	#define px_atomic_fence() atomic_thread_fence(memory_order_seq_cst)
+	#define px_atomic_fence_release() atomic_thread_fence(memory_order_release)
+	#define px_atomic_fence_acquire() atomic_thread_fence(memory_order_acquire)
+#endif
+
+// spin-wait hint
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#define px_pause() _mm_pause()
+#elif defined(_MSC_VER)
+	#define px_pause() __yield()
+#elif defined(__i386__) || defined(__x86_64__)
+	#define px_pause() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+	#define px_pause() __asm__ __volatile__("yield")
+#else
+	#define px_pause() ((void)0)
+#endif
+
 // assert for process functions
 // ------------------------------------------------------------------------------------------------------
 
 
 	
-static void px_assert_mono(void* control_pointer, float* value_pointer)
+static void px_assert_mono(const void* control_pointer, const void* value_pointer)
 {
 	// check if DSP object passed is NULL or uninitialized
 	assert(control_pointer);
 
-	// check if value is valid float pointer
+	// check if value is valid sample pointer
 	assert(value_pointer);
 }
 
-static void px_assert_stereo(void* control_pointer, float* channel_one_pointer, float* channel_two_pointer)
+static void px_assert_stereo(const void* control_pointer, const void* channel_one_pointer, const void* channel_two_pointer)
 {
 	// check if DSP object passed is NULL or uninitialized
 	assert(control_pointer);
 
-	// check if value is valid float pointer
+	// check if value is valid sample pointer
 	assert(channel_one_pointer);
 	assert(channel_two_pointer);
 }
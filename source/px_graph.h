@@ -0,0 +1,1239 @@
+#include "px_globals.h"
+#include "px_simd.h"
+#include "px_memory.h"
+#include "px_buffer.h"
+#include "px_equalizer.h"
+#include "px_compressor.h"
+#include "px_saturator.h"
+#include "px_clip.h"
+#include "px_delay.h"
+#include "px_silence.h"
+#include "px_smoother.h"
+#include "px_profile.h"
+#include "px_limiter.h"
+#include "px_multiband.h"
+#include "px_linked.h"
+
+#ifndef PX_GRAPH_H
+#define PX_GRAPH_H
+
+/*
+	px_graph.h
+
+	processing graph: nodes (existing processors, or plain summing buses), connections and
+	sends between them. px_graph_compile() turns it into a block schedule once, then
+	px_graph_process() runs every node over the whole block, one call per node per block and no
+	per-sample dispatch.
+
+	compile
+		nodes are ordered topologically (a cycle fails the compile). node outputs live in channel
+		slots of max_block samples in one arena. a slot goes back to the free list once every
+		node reading it has run, the next node that needs one picks it up, so the arena only
+		holds the channels that are live at the same time, not one buffer per node. a node whose
+		only input is a plain connection from a node nobody else still reads processes that
+		buffer in place, no copy. compile allocates, call it off the audio thread after edits.
+
+		each step also records what has to finish before it: its inputs and, for a recycled
+		slot, every reader of the slot's previous contents. serial processing doesn't need it,
+		px_executor.h does.
+
+	mixing
+		a node's input is the sum of its connections. channel counts may differ: a narrower source
+		repeats across the destination (mono to stereo), a wider one folds down channel n into
+		n % destination channels (stereo to mono sums).
+
+	sends / returns
+		a send is a connection with a gain that can change while processing, a return is a bus:
+		a node with no processor that only sums its inputs. px_graph_set_send_gain hands the gain
+		over through an atomic, the audio side picks it up at the next block and glides to it
+		over PX_GRAPH_SEND_SMOOTHING (px_smoother).
+
+	latency
+		every node carries its processor's latency_samples (custom nodes: px_graph_set_latency).
+		compile lines paths up where they meet: a connection arriving earlier than the slowest
+		input of its destination gets an aligning delay (px_circular_buffer per channel), so
+		parallel paths stay phase-aligned. px_graph_latency_samples() is the total to report to
+		the host. compile asks every processor again, after a change (limiter lookahead) just
+		recompile. custom nodes keep what px_graph_set_latency gave them.
+
+	silence
+		every step flags its output silent when the block is all under PX_SILENCE_THRESHOLD. a node
+		whose inputs are all flagged (or mixed from delays that have run dry) counts the silence
+		against its processor's tail (px_silence.h), asked again on every silent block so eq
+		edits are picked up. past the tail the node isn't called at all and flags its own output,
+		so a silent branch costs one flag test per node. the first skipped block resets the
+		processor (eq bands, delay lines) so nothing left under the threshold plays out later. dynamics have no tail, their envelopes
+		keep releasing on the zeros; custom nodes never skip until px_graph_set_tail.
+
+	init:
+		px_graph graph;
+		px_graph_initialize(&graph, sample_rate, 2, 512);	// stereo in and out, blocks of up to 512 samples
+
+		int eq = px_graph_add_stereo_equalizer(&graph, &equalizer);
+		int comp = px_graph_add_stereo_compressor(&graph, &compressor);
+		int reverb_return = px_graph_add_bus(&graph, 2);
+
+		px_graph_connect(&graph, PX_GRAPH_INPUT, eq);
+		px_graph_connect(&graph, eq, comp);
+		px_graph_connect(&graph, comp, PX_GRAPH_OUTPUT);
+		int send = px_graph_send(&graph, eq, reverb_return, -12.f);	// dB
+		px_graph_connect(&graph, reverb_return, PX_GRAPH_OUTPUT);
+
+		px_graph_compile(&graph);
+		px_graph_free(&graph);
+
+	use:
+		px_graph_process(&graph, inputs, outputs, num_samples);	// SAMPLE_TYPE* [num_channels], any length
+		px_graph_set_send_gain(&graph, send, -6.f);		// from any thread, glides there
+		px_graph_set_tail(&graph, custom, 4800);		// custom node rings 100 ms, then may be skipped
+		int latency = px_graph_latency_samples(&graph);
+
+	custom nodes take px_graph_callback, process(processor, channels, num_channels, num_samples) in place
+*/
+
+#ifndef PX_GRAPH_MAX_NODES
+	#define PX_GRAPH_MAX_NODES 256
+#endif
+#ifndef PX_GRAPH_MAX_CONNECTIONS
+	#define PX_GRAPH_MAX_CONNECTIONS 1024
+#endif
+
+#ifndef PX_GRAPH_SEND_SMOOTHING
+	#define PX_GRAPH_SEND_SMOOTHING 20.f	// ms
+#endif
+
+#define PX_GRAPH_INPUT 0
+#define PX_GRAPH_OUTPUT 1
+#define PX_GRAPH_ALIGN 16	// slot stride rounded to 64 bytes of float
+#define PX_GRAPH_SCRATCH 256	// samples, aligning delays run in pieces this long
+
+typedef void (*px_graph_callback)(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+typedef int (*px_graph_tail_callback)(const void* processor);
+typedef int (*px_graph_latency_callback)(const void* processor);
+typedef void (*px_graph_reset_callback)(void* processor);
+
+typedef struct
+{
+	px_graph_callback process;	// NULL = bus
+	void* processor;
+	int num_channels;
+	px_graph_latency_callback latency_samples;	// asked at compile, NULL = latency below
+	int latency;					// samples
+
+	px_graph_tail_callback tail_samples;	// asked on silent blocks, NULL = tail below
+	int tail;				// samples, PX_TAIL_INFINITE = never skipped
+	px_graph_reset_callback reset;		// first skipped block, NULL = nothing rings
+} px_graph_node;
+
+typedef struct
+{
+	int source;
+	int destination;
+	px_atomic_int gain;	// linear, float bits, px_graph_set_send_gain writes it while processing
+	px_smoother ramp;	// audio side, the gain applied, glides to gain
+	bool send;		// gain can change, never processed in place
+
+	int delay;			// aligning delay, samples
+	px_circular_buffer* lines;	// [source channels] when delay > 0
+} px_graph_connection;
+
+typedef struct
+{
+	int node;
+	bool in_place;				// processes its source's buffer
+	SAMPLE_TYPE* channels[MAX_CHANNELS];	// into the arena
+
+	int first_input;			// into inputs, connection indices
+	int num_inputs;
+	int first_successor;			// into successors, steps waiting on this one
+	int num_successors;
+	int num_dependencies;			// steps this one waits on
+
+	px_silence silence;			// of the inputs, against the node's tail
+	bool silent;				// output all zeros this block, buffers not written when skipped
+	int quiet;				// samples the output has been silent, up to PX_TAIL_MAX
+} px_graph_step;
+
+typedef struct
+{
+	float sample_rate;
+	int num_channels;	// graph input and output
+	int max_block;
+	int stride;		// samples per slot
+
+	px_graph_node* nodes;
+	int num_nodes;
+	px_graph_connection* connections;
+	int num_connections;
+
+	// compiled
+	bool compiled;
+	px_graph_step* steps;
+	int* node_step;
+	int* inputs;
+	int* successors;
+	int num_successors;
+	int num_slots;
+	SAMPLE_TYPE* arena;
+	int latency;		// at the output
+
+	// current block
+	SAMPLE_TYPE** input;
+	SAMPLE_TYPE** output;
+	int offset;
+	int block;
+} px_graph;
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_graph* px_graph_create(float sample_rate, int num_channels, int max_block);
+static void px_graph_destroy(px_graph* graph);
+static void px_graph_initialize(px_graph* graph, float sample_rate, int num_channels, int max_block);
+static void px_graph_free(px_graph* graph);
+
+static int px_graph_add_node(px_graph* graph, px_graph_callback process, void* processor, int num_channels);	// node id, -1 when full
+static int px_graph_add_bus(px_graph* graph, int num_channels);
+static int px_graph_connect(px_graph* graph, int source, int destination);		// connection id, -1 when full
+static int px_graph_send(px_graph* graph, int source, int destination, float gain);	// dB
+static void px_graph_set_send_gain(px_graph* graph, int connection, float gain);	// dB, any thread
+static void px_graph_set_latency(px_graph* graph, int node, int latency);		// samples
+static void px_graph_set_tail(px_graph* graph, int node, int tail);			// samples, PX_TAIL_INFINITE = never skipped
+static int px_graph_latency_samples(const px_graph* graph);				// after compile
+
+static bool px_graph_compile(px_graph* graph);
+static void px_graph_process(px_graph* graph, SAMPLE_TYPE** input, SAMPLE_TYPE** output, int num_samples);
+
+// existing processors
+static int px_graph_add_mono_equalizer(px_graph* graph, px_mono_equalizer* equalizer);
+static int px_graph_add_stereo_equalizer(px_graph* graph, px_stereo_equalizer* equalizer);
+static int px_graph_add_mono_compressor(px_graph* graph, px_mono_compressor* compressor);
+static int px_graph_add_stereo_compressor(px_graph* graph, px_stereo_compressor* compressor);	// linked
+static int px_graph_add_saturator(px_graph* graph, px_saturator* saturator, int num_channels);
+static int px_graph_add_clipper(px_graph* graph, px_clipper* clipper, int num_channels);
+static int px_graph_add_mono_limiter(px_graph* graph, px_mono_limiter* limiter);
+static int px_graph_add_stereo_limiter(px_graph* graph, px_stereo_limiter* limiter);
+static int px_graph_add_mono_multiband(px_graph* graph, px_mono_multiband* multiband);
+static int px_graph_add_stereo_multiband(px_graph* graph, px_stereo_multiband* multiband);
+static int px_graph_add_linked(px_graph* graph, px_linked_compressor* linked);
+static int px_graph_add_mono_delay(px_graph* graph, px_delay_line* delay);
+static int px_graph_add_stereo_delay(px_graph* graph, px_stereo_delay* delay);
+
+// ----------------------------------------------------------------------------------------------------
+
+static int px_graph_add_processor(px_graph* graph, px_graph_callback process, void* processor, int num_channels,
+				  px_graph_latency_callback latency_samples, int latency, px_graph_tail_callback tail_samples, int tail,
+				  px_graph_reset_callback reset);
+static int px_graph_add_connection(px_graph* graph, int source, int destination, float gain, bool send);
+static void px_graph_release(px_graph* graph);
+static void px_graph_align(px_graph* graph, const int* order);
+static void px_graph_run_step(px_graph* graph, int index);
+static bool px_graph_inputs_silent(const px_graph* graph, const px_graph_step* step);
+static bool px_graph_connection_silent(const px_graph* graph, const px_graph_connection* connection);
+static void px_graph_settle(px_graph_step* step, bool silent, int num_samples);
+static void px_graph_mix(px_graph* graph, const px_graph_step* step, SAMPLE_TYPE** channels, int num_channels);
+static void px_graph_mix_ramp(px_graph* graph, px_graph_connection* connection, SAMPLE_TYPE** channels, int num_channels, bool* written);
+static void px_graph_skip_sends(px_graph* graph, const px_graph_step* step, int num_samples);
+static void px_graph_send_update(px_graph_connection* connection);
+static void px_graph_accumulate(SAMPLE_TYPE* destination, const SAMPLE_TYPE* source, SAMPLE_TYPE gain, bool first, int num_samples);
+static void px_graph_accumulate_ramp(SAMPLE_TYPE* destination, const SAMPLE_TYPE* source, const float* gains, bool first, int num_samples);
+static inline int px_graph_gain_bits(float gain);
+static inline float px_graph_bits_gain(int bits);
+static void px_graph_delay(px_circular_buffer* line, const SAMPLE_TYPE* input, SAMPLE_TYPE* output, int num_samples);
+static int px_graph_sort(const px_graph* graph, int* order);
+static void px_graph_depend(bool* matrix, int num_steps, int step, int on);
+
+static void px_graph_process_mono_equalizer(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_stereo_equalizer(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_mono_compressor(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_stereo_compressor(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_saturator(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_clipper(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_mono_limiter(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_stereo_limiter(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_mono_multiband(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_stereo_multiband(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_linked(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_mono_delay(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+static void px_graph_process_stereo_delay(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples);
+
+static int px_graph_latency_mono_limiter(const void* processor);
+static int px_graph_latency_stereo_limiter(const void* processor);
+static int px_graph_tail_mono_equalizer(const void* processor);
+static void px_graph_reset_mono_equalizer(void* processor);
+static void px_graph_reset_stereo_equalizer(void* processor);
+static void px_graph_reset_mono_delay(void* processor);
+static void px_graph_reset_stereo_delay(void* processor);
+static int px_graph_tail_stereo_equalizer(const void* processor);
+static int px_graph_tail_mono_delay(const void* processor);
+static int px_graph_tail_stereo_delay(const void* processor);
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_graph* px_graph_create(float sample_rate, int num_channels, int max_block)
+{
+	px_graph* graph = (px_graph*)px_malloc(sizeof(px_graph));
+	if (graph)
+		px_graph_initialize(graph, sample_rate, num_channels, max_block);
+	return graph;
+}
+
+static void px_graph_destroy(px_graph* graph)
+{
+	if (graph)
+	{
+		px_graph_free(graph);
+		px_free(graph);
+	}
+}
+
+static void px_graph_initialize(px_graph* graph, float sample_rate, int num_channels, int max_block)
+{
+	assert(graph);
+	assert(num_channels >= 1 && num_channels <= MAX_CHANNELS);
+	assert(max_block >= 1);
+
+	graph->sample_rate = sample_rate;
+	graph->num_channels = num_channels;
+	graph->max_block = max_block;
+	graph->stride = ((max_block + PX_GRAPH_ALIGN - 1) / PX_GRAPH_ALIGN) * PX_GRAPH_ALIGN;
+
+	graph->nodes = (px_graph_node*)px_malloc(sizeof(px_graph_node) * PX_GRAPH_MAX_NODES);
+	graph->connections = (px_graph_connection*)px_malloc(sizeof(px_graph_connection) * PX_GRAPH_MAX_CONNECTIONS);
+	graph->num_nodes = 0;
+	graph->num_connections = 0;
+
+	graph->compiled = false;
+	graph->steps = NULL;
+	graph->node_step = NULL;
+	graph->inputs = NULL;
+	graph->successors = NULL;
+	graph->num_successors = 0;
+	graph->num_slots = 0;
+	graph->arena = NULL;
+	graph->latency = 0;
+
+	graph->input = NULL;
+	graph->output = NULL;
+	graph->offset = 0;
+	graph->block = 0;
+
+	// PX_GRAPH_INPUT, PX_GRAPH_OUTPUT
+	px_graph_add_bus(graph, num_channels);
+	px_graph_add_bus(graph, num_channels);
+}
+
+static void px_graph_free(px_graph* graph)
+{
+	assert(graph);
+	px_graph_release(graph);
+	px_free(graph->nodes);
+	px_free(graph->connections);
+	graph->num_nodes = 0;
+	graph->num_connections = 0;
+	graph->compiled = false;
+}
+
+static int px_graph_add_node(px_graph* graph, px_graph_callback process, void* processor, int num_channels)
+{
+	assert(graph);
+	if (graph->num_nodes == PX_GRAPH_MAX_NODES || num_channels < 1 || num_channels > MAX_CHANNELS)
+	{
+		printf("Invalid graph node");
+		return -1;
+	}
+
+	px_graph_node* node = &graph->nodes[graph->num_nodes];
+	node->process = process;
+	node->processor = processor;
+	node->num_channels = num_channels;
+	node->latency_samples = NULL;
+	node->latency = 0;
+	node->tail_samples = NULL;
+	node->tail = process ? PX_TAIL_INFINITE : 0;	// buses only sum
+	node->reset = NULL;
+
+	graph->compiled = false;
+	return graph->num_nodes++;
+}
+
+static int px_graph_add_bus(px_graph* graph, int num_channels)
+{
+	return px_graph_add_node(graph, NULL, NULL, num_channels);
+}
+
+static int px_graph_connect(px_graph* graph, int source, int destination)
+{
+	return px_graph_add_connection(graph, source, destination, 1.f, false);
+}
+
+static int px_graph_send(px_graph* graph, int source, int destination, float gain)
+{
+	return px_graph_add_connection(graph, source, destination, dB2lin(gain), true);
+}
+
+static void px_graph_set_send_gain(px_graph* graph, int connection, float gain)
+{
+	assert(graph);
+	assert(connection >= 0 && connection < graph->num_connections);
+	assert(graph->connections[connection].send);
+	px_atomic_store(&graph->connections[connection].gain, px_graph_gain_bits(dB2lin(gain)));
+}
+
+static void px_graph_set_latency(px_graph* graph, int node, int latency)
+{
+	assert(graph);
+	assert(node >= 0 && node < graph->num_nodes);
+	graph->nodes[node].latency_samples = NULL;
+	graph->nodes[node].latency = (latency > 0) ? latency : 0;
+	graph->compiled = false;
+}
+
+static void px_graph_set_tail(px_graph* graph, int node, int tail)
+{
+	assert(graph);
+	assert(node >= 0 && node < graph->num_nodes);
+	graph->nodes[node].tail_samples = NULL;
+	graph->nodes[node].tail = (tail >= 0) ? tail : PX_TAIL_INFINITE;
+}
+
+static int px_graph_latency_samples(const px_graph* graph)
+{
+	assert(graph && graph->compiled);
+	return graph->latency;
+}
+
+/*
+	kahn's sort, then one pass in schedule order hands out slots:
+		a step takes its source's slots when it is the last reader of a plain connection
+		with the same channel count, otherwise it takes slots off the free list
+		slots go back on the free list after their last reader
+	dependencies are collected in a step x step matrix and flattened into successor lists
+*/
+static bool px_graph_compile(px_graph* graph)
+{
+	assert(graph);
+
+	const int num_steps = graph->num_nodes;
+	const int max_slots = num_steps * MAX_CHANNELS;
+
+	int* order = (int*)px_malloc(sizeof(int) * num_steps);
+	if (px_graph_sort(graph, order) < num_steps)
+	{
+		printf("Invalid graph, cycle");
+		px_free(order);
+		return false;
+	}
+
+	px_graph_release(graph);
+	px_graph_align(graph, order);
+
+	graph->steps = (px_graph_step*)px_malloc(sizeof(px_graph_step) * num_steps);
+	graph->node_step = (int*)px_malloc(sizeof(int) * num_steps);
+	graph->inputs = (int*)px_malloc(sizeof(int) * (graph->num_connections + 1));
+
+	int* readers = (int*)px_malloc(sizeof(int) * num_steps);		// reads left per node
+	int* slots = (int*)px_malloc(sizeof(int) * num_steps * MAX_CHANNELS);	// slot per node channel
+	int* owner = (int*)px_malloc(sizeof(int) * max_slots);			// last node written to a slot
+	int* free_slots = (int*)px_malloc(sizeof(int) * max_slots);
+	bool* depends = (bool*)px_malloc(sizeof(bool) * num_steps * num_steps);
+	int num_free = 0;
+	int num_slots = 0;
+
+	memset(depends, 0, sizeof(bool) * num_steps * num_steps);
+	for (int node = 0; node < num_steps; ++node)
+	{
+		graph->node_step[order[node]] = node;
+		readers[node] = 0;
+	}
+	for (int connection = 0; connection < graph->num_connections; ++connection)
+		readers[graph->connections[connection].source]++;
+
+	int num_inputs = 0;
+	for (int index = 0; index < num_steps; ++index)
+	{
+		const int node = order[index];
+		const int num_channels = graph->nodes[node].num_channels;
+		px_graph_step* step = &graph->steps[index];
+
+		step->node = node;
+		step->in_place = false;
+		step->first_input = num_inputs;
+		px_silence_reset(&step->silence);
+		step->silent = false;
+		step->quiet = 0;
+		for (int connection = 0; connection < graph->num_connections; ++connection)
+		{
+			if (graph->connections[connection].destination != node)
+				continue;
+			graph->inputs[num_inputs++] = connection;
+			px_graph_depend(depends, num_steps, index, graph->node_step[graph->connections[connection].source]);
+		}
+		step->num_inputs = num_inputs - step->first_input;
+
+		// the output writes straight into the caller's buffers
+		if (node != PX_GRAPH_OUTPUT)
+		{
+			const px_graph_connection* only = (step->num_inputs == 1) ? &graph->connections[graph->inputs[step->first_input]] : NULL;
+			step->in_place = only && !only->send && readers[only->source] == 1
+				&& graph->nodes[only->source].num_channels == num_channels;
+
+			if (step->in_place)
+			{
+				// the other readers of the buffer have to be done with it
+				for (int connection = 0; connection < graph->num_connections; ++connection)
+					if (graph->connections[connection].source == only->source)
+						px_graph_depend(depends, num_steps, index, graph->node_step[graph->connections[connection].destination]);
+
+				for (int channel = 0; channel < num_channels; ++channel)
+				{
+					slots[node * MAX_CHANNELS + channel] = slots[only->source * MAX_CHANNELS + channel];
+					owner[slots[node * MAX_CHANNELS + channel]] = node;
+				}
+				readers[only->source] = 0;
+			}
+			else
+			{
+				for (int channel = 0; channel < num_channels; ++channel)
+				{
+					const bool recycled = num_free > 0;
+					const int slot = recycled ? free_slots[--num_free] : num_slots++;
+
+					// a recycled slot waits for its last writer and everything that read it
+					if (recycled)
+					{
+						const int previous = owner[slot];
+						px_graph_depend(depends, num_steps, index, graph->node_step[previous]);
+						for (int connection = 0; connection < graph->num_connections; ++connection)
+							if (graph->connections[connection].source == previous)
+								px_graph_depend(depends, num_steps, index, graph->node_step[graph->connections[connection].destination]);
+					}
+					owner[slot] = node;
+					slots[node * MAX_CHANNELS + channel] = slot;
+				}
+			}
+		}
+
+		// sources this step was the last reader of give their slots back
+		for (int input = step->first_input; input < num_inputs; ++input)
+		{
+			const int source = graph->connections[graph->inputs[input]].source;
+			if (readers[source] > 0 && --readers[source] == 0)
+				for (int channel = 0; channel < graph->nodes[source].num_channels; ++channel)
+					free_slots[num_free++] = slots[source * MAX_CHANNELS + channel];
+		}
+
+		// nobody reads it, free right away
+		if (node != PX_GRAPH_OUTPUT && readers[node] == 0)
+			for (int channel = 0; channel < num_channels; ++channel)
+				free_slots[num_free++] = slots[node * MAX_CHANNELS + channel];
+	}
+
+	// slots to arena pointers
+	graph->num_slots = num_slots;
+	graph->arena = (SAMPLE_TYPE*)px_malloc(sizeof(SAMPLE_TYPE) * graph->stride * (num_slots > 0 ? num_slots : 1));
+	memset(graph->arena, 0, sizeof(SAMPLE_TYPE) * graph->stride * (num_slots > 0 ? num_slots : 1));
+	for (int index = 0; index < num_steps; ++index)
+	{
+		px_graph_step* step = &graph->steps[index];
+		for (int channel = 0; channel < MAX_CHANNELS; ++channel)
+			step->channels[channel] = NULL;
+		if (step->node != PX_GRAPH_OUTPUT)
+			for (int channel = 0; channel < graph->nodes[step->node].num_channels; ++channel)
+				step->channels[channel] = graph->arena + graph->stride * slots[step->node * MAX_CHANNELS + channel];
+	}
+
+	// dependency matrix to successor lists
+	int num_successors = 0;
+	for (int index = 0; index < num_steps; ++index)
+		for (int later = 0; later < num_steps; ++later)
+			num_successors += depends[later * num_steps + index];
+
+	graph->successors = (int*)px_malloc(sizeof(int) * (num_successors + 1));
+	graph->num_successors = num_successors;
+	num_successors = 0;
+	for (int index = 0; index < num_steps; ++index)
+	{
+		px_graph_step* step = &graph->steps[index];
+		step->first_successor = num_successors;
+		step->num_dependencies = 0;
+		for (int later = 0; later < num_steps; ++later)
+		{
+			if (depends[later * num_steps + index])
+				graph->successors[num_successors++] = later;
+			step->num_dependencies += depends[index * num_steps + later];
+		}
+		step->num_successors = num_successors - step->first_successor;
+	}
+
+	px_free(order);
+	px_free(readers);
+	px_free(slots);
+	px_free(owner);
+	px_free(free_slots);
+	px_free(depends);
+
+	graph->compiled = true;
+	return true;
+}
+
+// longer calls run in max_block pieces
+static void px_graph_process(px_graph* graph, SAMPLE_TYPE** input, SAMPLE_TYPE** output, int num_samples)
+{
+	px_assert(graph, input, output);
+	assert(graph->compiled);
+	PX_PROFILE_BEGIN("px_graph", graph);
+	px_fp_mode mode = px_denormals_disable();
+
+	graph->input = input;
+	graph->output = output;
+	for (int offset = 0; offset < num_samples; offset += graph->max_block)
+	{
+		graph->offset = offset;
+		graph->block = (num_samples - offset < graph->max_block) ? num_samples - offset : graph->max_block;
+
+		for (int index = 0; index < graph->num_nodes; ++index)
+			px_graph_run_step(graph, index);
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static int px_graph_add_mono_equalizer(px_graph* graph, px_mono_equalizer* equalizer)
+{
+	return px_graph_add_processor(graph, px_graph_process_mono_equalizer, equalizer, 1, NULL, px_equalizer_mono_latency_samples(equalizer),
+				      px_graph_tail_mono_equalizer, 0, px_graph_reset_mono_equalizer);
+}
+
+static int px_graph_add_stereo_equalizer(px_graph* graph, px_stereo_equalizer* equalizer)
+{
+	return px_graph_add_processor(graph, px_graph_process_stereo_equalizer, equalizer, 2, NULL, px_equalizer_stereo_latency_samples(equalizer),
+				      px_graph_tail_stereo_equalizer, 0, px_graph_reset_stereo_equalizer);
+}
+
+static int px_graph_add_mono_compressor(px_graph* graph, px_mono_compressor* compressor)
+{
+	return px_graph_add_processor(graph, px_graph_process_mono_compressor, compressor, 1, NULL, px_compressor_mono_latency_samples(compressor),
+				      NULL, PX_TAIL_INFINITE, NULL);
+}
+
+static int px_graph_add_stereo_compressor(px_graph* graph, px_stereo_compressor* compressor)
+{
+	return px_graph_add_processor(graph, px_graph_process_stereo_compressor, compressor, 2, NULL, px_compressor_stereo_latency_samples(compressor),
+				      NULL, PX_TAIL_INFINITE, NULL);
+}
+
+static int px_graph_add_saturator(px_graph* graph, px_saturator* saturator, int num_channels)
+{
+	return px_graph_add_processor(graph, px_graph_process_saturator, saturator, num_channels, NULL, px_saturator_latency_samples(saturator),
+				      NULL, px_saturator_tail_samples(saturator), NULL);
+}
+
+static int px_graph_add_clipper(px_graph* graph, px_clipper* clipper, int num_channels)
+{
+	return px_graph_add_processor(graph, px_graph_process_clipper, clipper, num_channels, NULL, px_clipper_latency_samples(clipper),
+				      NULL, px_clipper_tail_samples(clipper), NULL);
+}
+
+static int px_graph_add_mono_limiter(px_graph* graph, px_mono_limiter* limiter)
+{
+	return px_graph_add_processor(graph, px_graph_process_mono_limiter, limiter, 1,
+				      px_graph_latency_mono_limiter, px_limiter_mono_latency_samples(limiter), NULL, PX_TAIL_INFINITE, NULL);
+}
+
+static int px_graph_add_stereo_limiter(px_graph* graph, px_stereo_limiter* limiter)
+{
+	return px_graph_add_processor(graph, px_graph_process_stereo_limiter, limiter, 2,
+				      px_graph_latency_stereo_limiter, px_limiter_stereo_latency_samples(limiter), NULL, PX_TAIL_INFINITE, NULL);
+}
+
+static int px_graph_add_mono_multiband(px_graph* graph, px_mono_multiband* multiband)
+{
+	return px_graph_add_processor(graph, px_graph_process_mono_multiband, multiband, 1, NULL, px_multiband_mono_latency_samples(multiband),
+				      NULL, PX_TAIL_INFINITE, NULL);
+}
+
+static int px_graph_add_stereo_multiband(px_graph* graph, px_stereo_multiband* multiband)
+{
+	return px_graph_add_processor(graph, px_graph_process_stereo_multiband, multiband, 2, NULL, px_multiband_stereo_latency_samples(multiband),
+				      NULL, PX_TAIL_INFINITE, NULL);
+}
+
+static int px_graph_add_linked(px_graph* graph, px_linked_compressor* linked)
+{
+	assert(linked);
+	return px_graph_add_processor(graph, px_graph_process_linked, linked, linked->num_channels, NULL, px_linked_latency_samples(linked),
+				      NULL, PX_TAIL_INFINITE, NULL);
+}
+
+static int px_graph_add_mono_delay(px_graph* graph, px_delay_line* delay)
+{
+	return px_graph_add_processor(graph, px_graph_process_mono_delay, delay, 1, NULL, px_delay_mono_latency_samples(delay),
+				      px_graph_tail_mono_delay, 0, px_graph_reset_mono_delay);
+}
+
+static int px_graph_add_stereo_delay(px_graph* graph, px_stereo_delay* delay)
+{
+	return px_graph_add_processor(graph, px_graph_process_stereo_delay, delay, 2, NULL, px_delay_stereo_latency_samples(delay),
+				      px_graph_tail_stereo_delay, 0, px_graph_reset_stereo_delay);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static int px_graph_add_processor(px_graph* graph, px_graph_callback process, void* processor, int num_channels,
+				  px_graph_latency_callback latency_samples, int latency, px_graph_tail_callback tail_samples, int tail,
+				  px_graph_reset_callback reset)
+{
+	int node = px_graph_add_node(graph, process, processor, num_channels);
+	if (node >= 0)
+	{
+		graph->nodes[node].latency_samples = latency_samples;
+		graph->nodes[node].latency = latency;
+		graph->nodes[node].tail_samples = tail_samples;
+		graph->nodes[node].tail = tail;
+		graph->nodes[node].reset = reset;
+	}
+	return node;
+}
+
+static int px_graph_add_connection(px_graph* graph, int source, int destination, float gain, bool send)
+{
+	assert(graph);
+	if (graph->num_connections == PX_GRAPH_MAX_CONNECTIONS
+		|| source < 0 || source >= graph->num_nodes || destination < 0 || destination >= graph->num_nodes
+		|| source == PX_GRAPH_OUTPUT || destination == PX_GRAPH_INPUT)
+	{
+		printf("Invalid graph connection");
+		return -1;
+	}
+
+	px_graph_connection* connection = &graph->connections[graph->num_connections];
+	connection->source = source;
+	connection->destination = destination;
+	px_atomic_init(&connection->gain, px_graph_gain_bits(gain));
+	px_smoother_initialize(&connection->ramp, graph->sample_rate, PX_GRAPH_SEND_SMOOTHING, SMOOTHER_LINEAR, gain);
+	connection->send = send;
+	connection->delay = 0;
+	connection->lines = NULL;
+
+	graph->compiled = false;
+	return graph->num_connections++;
+}
+
+// frees what compile built
+static void px_graph_release(px_graph* graph)
+{
+	if (graph->steps)
+	{
+		px_free(graph->steps);
+		px_free(graph->node_step);
+		px_free(graph->inputs);
+		px_free(graph->successors);
+		px_free(graph->arena);
+		graph->steps = NULL;
+	}
+
+	for (int index = 0; index < graph->num_connections; ++index)
+	{
+		px_graph_connection* connection = &graph->connections[index];
+		if (connection->lines)
+		{
+			for (int channel = 0; channel < graph->nodes[connection->source].num_channels; ++channel)
+				px_free(connection->lines[channel].data);
+			px_free(connection->lines);
+			connection->lines = NULL;
+		}
+		connection->delay = 0;
+	}
+}
+
+// latency at each node's input is the latest of its connections, earlier ones are delayed to match
+static void px_graph_align(px_graph* graph, const int* order)
+{
+	int* arrival = (int*)px_malloc(sizeof(int) * graph->num_nodes);	// latency at the node's input
+	for (int node = 0; node < graph->num_nodes; ++node)
+	{
+		px_graph_node* current = &graph->nodes[node];
+		if (current->latency_samples)
+			current->latency = current->latency_samples(current->processor);
+		arrival[node] = 0;
+	}
+
+	// sorted, so every source is final before its destinations read it
+	for (int index = 0; index < graph->num_nodes; ++index)
+	{
+		const int node = order[index];
+		for (int connection = 0; connection < graph->num_connections; ++connection)
+		{
+			const px_graph_connection* edge = &graph->connections[connection];
+			if (edge->source == node && arrival[node] + graph->nodes[node].latency > arrival[edge->destination])
+				arrival[edge->destination] = arrival[node] + graph->nodes[node].latency;
+		}
+	}
+
+	for (int index = 0; index < graph->num_connections; ++index)
+	{
+		px_graph_connection* connection = &graph->connections[index];
+		const int source = connection->source;
+		connection->delay = arrival[connection->destination] - arrival[source] - graph->nodes[source].latency;
+		if (connection->delay == 0)
+			continue;
+
+		// same setup as the limiter's lookahead line, push one and pop one per sample
+		connection->lines = (px_circular_buffer*)px_malloc(sizeof(px_circular_buffer) * graph->nodes[source].num_channels);
+		for (int channel = 0; channel < graph->nodes[source].num_channels; ++channel)
+		{
+			px_circular_initialize(&connection->lines[channel], connection->delay + 2);
+			connection->lines[channel].head = connection->delay;
+		}
+	}
+
+	graph->latency = arrival[PX_GRAPH_OUTPUT];
+	px_free(arrival);
+}
+
+static void px_graph_run_step(px_graph* graph, int index)
+{
+	px_graph_step* step = &graph->steps[index];
+	const px_graph_node* node = &graph->nodes[step->node];
+	const int num_samples = graph->block;
+
+	if (step->node == PX_GRAPH_INPUT)
+	{
+		bool silent = true;
+		for (int channel = 0; channel < node->num_channels; ++channel)
+		{
+			memcpy(step->channels[channel], graph->input[channel] + graph->offset, sizeof(SAMPLE_TYPE) * num_samples);
+			silent = silent && px_is_silent(step->channels[channel], num_samples);
+		}
+		px_graph_settle(step, silent, num_samples);
+		return;
+	}
+
+	SAMPLE_TYPE* channels[MAX_CHANNELS];
+	for (int channel = 0; channel < node->num_channels; ++channel)
+		channels[channel] = (step->node == PX_GRAPH_OUTPUT) ? graph->output[channel] + graph->offset : step->channels[channel];
+
+	// silent past the tail, the node isn't called and its buffers aren't touched
+	const bool silent = px_graph_inputs_silent(graph, step);
+	const int tail = !silent ? PX_TAIL_INFINITE : (node->tail_samples ? node->tail_samples(node->processor) : node->tail);
+	const bool asleep = step->silence.asleep;
+	if (px_silence_skip(&step->silence, silent, num_samples, tail))
+	{
+		if (!asleep && node->reset)
+			node->reset(node->processor);
+		px_graph_skip_sends(graph, step, num_samples);
+		if (step->node == PX_GRAPH_OUTPUT)
+			for (int channel = 0; channel < node->num_channels; ++channel)
+				memset(channels[channel], 0, sizeof(SAMPLE_TYPE) * num_samples);
+		px_graph_settle(step, true, num_samples);
+		return;
+	}
+
+	// a silent source's buffer may be stale, still ringing nodes start from zeros
+	if (silent)
+	{
+		px_graph_skip_sends(graph, step, num_samples);
+		for (int channel = 0; channel < node->num_channels; ++channel)
+			memset(channels[channel], 0, sizeof(SAMPLE_TYPE) * num_samples);
+	}
+	else if (!step->in_place)
+		px_graph_mix(graph, step, channels, node->num_channels);
+
+	if (node->process)
+		node->process(node->processor, channels, node->num_channels, num_samples);
+
+	// only a ringing tail can go quiet, loud inputs aren't scanned
+	bool output_silent = silent;
+	for (int channel = 0; output_silent && node->process && channel < node->num_channels; ++channel)
+		output_silent = px_is_silent(channels[channel], num_samples);
+	px_graph_settle(step, output_silent, num_samples);
+}
+
+// every connection flagged, delayed ones also run dry
+static bool px_graph_inputs_silent(const px_graph* graph, const px_graph_step* step)
+{
+	for (int input = step->first_input; input < step->first_input + step->num_inputs; ++input)
+		if (!px_graph_connection_silent(graph, &graph->connections[graph->inputs[input]]))
+			return false;
+	return true;
+}
+
+// a delayed connection still plays out what its source sent before going quiet
+static bool px_graph_connection_silent(const px_graph* graph, const px_graph_connection* connection)
+{
+	const px_graph_step* source = &graph->steps[graph->node_step[connection->source]];
+	return source->silent && source->quiet >= connection->delay + graph->block;
+}
+
+static void px_graph_settle(px_graph_step* step, bool silent, int num_samples)
+{
+	step->silent = silent;
+	if (!silent)
+		step->quiet = 0;
+	else
+		step->quiet = (step->quiet < PX_TAIL_MAX - num_samples) ? step->quiet + num_samples : PX_TAIL_MAX;
+}
+
+static void px_graph_mix(px_graph* graph, const px_graph_step* step, SAMPLE_TYPE** channels, int num_channels)
+{
+	const int num_samples = graph->block;
+	bool written[MAX_CHANNELS] = { false };
+
+	for (int input = step->first_input; input < step->first_input + step->num_inputs; ++input)
+	{
+		px_graph_connection* connection = &graph->connections[graph->inputs[input]];
+		const px_graph_step* source = &graph->steps[graph->node_step[connection->source]];
+		const int source_channels = graph->nodes[connection->source].num_channels;
+		if (connection->send)
+			px_graph_send_update(connection);
+
+		// flagged sources add nothing and may not have written their buffers
+		if (px_graph_connection_silent(graph, connection))
+		{
+			px_smoother_skip(&connection->ramp, num_samples);
+			continue;
+		}
+
+		if (px_smoother_is_smoothing(&connection->ramp))
+		{
+			px_graph_mix_ramp(graph, connection, channels, num_channels, written);
+			continue;
+		}
+
+		const SAMPLE_TYPE gain = connection->ramp.current;
+
+		// narrower sources repeat, wider ones fold down
+		const int count = (source_channels > num_channels) ? source_channels : num_channels;
+		if (connection->delay == 0)
+		{
+			for (int channel = 0; channel < count; ++channel)
+			{
+				const int destination = channel % num_channels;
+				px_graph_accumulate(channels[destination], source->channels[channel % source_channels], gain, !written[destination], num_samples);
+				written[destination] = true;
+			}
+			continue;
+		}
+
+		// each source channel goes through its line once, then to every destination it maps to
+		SAMPLE_TYPE delayed[PX_GRAPH_SCRATCH];
+		for (int source_channel = 0; source_channel < source_channels; ++source_channel)
+		{
+			for (int offset = 0; offset < num_samples; offset += PX_GRAPH_SCRATCH)
+			{
+				const int piece = (num_samples - offset < PX_GRAPH_SCRATCH) ? num_samples - offset : PX_GRAPH_SCRATCH;
+				px_graph_delay(&connection->lines[source_channel], source->silent ? NULL : source->channels[source_channel] + offset, delayed, piece);
+				for (int channel = source_channel; channel < count; channel += source_channels)
+					px_graph_accumulate(channels[channel % num_channels] + offset, delayed, gain, !written[channel % num_channels], piece);
+			}
+			for (int channel = source_channel; channel < count; channel += source_channels)
+				written[channel % num_channels] = true;
+		}
+	}
+
+	for (int channel = 0; channel < num_channels; ++channel)
+		if (!written[channel])
+			memset(channels[channel], 0, sizeof(SAMPLE_TYPE) * num_samples);
+}
+
+// a send mid-glide, piece by piece so every channel gets the same per-sample gains
+static void px_graph_mix_ramp(px_graph* graph, px_graph_connection* connection, SAMPLE_TYPE** channels, int num_channels, bool* written)
+{
+	const px_graph_step* source = &graph->steps[graph->node_step[connection->source]];
+	const int source_channels = graph->nodes[connection->source].num_channels;
+	const int count = (source_channels > num_channels) ? source_channels : num_channels;
+	const int num_samples = graph->block;
+
+	float gains[PX_GRAPH_SCRATCH];
+	SAMPLE_TYPE delayed[PX_GRAPH_SCRATCH];
+	bool touched[MAX_CHANNELS];
+
+	for (int offset = 0; offset < num_samples; offset += PX_GRAPH_SCRATCH)
+	{
+		const int piece = (num_samples - offset < PX_GRAPH_SCRATCH) ? num_samples - offset : PX_GRAPH_SCRATCH;
+		px_smoother_process_block(&connection->ramp, gains, piece);
+		memcpy(touched, written, sizeof(bool) * num_channels);
+
+		for (int source_channel = 0; source_channel < source_channels; ++source_channel)
+		{
+			const SAMPLE_TYPE* input = source->channels[source_channel] + offset;
+			if (connection->delay > 0)
+			{
+				px_graph_delay(&connection->lines[source_channel], source->silent ? NULL : input, delayed, piece);
+				input = delayed;
+			}
+			for (int channel = source_channel; channel < count; channel += source_channels)
+			{
+				px_graph_accumulate_ramp(channels[channel % num_channels] + offset, input, gains, !touched[channel % num_channels], piece);
+				touched[channel % num_channels] = true;
+			}
+		}
+	}
+
+	for (int channel = 0; channel < count; ++channel)
+		written[channel % num_channels] = true;
+}
+
+// inputs the step didn't mix, sends still follow their gain
+static void px_graph_skip_sends(px_graph* graph, const px_graph_step* step, int num_samples)
+{
+	for (int input = step->first_input; input < step->first_input + step->num_inputs; ++input)
+	{
+		px_graph_connection* connection = &graph->connections[graph->inputs[input]];
+		if (connection->send)
+		{
+			px_graph_send_update(connection);
+			px_smoother_skip(&connection->ramp, num_samples);
+		}
+	}
+}
+
+// picks up px_graph_set_send_gain, once per block
+static void px_graph_send_update(px_graph_connection* connection)
+{
+	const float gain = px_graph_bits_gain(px_atomic_load_relaxed(&connection->gain));
+	if (gain != connection->ramp.target)
+		px_smoother_set_target(&connection->ramp, gain);
+}
+
+// first = overwrite
+static void px_graph_accumulate(SAMPLE_TYPE* destination, const SAMPLE_TYPE* source, SAMPLE_TYPE gain, bool first, int num_samples)
+{
+	const px_simd gains = px_simd_set1(gain);
+
+	int i = 0;
+	if (first)
+	{
+		for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+			px_simd_store(destination + i, px_simd_mul(px_simd_load(source + i), gains));
+		for (; i < num_samples; ++i)
+			destination[i] = source[i] * gain;
+	}
+	else
+	{
+		for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+			px_simd_store(destination + i, px_simd_mul_add(px_simd_load(source + i), gains, px_simd_load(destination + i)));
+		for (; i < num_samples; ++i)
+			destination[i] += source[i] * gain;
+	}
+}
+
+static void px_graph_accumulate_ramp(SAMPLE_TYPE* destination, const SAMPLE_TYPE* source, const float* gains, bool first, int num_samples)
+{
+	if (first)
+	{
+		for (int i = 0; i < num_samples; ++i)
+			destination[i] = source[i] * (SAMPLE_TYPE)gains[i];
+	}
+	else
+	{
+		for (int i = 0; i < num_samples; ++i)
+			destination[i] += source[i] * (SAMPLE_TYPE)gains[i];
+	}
+}
+
+// the send gain crosses threads as the bits of a float
+static inline int px_graph_gain_bits(float gain)
+{
+	int bits;
+	memcpy(&bits, &gain, sizeof(bits));
+	return bits;
+}
+
+static inline float px_graph_bits_gain(int bits)
+{
+	float gain;
+	memcpy(&gain, &bits, sizeof(gain));
+	return gain;
+}
+
+// input NULL = silence, the line plays out what it holds
+static void px_graph_delay(px_circular_buffer* line, const SAMPLE_TYPE* input, SAMPLE_TYPE* output, int num_samples)
+{
+	for (int i = 0; i < num_samples; ++i)
+	{
+		px_circular_push(line, input ? input[i] : (SAMPLE_TYPE)0);
+		output[i] = px_circular_pop(line);
+	}
+}
+
+// returns how many nodes made it into order, fewer than num_nodes means a cycle
+static int px_graph_sort(const px_graph* graph, int* order)
+{
+	int* pending = (int*)px_malloc(sizeof(int) * graph->num_nodes);	// unsorted inputs per node
+	for (int node = 0; node < graph->num_nodes; ++node)
+		pending[node] = 0;
+	for (int connection = 0; connection < graph->num_connections; ++connection)
+		pending[graph->connections[connection].destination]++;
+
+	// order doubles as the queue
+	int head = 0;
+	int tail = 0;
+	for (int node = 0; node < graph->num_nodes; ++node)
+		if (pending[node] == 0)
+			order[tail++] = node;
+
+	while (head < tail)
+	{
+		const int node = order[head++];
+		for (int connection = 0; connection < graph->num_connections; ++connection)
+			if (graph->connections[connection].source == node && --pending[graph->connections[connection].destination] == 0)
+				order[tail++] = graph->connections[connection].destination;
+	}
+
+	px_free(pending);
+	return tail;
+}
+
+static void px_graph_depend(bool* matrix, int num_steps, int step, int on)
+{
+	if (on != step)
+		matrix[step * num_steps + on] = true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// processor adapters, one call per block
+
+static void px_graph_process_mono_equalizer(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_equalizer_mono_process_block((px_mono_equalizer*)processor, channels[0], num_samples);
+}
+
+static void px_graph_process_stereo_equalizer(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_equalizer_stereo_process_block((px_stereo_equalizer*)processor, channels[0], channels[1], num_samples);
+}
+
+static void px_graph_process_mono_compressor(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_compressor_mono_process_block((px_mono_compressor*)processor, channels[0], num_samples);
+}
+
+static void px_graph_process_stereo_compressor(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_compressor_stereo_process_block((px_stereo_compressor*)processor, channels[0], channels[1], num_samples, false);
+}
+
+static void px_graph_process_saturator(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	if (num_channels == 2)
+	{
+		px_saturator_stereo_process_block((px_saturator*)processor, channels[0], channels[1], num_samples);
+		return;
+	}
+
+	// the drive ramp has to cover every channel, so run them from the same start
+	px_saturator* saturator = (px_saturator*)processor;
+	const float ramp_gain = saturator->ramp_gain;
+	const px_smoother smoother = saturator->smoother;
+	for (int channel = 0; channel < num_channels; ++channel)
+	{
+		saturator->ramp_gain = ramp_gain;
+		saturator->smoother = smoother;
+		px_saturator_mono_process_block(saturator, channels[channel], num_samples);
+	}
+}
+
+static void px_graph_process_clipper(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	for (int channel = 0; channel < num_channels; ++channel)
+		px_clipper_mono_process_block((px_clipper*)processor, channels[channel], num_samples);
+}
+
+static void px_graph_process_mono_limiter(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_limiter_mono_process_block((px_mono_limiter*)processor, channels[0], num_samples);
+}
+
+static void px_graph_process_stereo_limiter(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_limiter_stereo_process_block((px_stereo_limiter*)processor, channels[0], channels[1], num_samples);
+}
+
+static void px_graph_process_mono_multiband(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_multiband_mono_process_block((px_mono_multiband*)processor, channels[0], num_samples);
+}
+
+static void px_graph_process_stereo_multiband(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_multiband_stereo_process_block((px_stereo_multiband*)processor, channels[0], channels[1], num_samples);
+}
+
+static void px_graph_process_linked(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_linked_process_block((px_linked_compressor*)processor, channels, num_samples);
+}
+
+static void px_graph_process_mono_delay(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_delay_mono_process_block((px_delay_line*)processor, channels[0], num_samples);
+}
+
+static void px_graph_process_stereo_delay(void* processor, SAMPLE_TYPE** channels, int num_channels, int num_samples)
+{
+	px_delay_stereo_process_block((px_stereo_delay*)processor, channels[0], channels[1], num_samples);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// processor latencies that can change, asked at compile
+
+static int px_graph_latency_mono_limiter(const void* processor)
+{
+	return px_limiter_mono_latency_samples((const px_mono_limiter*)processor);
+}
+
+static int px_graph_latency_stereo_limiter(const void* processor)
+{
+	return px_limiter_stereo_latency_samples((const px_stereo_limiter*)processor);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// processor tails, asked on silent blocks
+
+static int px_graph_tail_mono_equalizer(const void* processor)
+{
+	return px_equalizer_mono_tail_samples((const px_mono_equalizer*)processor);
+}
+
+static int px_graph_tail_stereo_equalizer(const void* processor)
+{
+	return px_equalizer_stereo_tail_samples((const px_stereo_equalizer*)processor);
+}
+
+static int px_graph_tail_mono_delay(const void* processor)
+{
+	return px_delay_mono_tail_samples((const px_delay_line*)processor);
+}
+
+static int px_graph_tail_stereo_delay(const void* processor)
+{
+	return px_delay_stereo_tail_samples((const px_stereo_delay*)processor);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// processor resets, on the first skipped block
+
+static void px_graph_reset_mono_equalizer(void* processor)
+{
+	px_equalizer_mono_reset((px_mono_equalizer*)processor);
+}
+
+static void px_graph_reset_stereo_equalizer(void* processor)
+{
+	px_equalizer_stereo_reset((px_stereo_equalizer*)processor);
+}
+
+static void px_graph_reset_mono_delay(void* processor)
+{
+	px_delay_mono_reset((px_delay_line*)processor);
+}
+
+static void px_graph_reset_stereo_delay(void* processor)
+{
+	px_delay_stereo_reset((px_stereo_delay*)processor);
+}
+
+#endif
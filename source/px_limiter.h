@@ -0,0 +1,611 @@
+#include "px_globals.h"
+#include "px_buffer.h"
+#include "px_memory.h"
+#include "px_meter.h"
+#include "px_profile.h"
+
+#ifndef PX_LIMITER_H
+#define PX_LIMITER_H
+
+/*
+	px_limiter.h
+
+	lookahead brickwall limiter, output samples never go over the ceiling, with true peak on it is a dBTP ceiling
+
+	per sample:
+		peak    |x| or the 4x oversampled true peak (ITU-R BS.1770-4 annex 2 interpolator)
+		window  sliding maximum of the peaks over the lookahead, monotonic deque, O(1) amortized
+		gain    ceiling / window max, released with a one-pole, then a moving average over the
+		        lookahead so the gain ramps down smoothly and is fully down when the peak comes out
+		audio   delayed by the lookahead (px_circular_buffer) and multiplied by the gain
+
+	the moving average is a running sum, resynced the same way as the RMS window in px_detector.h.
+	BS.1770 allows a 4x interpolator to under-read inter-sample peaks near nyquist by up to ~0.7 dB,
+	leave that much headroom under hard delivery limits.
+	the audio is delayed by px_limiter_latency() samples, lookahead plus the true-peak filter delay.
+
+	init:
+		px_mono_limiter limiter;
+		px_limiter_mono_initialize(&limiter, sample_rate);	// allocates for PX_LIMITER_MAX_LOOKAHEAD ms
+
+		px_limiter_mono_set_ceiling(&limiter, -1.f);		// dBTP
+		px_limiter_mono_set_lookahead(&limiter, 5.f);		// ms, resets the limiter
+		px_limiter_mono_set_release(&limiter, 50.f);		// ms
+		px_limiter_mono_set_true_peak(&limiter, true);
+
+		px_limiter_mono_set_meter(&limiter, &meter);		// px_meter, output level and gain reduction
+
+		px_limiter_mono_free_buffers(&limiter);			// stack instances
+	heap:
+		px_mono_limiter* limiter = px_limiter_mono_create(sample_rate);
+		px_limiter_mono_destroy(limiter);
+
+	use:
+		px_limiter_mono_process_block(&limiter, buffer, num_samples);
+		px_limiter_stereo_process_block(&stereo_limiter, left, right, num_samples);	// linked gain
+*/
+
+#ifndef PX_LIMITER_MAX_LOOKAHEAD
+	#define PX_LIMITER_MAX_LOOKAHEAD 20.f	// ms
+#endif
+
+#define PX_TRUE_PEAK_TAPS 12	// per phase
+#define PX_TRUE_PEAK_PHASES 4
+#define PX_TRUE_PEAK_DELAY 6	// samples until an inter-sample peak shows up in the interpolator output
+#define PX_LIMITER_CHUNK 64
+
+#define INITIALIZED_LIMITER_PARAMETERS { 48000.f, -1.f, 5.f, 50.f, true }
+
+typedef struct
+{
+	float sample_rate;
+	float ceiling;		// dB
+	float lookahead;	// ms
+	float release;		// ms
+	bool true_peak;
+} px_limiter_parameters;
+
+typedef struct
+{
+	SAMPLE_TYPE history[2 * PX_TRUE_PEAK_TAPS];	// written twice so the last PX_TRUE_PEAK_TAPS are always contiguous
+	int position;
+} px_true_peak_detector;
+
+// the gain path shared by every channel of a limiter
+typedef struct
+{
+	px_sliding_max window;
+
+	SAMPLE_TYPE* average;	// ring of released gains
+	double sum;
+	double lap;		// gains pushed since the ring last wrapped, the resynced sum
+	int position;
+	int length;		// attack ramp, samples
+
+	SAMPLE_TYPE envelope;
+	SAMPLE_TYPE release_coefficient;
+	SAMPLE_TYPE ceiling;	// linear
+} px_limiter_gain;
+
+typedef struct
+{
+	px_limiter_parameters parameters;
+	px_limiter_gain gain;
+	px_true_peak_detector detector;
+	px_circular_buffer delay;
+	px_meter* meter;
+} px_mono_limiter;
+
+typedef struct
+{
+	px_limiter_parameters parameters;
+	px_limiter_gain gain;
+	px_true_peak_detector detector_left;
+	px_true_peak_detector detector_right;
+	px_circular_buffer delay_left;
+	px_circular_buffer delay_right;
+	px_meter* meter;
+} px_stereo_limiter;
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_mono_limiter* px_limiter_mono_create(float sample_rate);
+static void px_limiter_mono_destroy(px_mono_limiter* limiter);
+static px_stereo_limiter* px_limiter_stereo_create(float sample_rate);
+static void px_limiter_stereo_destroy(px_stereo_limiter* limiter);
+
+// mono
+
+static void px_limiter_mono_initialize(px_mono_limiter* limiter, float sample_rate);
+static void px_limiter_mono_free_buffers(px_mono_limiter* limiter);
+static void px_limiter_mono_reset(px_mono_limiter* limiter);
+static void px_limiter_mono_process(px_mono_limiter* limiter, SAMPLE_TYPE* input);
+static void px_limiter_mono_process_block(px_mono_limiter* limiter, SAMPLE_TYPE* input, int num_samples);
+
+static void px_limiter_mono_set_ceiling(px_mono_limiter* limiter, float ceiling);
+static void px_limiter_mono_set_lookahead(px_mono_limiter* limiter, float lookahead);
+static void px_limiter_mono_set_release(px_mono_limiter* limiter, float release);
+static void px_limiter_mono_set_true_peak(px_mono_limiter* limiter, bool true_peak);
+static void px_limiter_mono_set_meter(px_mono_limiter* limiter, px_meter* meter);	// NULL = off
+static int px_limiter_mono_latency_samples(const px_mono_limiter* limiter);
+
+// stereo
+
+static void px_limiter_stereo_initialize(px_stereo_limiter* limiter, float sample_rate);
+static void px_limiter_stereo_free_buffers(px_stereo_limiter* limiter);
+static void px_limiter_stereo_reset(px_stereo_limiter* limiter);
+static void px_limiter_stereo_process(px_stereo_limiter* limiter, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right);
+static void px_limiter_stereo_process_block(px_stereo_limiter* limiter, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples);
+
+static void px_limiter_stereo_set_ceiling(px_stereo_limiter* limiter, float ceiling);
+static void px_limiter_stereo_set_lookahead(px_stereo_limiter* limiter, float lookahead);
+static void px_limiter_stereo_set_release(px_stereo_limiter* limiter, float release);
+static void px_limiter_stereo_set_true_peak(px_stereo_limiter* limiter, bool true_peak);
+static void px_limiter_stereo_set_meter(px_stereo_limiter* limiter, px_meter* meter);
+static int px_limiter_stereo_latency_samples(const px_stereo_limiter* limiter);
+
+static int px_limiter_latency(const px_limiter_parameters parameters);	// samples
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_limiter_gain_initialize(px_limiter_gain* gain, int capacity);
+static void px_limiter_gain_free(px_limiter_gain* gain);
+static void px_limiter_gain_configure(px_limiter_gain* gain, const px_limiter_parameters parameters);
+static void px_limiter_delay_reset(px_circular_buffer* delay, int latency);
+
+static inline void px_true_peak_reset(px_true_peak_detector* detector);
+static inline SAMPLE_TYPE px_true_peak_detect(px_true_peak_detector* detector, SAMPLE_TYPE input);
+static inline SAMPLE_TYPE px_limiter_gain_next(px_limiter_gain* gain, SAMPLE_TYPE peak);
+static inline SAMPLE_TYPE px_limiter_delay_next(px_circular_buffer* delay, SAMPLE_TYPE input);
+
+// ----------------------------------------------------------------------------------------------------
+
+// ITU-R BS.1770-4 annex 2 48 tap interpolator, stored tap-major so the 4 phases accumulate side by side
+static const SAMPLE_TYPE px_true_peak_coefficients[PX_TRUE_PEAK_TAPS][PX_TRUE_PEAK_PHASES] =
+{
+	{  0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f },
+	{  0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f },
+	{ -0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f },
+	{  0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f },
+	{ -0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f },
+	{  0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f },
+	{  0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f },
+	{ -0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f },
+	{  0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f },
+	{ -0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f },
+	{  0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f },
+	{ -0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f }
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_mono_limiter* px_limiter_mono_create(float sample_rate)
+{
+	px_mono_limiter* limiter = (px_mono_limiter*)px_malloc(sizeof(px_mono_limiter));
+	assert(limiter);
+	px_limiter_mono_initialize(limiter, sample_rate);
+	return limiter;
+}
+
+static void px_limiter_mono_destroy(px_mono_limiter* limiter)
+{
+	if (limiter)
+	{
+		px_limiter_mono_free_buffers(limiter);
+		px_free(limiter);
+	}
+}
+
+static px_stereo_limiter* px_limiter_stereo_create(float sample_rate)
+{
+	px_stereo_limiter* limiter = (px_stereo_limiter*)px_malloc(sizeof(px_stereo_limiter));
+	assert(limiter);
+	px_limiter_stereo_initialize(limiter, sample_rate);
+	return limiter;
+}
+
+static void px_limiter_stereo_destroy(px_stereo_limiter* limiter)
+{
+	if (limiter)
+	{
+		px_limiter_stereo_free_buffers(limiter);
+		px_free(limiter);
+	}
+}
+
+static void px_limiter_mono_initialize(px_mono_limiter* limiter, float sample_rate)
+{
+	assert(limiter);
+	px_limiter_parameters parameters = INITIALIZED_LIMITER_PARAMETERS;
+	parameters.sample_rate = sample_rate;
+	limiter->parameters = parameters;
+
+	int capacity = (int)(PX_LIMITER_MAX_LOOKAHEAD * 0.001f * sample_rate) + 1;
+	px_limiter_gain_initialize(&limiter->gain, capacity);
+	px_circular_initialize(&limiter->delay, capacity + PX_TRUE_PEAK_DELAY + 1);
+	limiter->meter = NULL;
+	px_limiter_mono_reset(limiter);
+}
+
+static void px_limiter_stereo_initialize(px_stereo_limiter* limiter, float sample_rate)
+{
+	assert(limiter);
+	px_limiter_parameters parameters = INITIALIZED_LIMITER_PARAMETERS;
+	parameters.sample_rate = sample_rate;
+	limiter->parameters = parameters;
+
+	int capacity = (int)(PX_LIMITER_MAX_LOOKAHEAD * 0.001f * sample_rate) + 1;
+	px_limiter_gain_initialize(&limiter->gain, capacity);
+	px_circular_initialize(&limiter->delay_left, capacity + PX_TRUE_PEAK_DELAY + 1);
+	px_circular_initialize(&limiter->delay_right, capacity + PX_TRUE_PEAK_DELAY + 1);
+	limiter->meter = NULL;
+	px_limiter_stereo_reset(limiter);
+}
+
+static void px_limiter_mono_free_buffers(px_mono_limiter* limiter)
+{
+	assert(limiter);
+	px_limiter_gain_free(&limiter->gain);
+	px_free(limiter->delay.data);
+}
+
+static void px_limiter_stereo_free_buffers(px_stereo_limiter* limiter)
+{
+	assert(limiter);
+	px_limiter_gain_free(&limiter->gain);
+	px_free(limiter->delay_left.data);
+	px_free(limiter->delay_right.data);
+}
+
+static void px_limiter_mono_reset(px_mono_limiter* limiter)
+{
+	assert(limiter);
+	px_limiter_gain_configure(&limiter->gain, limiter->parameters);
+	px_true_peak_reset(&limiter->detector);
+	px_limiter_delay_reset(&limiter->delay, px_limiter_latency(limiter->parameters));
+}
+
+static void px_limiter_stereo_reset(px_stereo_limiter* limiter)
+{
+	assert(limiter);
+	px_limiter_gain_configure(&limiter->gain, limiter->parameters);
+	px_true_peak_reset(&limiter->detector_left);
+	px_true_peak_reset(&limiter->detector_right);
+	px_limiter_delay_reset(&limiter->delay_left, px_limiter_latency(limiter->parameters));
+	px_limiter_delay_reset(&limiter->delay_right, px_limiter_latency(limiter->parameters));
+}
+
+static void px_limiter_mono_process(px_mono_limiter* limiter, SAMPLE_TYPE* input)
+{
+	px_assert(limiter, input);
+	SAMPLE_TYPE peak = limiter->parameters.true_peak ? px_true_peak_detect(&limiter->detector, *input) : px_fabs(*input);
+	SAMPLE_TYPE gain = px_limiter_gain_next(&limiter->gain, peak);
+	*input = px_limiter_delay_next(&limiter->delay, *input) * gain;
+
+	if (limiter->meter)
+	{
+		px_meter_gain(limiter->meter, gain);
+		px_meter_level(limiter->meter, *input);
+		px_meter_advance(limiter->meter, 1);
+	}
+}
+
+static void px_limiter_stereo_process(px_stereo_limiter* limiter, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right)
+{
+	px_assert(limiter, input_left, input_right);
+	SAMPLE_TYPE peak_left, peak_right;
+	if (limiter->parameters.true_peak)
+	{
+		peak_left = px_true_peak_detect(&limiter->detector_left, *input_left);
+		peak_right = px_true_peak_detect(&limiter->detector_right, *input_right);
+	}
+	else
+	{
+		peak_left = px_fabs(*input_left);
+		peak_right = px_fabs(*input_right);
+	}
+
+	SAMPLE_TYPE gain = px_limiter_gain_next(&limiter->gain, px_fmax(peak_left, peak_right));
+	*input_left = px_limiter_delay_next(&limiter->delay_left, *input_left) * gain;
+	*input_right = px_limiter_delay_next(&limiter->delay_right, *input_right) * gain;
+
+	if (limiter->meter)
+	{
+		px_meter_gain(limiter->meter, gain);
+		px_meter_level(limiter->meter, *input_left);
+		px_meter_level(limiter->meter, *input_right);
+		px_meter_advance(limiter->meter, 1);
+	}
+}
+
+// detection, gain and delay each run over a chunk, so every stage's state stays in registers
+static void px_limiter_mono_process_block(px_mono_limiter* limiter, SAMPLE_TYPE* input, int num_samples)
+{
+	px_assert(limiter, input);
+	PX_PROFILE_BEGIN("px_mono_limiter", limiter);
+	px_fp_mode mode = px_denormals_disable();
+	SAMPLE_TYPE gains[PX_LIMITER_CHUNK];
+
+	for (int offset = 0; offset < num_samples; offset += PX_LIMITER_CHUNK)
+	{
+		int chunk = (num_samples - offset < PX_LIMITER_CHUNK) ? num_samples - offset : PX_LIMITER_CHUNK;
+		SAMPLE_TYPE* samples = input + offset;
+
+		if (limiter->parameters.true_peak)
+		{
+			for (int i = 0; i < chunk; ++i)
+				gains[i] = px_true_peak_detect(&limiter->detector, samples[i]);
+		}
+		else
+		{
+			for (int i = 0; i < chunk; ++i)
+				gains[i] = px_fabs(samples[i]);
+		}
+
+		for (int i = 0; i < chunk; ++i)
+			gains[i] = px_limiter_gain_next(&limiter->gain, gains[i]);
+
+		for (int i = 0; i < chunk; ++i)
+			samples[i] = px_limiter_delay_next(&limiter->delay, samples[i]) * gains[i];
+
+		if (limiter->meter)
+		{
+			px_meter_gain_block(limiter->meter, gains, chunk);
+			px_meter_level_block(limiter->meter, samples, chunk);
+			px_meter_advance(limiter->meter, chunk);
+		}
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+static void px_limiter_stereo_process_block(px_stereo_limiter* limiter, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples)
+{
+	px_assert(limiter, input_left, input_right);
+	PX_PROFILE_BEGIN("px_stereo_limiter", limiter);
+	px_fp_mode mode = px_denormals_disable();
+	SAMPLE_TYPE gains[PX_LIMITER_CHUNK];
+
+	for (int offset = 0; offset < num_samples; offset += PX_LIMITER_CHUNK)
+	{
+		int chunk = (num_samples - offset < PX_LIMITER_CHUNK) ? num_samples - offset : PX_LIMITER_CHUNK;
+		SAMPLE_TYPE* left = input_left + offset;
+		SAMPLE_TYPE* right = input_right + offset;
+
+		if (limiter->parameters.true_peak)
+		{
+			for (int i = 0; i < chunk; ++i)
+			{
+				SAMPLE_TYPE peak_left = px_true_peak_detect(&limiter->detector_left, left[i]);
+				SAMPLE_TYPE peak_right = px_true_peak_detect(&limiter->detector_right, right[i]);
+				gains[i] = px_fmax(peak_left, peak_right);
+			}
+		}
+		else
+		{
+			for (int i = 0; i < chunk; ++i)
+				gains[i] = px_fmax(px_fabs(left[i]), px_fabs(right[i]));
+		}
+
+		for (int i = 0; i < chunk; ++i)
+			gains[i] = px_limiter_gain_next(&limiter->gain, gains[i]);
+
+		for (int i = 0; i < chunk; ++i)
+		{
+			left[i] = px_limiter_delay_next(&limiter->delay_left, left[i]) * gains[i];
+			right[i] = px_limiter_delay_next(&limiter->delay_right, right[i]) * gains[i];
+		}
+
+		if (limiter->meter)
+		{
+			px_meter_gain_block(limiter->meter, gains, chunk);
+			px_meter_level_block(limiter->meter, left, chunk);
+			px_meter_level_block(limiter->meter, right, chunk);
+			px_meter_advance(limiter->meter, chunk);
+		}
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+static void px_limiter_mono_set_ceiling(px_mono_limiter* limiter, float ceiling)
+{
+	assert(limiter);
+	limiter->parameters.ceiling = ceiling;
+	limiter->gain.ceiling = (SAMPLE_TYPE)dB2lin(ceiling);
+}
+
+static void px_limiter_stereo_set_ceiling(px_stereo_limiter* limiter, float ceiling)
+{
+	assert(limiter);
+	limiter->parameters.ceiling = ceiling;
+	limiter->gain.ceiling = (SAMPLE_TYPE)dB2lin(ceiling);
+}
+
+static void px_limiter_mono_set_lookahead(px_mono_limiter* limiter, float lookahead)
+{
+	assert(limiter);
+	limiter->parameters.lookahead = px_fmin(px_fmax(lookahead, 0.f), PX_LIMITER_MAX_LOOKAHEAD);
+	px_limiter_mono_reset(limiter);
+}
+
+static void px_limiter_stereo_set_lookahead(px_stereo_limiter* limiter, float lookahead)
+{
+	assert(limiter);
+	limiter->parameters.lookahead = px_fmin(px_fmax(lookahead, 0.f), PX_LIMITER_MAX_LOOKAHEAD);
+	px_limiter_stereo_reset(limiter);
+}
+
+static void px_limiter_mono_set_release(px_mono_limiter* limiter, float release)
+{
+	assert(limiter);
+	limiter->parameters.release = release;
+	limiter->gain.release_coefficient = (release > 0.f) ? (SAMPLE_TYPE)exp(-1000.f / (release * limiter->parameters.sample_rate)) : 0.f;
+}
+
+static void px_limiter_stereo_set_release(px_stereo_limiter* limiter, float release)
+{
+	assert(limiter);
+	limiter->parameters.release = release;
+	limiter->gain.release_coefficient = (release > 0.f) ? (SAMPLE_TYPE)exp(-1000.f / (release * limiter->parameters.sample_rate)) : 0.f;
+}
+
+static void px_limiter_mono_set_true_peak(px_mono_limiter* limiter, bool true_peak)
+{
+	assert(limiter);
+	limiter->parameters.true_peak = true_peak;
+	px_true_peak_reset(&limiter->detector);
+}
+
+static void px_limiter_stereo_set_true_peak(px_stereo_limiter* limiter, bool true_peak)
+{
+	assert(limiter);
+	limiter->parameters.true_peak = true_peak;
+	px_true_peak_reset(&limiter->detector_left);
+	px_true_peak_reset(&limiter->detector_right);
+}
+
+static void px_limiter_mono_set_meter(px_mono_limiter* limiter, px_meter* meter)
+{
+	assert(limiter);
+	limiter->meter = meter;
+}
+
+static void px_limiter_stereo_set_meter(px_stereo_limiter* limiter, px_meter* meter)
+{
+	assert(limiter);
+	limiter->meter = meter;
+}
+
+// moves with the lookahead, a px_graph holding the limiter picks it up at the next px_graph_compile
+static int px_limiter_mono_latency_samples(const px_mono_limiter* limiter)
+{
+	assert(limiter);
+	return px_limiter_latency(limiter->parameters);
+}
+
+static int px_limiter_stereo_latency_samples(const px_stereo_limiter* limiter)
+{
+	assert(limiter);
+	return px_limiter_latency(limiter->parameters);
+}
+
+// the true-peak filter delay stays in the path with true peak off, so toggling it doesn't move the latency
+static int px_limiter_latency(const px_limiter_parameters parameters)
+{
+	int attack = (int)(parameters.lookahead * 0.001f * parameters.sample_rate + 0.5f);
+	return ((attack > 1) ? attack : 1) - 1 + PX_TRUE_PEAK_DELAY;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_limiter_gain_initialize(px_limiter_gain* gain, int capacity)
+{
+	assert(gain);
+	// the peak window also spans the true-peak delay, the gain ramp only the lookahead
+	px_sliding_max_initialize(&gain->window, capacity + PX_TRUE_PEAK_DELAY);
+	gain->average = (SAMPLE_TYPE*)px_malloc(sizeof(SAMPLE_TYPE) * capacity);
+	gain->length = 1;
+	gain->ceiling = 1.f;
+	gain->release_coefficient = 0.f;
+}
+
+static void px_limiter_gain_free(px_limiter_gain* gain)
+{
+	assert(gain);
+	px_sliding_max_free(&gain->window);
+	px_free(gain->average);
+}
+
+static void px_limiter_gain_configure(px_limiter_gain* gain, const px_limiter_parameters parameters)
+{
+	assert(gain);
+	int attack = (int)(parameters.lookahead * 0.001f * parameters.sample_rate + 0.5f);
+	gain->length = (attack > 1) ? attack : 1;
+	px_sliding_max_reset(&gain->window, gain->length + PX_TRUE_PEAK_DELAY);
+
+	for (int i = 0; i < gain->length; ++i)
+		gain->average[i] = 1.f;
+	gain->sum = (double)gain->length;
+	gain->lap = 0.0;
+	gain->position = 0;
+	gain->envelope = 1.f;
+
+	gain->ceiling = (SAMPLE_TYPE)dB2lin(parameters.ceiling);
+	gain->release_coefficient = (parameters.release > 0.f) ? (SAMPLE_TYPE)exp(-1000.f / (parameters.release * parameters.sample_rate)) : 0.f;
+}
+
+static void px_limiter_delay_reset(px_circular_buffer* delay, int latency)
+{
+	assert(delay && latency < delay->max_length - 1);
+	memset(delay->data, 0, sizeof(BUFFER_TYPE) * delay->max_length);
+	delay->head = latency;
+	delay->tail = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static inline void px_true_peak_reset(px_true_peak_detector* detector)
+{
+	for (int i = 0; i < 2 * PX_TRUE_PEAK_TAPS; ++i)
+		detector->history[i] = 0.f;
+	detector->position = 0;
+}
+
+// largest of |input| and the three interpolated values between the last samples
+static inline SAMPLE_TYPE px_true_peak_detect(px_true_peak_detector* detector, SAMPLE_TYPE input)
+{
+	int position = detector->position;
+	detector->history[position] = input;
+	detector->history[position + PX_TRUE_PEAK_TAPS] = input;
+	detector->position = (position + 1 < PX_TRUE_PEAK_TAPS) ? position + 1 : 0;
+
+	// oldest to newest
+	const SAMPLE_TYPE* window = detector->history + position + 1;
+	SAMPLE_TYPE peak = px_fabs(input);
+
+	SAMPLE_TYPE sum[PX_TRUE_PEAK_PHASES] = { 0.f, 0.f, 0.f, 0.f };
+	for (int tap = 0; tap < PX_TRUE_PEAK_TAPS; ++tap)
+	{
+		const SAMPLE_TYPE x = window[PX_TRUE_PEAK_TAPS - 1 - tap];
+		for (int phase = 0; phase < PX_TRUE_PEAK_PHASES; ++phase)
+			sum[phase] += px_true_peak_coefficients[tap][phase] * x;
+	}
+
+	for (int phase = 0; phase < PX_TRUE_PEAK_PHASES; ++phase)
+		peak = px_fmax(peak, px_fabs(sum[phase]));
+	return peak;
+}
+
+static inline SAMPLE_TYPE px_limiter_gain_next(px_limiter_gain* gain, SAMPLE_TYPE peak)
+{
+	SAMPLE_TYPE maximum = px_sliding_max_push(&gain->window, peak);
+	SAMPLE_TYPE target = (maximum > gain->ceiling) ? gain->ceiling / maximum : 1.f;
+
+	// drops are instant, the lookahead average below turns them into a ramp
+	if (target < gain->envelope)
+		gain->envelope = target;
+	else
+		gain->envelope = target + gain->release_coefficient * (gain->envelope - target);
+
+	gain->sum += gain->envelope - gain->average[gain->position];
+	gain->average[gain->position] = gain->envelope;
+	gain->lap += gain->envelope;
+
+	if (++gain->position == gain->length)
+	{
+		// resync, see px_level_detector_mean_square
+		gain->position = 0;
+		gain->sum = gain->lap;
+		gain->lap = 0.0;
+	}
+	return (SAMPLE_TYPE)(gain->sum / (double)gain->length);
+}
+
+static inline SAMPLE_TYPE px_limiter_delay_next(px_circular_buffer* delay, SAMPLE_TYPE input)
+{
+	px_circular_push(delay, input);
+	return px_circular_pop(delay);
+}
+
+#endif
@@ -0,0 +1,261 @@
+#include "px_globals.h"
+#include "px_simd.h"
+#include "px_buffer.h"
+#include "px_compressor.h"
+#include "px_profile.h"
+
+#ifndef PX_LINKED_H
+#define PX_LINKED_H
+
+/*
+	px_linked.h
+
+	linked compressor for up to PX_LINKED_MAX_CHANNELS channels (5.1, 7.1.4, ambisonic buses).
+	one px_mono_compressor does the detector, envelope and gain computer for the whole bus, every
+	channel gets the same gain reduction so the image doesn't move.
+
+	link
+		LINK_MAX            level = max over channels of weight * |x|
+		                    px_stereo_compressor instead runs a level detector per channel and takes the max
+		                    of the levels, and filters through its sidechain eq first. the two only agree in
+		                    DETECTOR_PEAK with a flat sidechain eq
+		LINK_WEIGHTED_SUM   level = sum over channels of weight * |x|
+		weights default to 1, set the LFE to 0 to keep it out of the detector, or ~0.7 on surrounds
+
+		the link is built across samples with px_simd, one pass per channel, then the shared detector
+		and gain computer run once per sample whatever the channel count. the shared compressor's
+		sidechain eq is not used, a rectified link has nothing left for it to filter.
+
+	init:
+		px_linked_compressor linked;
+		px_linked_initialize(&linked, sample_rate, 8);		// 7.1
+
+		px_linked_set_link(&linked, LINK_WEIGHTED_SUM);
+		px_linked_set_weight(&linked, 3, 0.f);			// LFE
+		px_linked_set_trim(&linked, 3, -3.f);			// dB, per channel after the gain
+
+		// detector and transfer are a plain compressor
+		px_compressor_mono_set_threshold(px_linked_get_compressor(&linked), -18.f);
+		px_compressor_mono_set_detector(px_linked_get_compressor(&linked), DETECTOR_RMS);
+
+		px_linked_free(&linked);	// stack, frees the shared detector
+
+	use:
+		px_linked_process_block(&linked, channels, num_samples);	// SAMPLE_TYPE* channels[num_channels]
+		px_linked_process_buffer(&linked, &buffer);			// px_buffer, buffer.num_channels == linked.num_channels
+*/
+
+#define PX_LINKED_MAX_CHANNELS 16
+#define PX_LINKED_CHUNK 64
+
+typedef enum
+{
+	LINK_MAX,
+	LINK_WEIGHTED_SUM
+} LINK_MODE;
+
+typedef struct
+{
+	px_mono_compressor compressor;	// shared detector, envelope and transfer
+	LINK_MODE link;
+	int num_channels;
+
+	SAMPLE_TYPE weights[PX_LINKED_MAX_CHANNELS];	// detector weight per channel
+	SAMPLE_TYPE trims[PX_LINKED_MAX_CHANNELS];	// linear output trim per channel
+} px_linked_compressor;
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_linked_compressor* px_linked_create(float sample_rate, int num_channels);
+static void px_linked_destroy(px_linked_compressor* linked);
+
+static void px_linked_initialize(px_linked_compressor* linked, float sample_rate, int num_channels);
+static void px_linked_free(px_linked_compressor* linked);
+static void px_linked_process_block(px_linked_compressor* linked, SAMPLE_TYPE** channels, int num_samples);
+static void px_linked_process_buffer(px_linked_compressor* linked, px_buffer* buffer);
+
+static void px_linked_set_num_channels(px_linked_compressor* linked, int num_channels);
+static void px_linked_set_link(px_linked_compressor* linked, LINK_MODE link);
+static void px_linked_set_weight(px_linked_compressor* linked, int channel, float weight);
+static void px_linked_set_trim(px_linked_compressor* linked, int channel, float trim);	// dB
+static void px_linked_set_meter(px_linked_compressor* linked, px_meter* meter);	// NULL = off
+static px_mono_compressor* px_linked_get_compressor(px_linked_compressor* linked);
+static int px_linked_latency_samples(const px_linked_compressor* linked);	// 0
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_linked_compute_link(const px_linked_compressor* linked, SAMPLE_TYPE** channels, int offset, SAMPLE_TYPE* level, int num_samples);
+static void px_linked_apply_gain(SAMPLE_TYPE* buffer, const SAMPLE_TYPE* gain, SAMPLE_TYPE trim, int num_samples);
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_linked_compressor* px_linked_create(float sample_rate, int num_channels)
+{
+	px_linked_compressor* linked = (px_linked_compressor*)px_malloc(sizeof(px_linked_compressor));
+	if (linked)
+		px_linked_initialize(linked, sample_rate, num_channels);
+	return linked;
+}
+
+static void px_linked_destroy(px_linked_compressor* linked)
+{
+	if (linked)
+	{
+		px_linked_free(linked);
+		px_free(linked);
+	}
+}
+
+static void px_linked_initialize(px_linked_compressor* linked, float sample_rate, int num_channels)
+{
+	assert(linked);
+	assert(num_channels >= 1 && num_channels <= PX_LINKED_MAX_CHANNELS);
+
+	px_compressor_mono_initialize(&linked->compressor, sample_rate);
+	linked->link = LINK_MAX;
+	linked->num_channels = num_channels;
+
+	for (int channel = 0; channel < PX_LINKED_MAX_CHANNELS; ++channel)
+	{
+		linked->weights[channel] = 1.f;
+		linked->trims[channel] = 1.f;
+	}
+}
+
+static void px_linked_free(px_linked_compressor* linked)
+{
+	assert(linked);
+	px_compressor_mono_free_detector(&linked->compressor);
+}
+
+static void px_linked_process_block(px_linked_compressor* linked, SAMPLE_TYPE** channels, int num_samples)
+{
+	px_assert(linked, channels);
+	PX_PROFILE_BEGIN("px_linked_compressor", linked);
+	px_fp_mode mode = px_denormals_disable();
+
+	SAMPLE_TYPE gain[PX_LINKED_CHUNK];
+	for (int offset = 0; offset < num_samples; offset += PX_LINKED_CHUNK)
+	{
+		int chunk = (num_samples - offset < PX_LINKED_CHUNK) ? num_samples - offset : PX_LINKED_CHUNK;
+
+		// one detector and gain computer for the bus
+		px_linked_compute_link(linked, channels, offset, gain, chunk);
+		px_level_detector_process_block(&linked->compressor.detector, gain, gain, chunk);
+		px_compressor_gain_block(&linked->compressor, gain, gain, chunk);
+
+		for (int channel = 0; channel < linked->num_channels; ++channel)
+			px_linked_apply_gain(channels[channel] + offset, gain, linked->trims[channel], chunk);
+
+		if (linked->compressor.meter)
+		{
+			for (int channel = 0; channel < linked->num_channels; ++channel)
+				px_meter_level_block(linked->compressor.meter, channels[channel] + offset, chunk);
+			px_meter_advance(linked->compressor.meter, chunk);
+		}
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+static void px_linked_process_buffer(px_linked_compressor* linked, px_buffer* buffer)
+{
+	px_assert(linked, buffer);
+	assert(buffer->num_channels == linked->num_channels);
+	px_linked_process_block(linked, buffer->data, buffer->num_samples);
+}
+
+static void px_linked_set_num_channels(px_linked_compressor* linked, int num_channels)
+{
+	assert(linked);
+	assert(num_channels >= 1 && num_channels <= PX_LINKED_MAX_CHANNELS);
+	linked->num_channels = num_channels;
+}
+
+static void px_linked_set_link(px_linked_compressor* linked, LINK_MODE link)
+{
+	assert(linked);
+	if (link != LINK_MAX && link != LINK_WEIGHTED_SUM)
+	{
+		printf("Invalid link mode");
+		return;
+	}
+	linked->link = link;
+}
+
+static void px_linked_set_weight(px_linked_compressor* linked, int channel, float weight)
+{
+	assert(linked);
+	assert(channel >= 0 && channel < PX_LINKED_MAX_CHANNELS);
+	linked->weights[channel] = px_fmax(weight, 0.f);
+}
+
+static void px_linked_set_trim(px_linked_compressor* linked, int channel, float trim)
+{
+	assert(linked);
+	assert(channel >= 0 && channel < PX_LINKED_MAX_CHANNELS);
+	linked->trims[channel] = dB2lin(trim);
+}
+
+// gain reduction comes from the shared compressor, levels from every channel
+static void px_linked_set_meter(px_linked_compressor* linked, px_meter* meter)
+{
+	assert(linked);
+	px_compressor_mono_set_meter(&linked->compressor, meter);
+}
+
+static px_mono_compressor* px_linked_get_compressor(px_linked_compressor* linked)
+{
+	assert(linked);
+	return &linked->compressor;
+}
+
+static int px_linked_latency_samples(const px_linked_compressor* linked)
+{
+	assert(linked);
+	return 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// vectorized over samples, one pass per channel
+static void px_linked_compute_link(const px_linked_compressor* linked, SAMPLE_TYPE** channels, int offset, SAMPLE_TYPE* level, int num_samples)
+{
+	memset(level, 0, sizeof(SAMPLE_TYPE) * num_samples);
+
+	for (int channel = 0; channel < linked->num_channels; ++channel)
+	{
+		const SAMPLE_TYPE* input = channels[channel] + offset;
+		const SAMPLE_TYPE weight = linked->weights[channel];
+		const px_simd weights = px_simd_set1(weight);
+
+		int i = 0;
+		if (linked->link == LINK_MAX)
+		{
+			for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+				px_simd_store(level + i, px_simd_max(px_simd_load(level + i), px_simd_mul(px_simd_abs(px_simd_load(input + i)), weights)));
+			for (; i < num_samples; ++i)
+				level[i] = px_fmax(level[i], px_fabs(input[i]) * weight);
+		}
+		else
+		{
+			for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+				px_simd_store(level + i, px_simd_mul_add(px_simd_abs(px_simd_load(input + i)), weights, px_simd_load(level + i)));
+			for (; i < num_samples; ++i)
+				level[i] += px_fabs(input[i]) * weight;
+		}
+	}
+}
+
+static void px_linked_apply_gain(SAMPLE_TYPE* buffer, const SAMPLE_TYPE* gain, SAMPLE_TYPE trim, int num_samples)
+{
+	const px_simd trims = px_simd_set1(trim);
+
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+		px_simd_store(buffer + i, px_simd_mul(px_simd_load(buffer + i), px_simd_mul(px_simd_load(gain + i), trims)));
+	for (; i < num_samples; ++i)
+		buffer[i] *= gain[i] * trim;
+}
+
+#endif
@@ -0,0 +1,228 @@
+#include "px_globals.h"
+#include "px_simd.h"
+#include "px_memory.h"
+
+#ifndef PX_METER_H
+#define PX_METER_H
+
+/*
+	px_meter.h
+
+	level and gain reduction meter, written by the audio thread and read from any other thread without locks.
+
+	the audio thread accumulates peak, mean square and gain min/max and publishes a reading every
+	interval samples through a triple buffer: it fills the back slot, then swaps it with the shared
+	middle slot in one atomic exchange. the reader swaps the middle slot with its front slot only if
+	a new reading is waiting. neither side ever blocks or waits for the other. a reader that polls
+	slower than the publish rate just gets the newest reading.
+
+	between publishes the audio thread only runs a compare, a max and a multiply-add per sample, with
+	no atomics. processors meter only when a meter is attached.
+
+	init:
+		px_meter meter;
+		px_meter_initialize(&meter, 1024);		// publish every 1024 samples, 0 = every process call
+
+		px_compressor_mono_set_meter(&compressor, &meter);	// also equalizer, limiter and px_linked setters
+		px_compressor_mono_set_meter(&compressor, NULL);	// detach
+
+	read (any thread):
+		px_meter_reading reading;
+		if (px_meter_read(&meter, &reading))
+			draw(reading.peak, reading.rms, reading.gain_reduction_max);
+*/
+
+#define PX_METER_FRESH 4	// set on the shared slot index when it holds a reading the reader hasn't taken
+
+typedef struct
+{
+	float peak;			// dBFS, output
+	float rms;			// dBFS, output
+	float gain_reduction_min;	// dB, least reduction over the interval, 0 = none
+	float gain_reduction_max;	// dB, most reduction over the interval
+	unsigned int sequence;		// publish count, a reader can spot a stalled stream
+} px_meter_reading;
+
+typedef struct
+{
+	px_meter_reading slots[3];
+	px_atomic_int middle;	// slot index | PX_METER_FRESH
+	int back;		// audio thread
+	int front;		// reader
+
+	// audio thread only
+	int interval;		// samples per reading
+	int frames;
+	int count;		// squares summed, frames * channels
+	SAMPLE_TYPE peak;
+	double sum;
+	SAMPLE_TYPE gain_min;
+	SAMPLE_TYPE gain_max;
+	unsigned int sequence;
+} px_meter;
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_meter* px_meter_create(int interval);
+static void px_meter_destroy(px_meter* meter);
+static void px_meter_initialize(px_meter* meter, int interval);
+static void px_meter_set_interval(px_meter* meter, int interval);
+
+// reader
+static bool px_meter_read(px_meter* meter, px_meter_reading* reading);	// true if the reading is new
+
+// audio thread
+static inline void px_meter_level(px_meter* meter, SAMPLE_TYPE output);
+static inline void px_meter_gain(px_meter* meter, SAMPLE_TYPE gain);	// linear, 1 = no reduction
+static void px_meter_level_block(px_meter* meter, const SAMPLE_TYPE* output, int num_samples);
+static void px_meter_gain_block(px_meter* meter, const SAMPLE_TYPE* gain, int num_samples);
+static inline void px_meter_advance(px_meter* meter, int num_frames);	// publishes once interval frames are in
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_meter_clear(px_meter* meter);
+static void px_meter_publish(px_meter* meter);
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_meter* px_meter_create(int interval)
+{
+	px_meter* meter = (px_meter*)px_malloc(sizeof(px_meter));
+	if (meter)
+		px_meter_initialize(meter, interval);
+	return meter;
+}
+
+static void px_meter_destroy(px_meter* meter)
+{
+	if (meter)
+		px_free(meter);
+}
+
+static void px_meter_initialize(px_meter* meter, int interval)
+{
+	assert(meter);
+	memset(meter->slots, 0, sizeof(meter->slots));
+	px_atomic_init(&meter->middle, 1);
+	meter->back = 0;
+	meter->front = 2;
+
+	meter->interval = (interval > 0) ? interval : 0;
+	meter->sequence = 0;
+	px_meter_clear(meter);
+}
+
+static void px_meter_set_interval(px_meter* meter, int interval)
+{
+	assert(meter);
+	meter->interval = (interval > 0) ? interval : 0;
+}
+
+static bool px_meter_read(px_meter* meter, px_meter_reading* reading)
+{
+	px_assert(meter, reading);
+
+	bool fresh = (px_atomic_load(&meter->middle) & PX_METER_FRESH) != 0;
+	if (fresh)
+		meter->front = px_atomic_exchange(&meter->middle, meter->front) & ~PX_METER_FRESH;
+
+	*reading = meter->slots[meter->front];
+	return fresh;
+}
+
+static inline void px_meter_level(px_meter* meter, SAMPLE_TYPE output)
+{
+	meter->peak = px_fmax(meter->peak, px_fabs(output));
+	meter->sum += output * output;
+	meter->count++;
+}
+
+static inline void px_meter_gain(px_meter* meter, SAMPLE_TYPE gain)
+{
+	meter->gain_min = px_fmin(meter->gain_min, gain);
+	meter->gain_max = px_fmax(meter->gain_max, gain);
+}
+
+static void px_meter_level_block(px_meter* meter, const SAMPLE_TYPE* output, int num_samples)
+{
+	px_assert(meter, output);
+
+	px_simd peaks = px_simd_set1(0.f);
+	px_simd squares = px_simd_set1(0.f);
+
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+	{
+		px_simd x = px_simd_load(output + i);
+		peaks = px_simd_max(peaks, px_simd_abs(x));
+		squares = px_simd_mul_add(x, x, squares);
+	}
+
+	SAMPLE_TYPE lanes[2][PX_SIMD_WIDTH];
+	px_simd_store(lanes[0], peaks);
+	px_simd_store(lanes[1], squares);
+
+	SAMPLE_TYPE peak = meter->peak;
+	double sum = 0.0;
+	for (int lane = 0; lane < PX_SIMD_WIDTH; ++lane)
+	{
+		peak = px_fmax(peak, lanes[0][lane]);
+		sum += lanes[1][lane];
+	}
+	for (; i < num_samples; ++i)
+	{
+		peak = px_fmax(peak, px_fabs(output[i]));
+		sum += output[i] * output[i];
+	}
+
+	meter->peak = peak;
+	meter->sum += sum;
+	meter->count += num_samples;
+}
+
+static void px_meter_gain_block(px_meter* meter, const SAMPLE_TYPE* gain, int num_samples)
+{
+	px_assert(meter, gain);
+	for (int i = 0; i < num_samples; ++i)
+		px_meter_gain(meter, gain[i]);
+}
+
+static inline void px_meter_advance(px_meter* meter, int num_frames)
+{
+	meter->frames += num_frames;
+	if (meter->frames >= meter->interval)
+		px_meter_publish(meter);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_meter_clear(px_meter* meter)
+{
+	meter->frames = 0;
+	meter->count = 0;
+	meter->peak = 0.f;
+	meter->sum = 0.0;
+	meter->gain_min = 1.f;
+	meter->gain_max = -1.f;	// no gain seen yet
+}
+
+// dB conversions only happen here, once per reading
+static void px_meter_publish(px_meter* meter)
+{
+	px_meter_reading* reading = &meter->slots[meter->back];
+
+	double mean = (meter->count > 0) ? meter->sum / (double)meter->count : 0.0;
+	reading->peak = lin2dB((float)meter->peak + (float)DC_OFFSET);
+	reading->rms = lin2dB((float)sqrt(mean) + (float)DC_OFFSET);
+
+	// gain above unity isn't reduction, a meter with no gain source reads 0
+	SAMPLE_TYPE gain_max = (meter->gain_max < 0.f) ? 1.f : px_fmin(meter->gain_max, 1.f);
+	reading->gain_reduction_min = 0.f - lin2dB((float)gain_max);
+	reading->gain_reduction_max = 0.f - lin2dB((float)meter->gain_min);
+	reading->sequence = ++meter->sequence;
+
+	meter->back = px_atomic_exchange(&meter->middle, meter->back | PX_METER_FRESH) & ~PX_METER_FRESH;
+	px_meter_clear(meter);
+}
+
+#endif
@@ -0,0 +1,530 @@
+#include "px_globals.h"
+#include "px_simd.h"
+#include "px_filter_design.h"
+#include "px_compressor.h"
+#include "px_profile.h"
+
+#ifndef PX_MULTIBAND_H
+#define PX_MULTIBAND_H
+
+/*
+	px_multiband.h
+
+	multiband compressor, up to PX_MULTIBAND_MAX_BANDS bands split by linkwitz-riley crossovers.
+	every band is a px_mono_compressor, so parameters, setters, smoothing and envelope detector
+	coefficients are the single-band ones
+
+	crossovers
+		LR4 (default) or LR8 from px_filter_design. the split is a tree: band 0 is the low-pass of
+		crossover 0, the high-pass carries on into crossover 1 and so on. every band also runs through
+		the allpass of each crossover above it, so all bands share one phase response and sum back to
+		an allpass (flat magnitude) with the compressors at unity.
+
+	detector
+		each band's px_mono_compressor detector (px_compressor_mono_set_detector) runs on its band signal,
+		the stereo version feeds it max(|left|, |right|)
+
+	gain computer
+		the bands sit in px_compressor_lanes, one band per lane, so the log2-domain gain kernel runs
+		once per sample for all bands (4 bands per pass on SSE/NEON, 8 on AVX, 16 on AVX-512).
+		the transfer is the px_compressor_compress one (ratio and knee, set_curve shapes are not read here).
+		band parameters are read every PX_MULTIBAND_CHUNK samples, smoothing glides at that rate.
+
+	init:
+		px_mono_multiband multiband;
+		px_multiband_mono_initialize(&multiband, sample_rate, 4);	// 4 bands
+
+		px_multiband_mono_set_crossover(&multiband, 0, 150.f);		// num_bands - 1 crossovers, ascending
+		px_multiband_mono_set_order(&multiband, 8);			// 4 or 8
+
+		// bands are plain compressors
+		px_compressor_mono_set_threshold(px_multiband_mono_get_band(&multiband, 0), -24.f);
+		px_compressor_mono_set_ratio(px_multiband_mono_get_band(&multiband, 0), 4.f);
+
+	use:
+		px_multiband_mono_process_block(&multiband, buffer, num_samples);
+		px_multiband_stereo_process_block(&stereo_multiband, left, right, num_samples);	// detectors linked per band
+*/
+
+#define PX_MULTIBAND_MAX_BANDS 6
+#define PX_MULTIBAND_LANES (((PX_MULTIBAND_MAX_BANDS + PX_SIMD_WIDTH - 1) / PX_SIMD_WIDTH) * PX_SIMD_WIDTH)
+#define PX_MULTIBAND_CHUNK 64	// samples per crossover pass and parameter update
+
+// one channel of the band split
+typedef struct
+{
+	px_sos_cascade lowpass[PX_MULTIBAND_MAX_BANDS - 1];
+	px_sos_cascade highpass[PX_MULTIBAND_MAX_BANDS - 1];
+	px_sos_cascade allpass[PX_MULTIBAND_MAX_BANDS];		// phase compensation, per band
+} px_multiband_crossover;
+
+#define PX_MULTIBAND_GROUPS (PX_MULTIBAND_LANES / PX_COMPRESSOR_LANES)
+
+// band gain computers, band n in lane n % PX_COMPRESSOR_LANES of group n / PX_COMPRESSOR_LANES
+typedef struct
+{
+	px_compressor_lanes groups[PX_MULTIBAND_GROUPS];
+} px_multiband_lanes;
+
+typedef struct
+{
+	float sample_rate;
+	int num_bands;
+	int order;
+	float crossover_frequencies[PX_MULTIBAND_MAX_BANDS - 1];
+
+	px_mono_compressor bands[PX_MULTIBAND_MAX_BANDS];
+	px_multiband_lanes lanes;
+	px_multiband_crossover crossover;
+} px_mono_multiband;
+
+typedef struct
+{
+	float sample_rate;
+	int num_bands;
+	int order;
+	float crossover_frequencies[PX_MULTIBAND_MAX_BANDS - 1];
+
+	px_mono_compressor bands[PX_MULTIBAND_MAX_BANDS];
+	px_multiband_lanes lanes;
+	px_multiband_crossover left;
+	px_multiband_crossover right;
+} px_stereo_multiband;
+
+// ----------------------------------------------------------------------------------------------------
+
+static px_mono_multiband* px_multiband_mono_create(float sample_rate, int num_bands);
+static void px_multiband_mono_destroy(px_mono_multiband* multiband);
+
+static px_stereo_multiband* px_multiband_stereo_create(float sample_rate, int num_bands);
+static void px_multiband_stereo_destroy(px_stereo_multiband* multiband);
+
+// mono
+
+static void px_multiband_mono_initialize(px_mono_multiband* multiband, float sample_rate, int num_bands);
+static void px_multiband_mono_process(px_mono_multiband* multiband, SAMPLE_TYPE* input);
+static void px_multiband_mono_process_block(px_mono_multiband* multiband, SAMPLE_TYPE* input, int num_samples);
+
+static void px_multiband_mono_set_num_bands(px_mono_multiband* multiband, int num_bands);
+static void px_multiband_mono_set_crossover(px_mono_multiband* multiband, int index, float frequency);
+static void px_multiband_mono_set_order(px_mono_multiband* multiband, int order);
+static px_mono_compressor* px_multiband_mono_get_band(px_mono_multiband* multiband, int index);
+static int px_multiband_mono_latency_samples(const px_mono_multiband* multiband);	// 0
+
+// stereo
+
+static void px_multiband_stereo_initialize(px_stereo_multiband* multiband, float sample_rate, int num_bands);
+static void px_multiband_stereo_process(px_stereo_multiband* multiband, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right);
+static void px_multiband_stereo_process_block(px_stereo_multiband* multiband, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples);
+
+static void px_multiband_stereo_set_num_bands(px_stereo_multiband* multiband, int num_bands);
+static void px_multiband_stereo_set_crossover(px_stereo_multiband* multiband, int index, float frequency);
+static void px_multiband_stereo_set_order(px_stereo_multiband* multiband, int order);
+static px_mono_compressor* px_multiband_stereo_get_band(px_stereo_multiband* multiband, int index);
+static int px_multiband_stereo_latency_samples(const px_stereo_multiband* multiband);
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_multiband_swap_cascade(px_sos_cascade* cascade, const px_sos_cascade* designed);
+static void px_multiband_append_allpass(px_sos_cascade* cascade, int order, float sample_rate, float frequency);
+static void px_multiband_crossover_design(px_multiband_crossover* crossover, int num_bands, int order, float sample_rate, const float* frequencies);
+static void px_multiband_crossover_split(px_multiband_crossover* crossover, int num_bands, const SAMPLE_TYPE* input, SAMPLE_TYPE bands[][PX_MULTIBAND_CHUNK], int num_samples);
+static void px_multiband_lanes_initialize(px_multiband_lanes* lanes);
+static void px_multiband_lanes_update(px_multiband_lanes* lanes, px_mono_compressor* bands, int num_samples);
+
+static void px_multiband_compute_gains(px_multiband_lanes* lanes, int num_bands, SAMPLE_TYPE levels[][PX_MULTIBAND_CHUNK], int num_samples);
+
+// ----------------------------------------------------------------------------------------------------
+
+static const float px_multiband_default_crossovers[PX_MULTIBAND_MAX_BANDS - 1] = { 120.f, 500.f, 2000.f, 6000.f, 12000.f };
+
+static px_mono_multiband* px_multiband_mono_create(float sample_rate, int num_bands)
+{
+	px_mono_multiband* multiband = (px_mono_multiband*)px_malloc(sizeof(px_mono_multiband));
+	if (multiband)
+		px_multiband_mono_initialize(multiband, sample_rate, num_bands);
+	return multiband;
+}
+
+static void px_multiband_mono_destroy(px_mono_multiband* multiband)
+{
+	if (multiband)
+	{
+		for (int band = 0; band < PX_MULTIBAND_MAX_BANDS; ++band)
+			px_compressor_mono_free_detector(&multiband->bands[band]);
+		px_free(multiband);
+	}
+}
+
+static px_stereo_multiband* px_multiband_stereo_create(float sample_rate, int num_bands)
+{
+	px_stereo_multiband* multiband = (px_stereo_multiband*)px_malloc(sizeof(px_stereo_multiband));
+	if (multiband)
+		px_multiband_stereo_initialize(multiband, sample_rate, num_bands);
+	return multiband;
+}
+
+static void px_multiband_stereo_destroy(px_stereo_multiband* multiband)
+{
+	if (multiband)
+	{
+		for (int band = 0; band < PX_MULTIBAND_MAX_BANDS; ++band)
+			px_compressor_mono_free_detector(&multiband->bands[band]);
+		px_free(multiband);
+	}
+}
+
+static void px_multiband_mono_initialize(px_mono_multiband* multiband, float sample_rate, int num_bands)
+{
+	assert(multiband);
+	assert(num_bands >= 1 && num_bands <= PX_MULTIBAND_MAX_BANDS);
+
+	multiband->sample_rate = sample_rate;
+	multiband->num_bands = num_bands;
+	multiband->order = 4;
+	for (int i = 0; i < PX_MULTIBAND_MAX_BANDS - 1; ++i)
+		multiband->crossover_frequencies[i] = px_fmin(px_multiband_default_crossovers[i], 0.45f * sample_rate);
+
+	for (int band = 0; band < PX_MULTIBAND_MAX_BANDS; ++band)
+		px_compressor_mono_initialize(&multiband->bands[band], sample_rate);
+
+	px_multiband_lanes_initialize(&multiband->lanes);
+	memset(&multiband->crossover, 0, sizeof(px_multiband_crossover));
+	px_multiband_crossover_design(&multiband->crossover, num_bands, multiband->order, sample_rate, multiband->crossover_frequencies);
+}
+
+static void px_multiband_stereo_initialize(px_stereo_multiband* multiband, float sample_rate, int num_bands)
+{
+	assert(multiband);
+	assert(num_bands >= 1 && num_bands <= PX_MULTIBAND_MAX_BANDS);
+
+	multiband->sample_rate = sample_rate;
+	multiband->num_bands = num_bands;
+	multiband->order = 4;
+	for (int i = 0; i < PX_MULTIBAND_MAX_BANDS - 1; ++i)
+		multiband->crossover_frequencies[i] = px_fmin(px_multiband_default_crossovers[i], 0.45f * sample_rate);
+
+	for (int band = 0; band < PX_MULTIBAND_MAX_BANDS; ++band)
+		px_compressor_mono_initialize(&multiband->bands[band], sample_rate);
+
+	px_multiband_lanes_initialize(&multiband->lanes);
+	memset(&multiband->left, 0, sizeof(px_multiband_crossover));
+	memset(&multiband->right, 0, sizeof(px_multiband_crossover));
+	px_multiband_crossover_design(&multiband->left, num_bands, multiband->order, sample_rate, multiband->crossover_frequencies);
+	px_multiband_crossover_design(&multiband->right, num_bands, multiband->order, sample_rate, multiband->crossover_frequencies);
+}
+
+static void px_multiband_mono_process(px_mono_multiband* multiband, SAMPLE_TYPE* input)
+{
+	px_multiband_mono_process_block(multiband, input, 1);
+}
+
+static void px_multiband_stereo_process(px_stereo_multiband* multiband, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right)
+{
+	px_multiband_stereo_process_block(multiband, input_left, input_right, 1);
+}
+
+static void px_multiband_mono_process_block(px_mono_multiband* multiband, SAMPLE_TYPE* input, int num_samples)
+{
+	px_assert(multiband, input);
+	PX_PROFILE_BEGIN("px_mono_multiband", multiband);
+	px_fp_mode mode = px_denormals_disable();
+
+	const int num_bands = multiband->num_bands;
+	SAMPLE_TYPE bands[PX_MULTIBAND_MAX_BANDS][PX_MULTIBAND_CHUNK];
+	SAMPLE_TYPE gain[PX_MULTIBAND_MAX_BANDS][PX_MULTIBAND_CHUNK];
+
+	for (int offset = 0; offset < num_samples; offset += PX_MULTIBAND_CHUNK)
+	{
+		int chunk = (num_samples - offset < PX_MULTIBAND_CHUNK) ? num_samples - offset : PX_MULTIBAND_CHUNK;
+
+		px_multiband_lanes_update(&multiband->lanes, multiband->bands, chunk);
+		px_multiband_crossover_split(&multiband->crossover, num_bands, input + offset, bands, chunk);
+
+		for (int band = 0; band < num_bands; ++band)
+			px_level_detector_process_block(&multiband->bands[band].detector, bands[band], gain[band], chunk);
+
+		px_multiband_compute_gains(&multiband->lanes, num_bands, gain, chunk);
+
+		for (int i = 0; i < chunk; ++i)
+		{
+			SAMPLE_TYPE sum = 0.f;
+			for (int band = 0; band < num_bands; ++band)
+				sum += bands[band][i] * gain[band][i];
+			input[offset + i] = sum;
+		}
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+static void px_multiband_stereo_process_block(px_stereo_multiband* multiband, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples)
+{
+	px_assert(multiband, input_left, input_right);
+	PX_PROFILE_BEGIN("px_stereo_multiband", multiband);
+	px_fp_mode mode = px_denormals_disable();
+
+	const int num_bands = multiband->num_bands;
+	SAMPLE_TYPE left[PX_MULTIBAND_MAX_BANDS][PX_MULTIBAND_CHUNK];
+	SAMPLE_TYPE right[PX_MULTIBAND_MAX_BANDS][PX_MULTIBAND_CHUNK];
+	SAMPLE_TYPE gain[PX_MULTIBAND_MAX_BANDS][PX_MULTIBAND_CHUNK];
+
+	for (int offset = 0; offset < num_samples; offset += PX_MULTIBAND_CHUNK)
+	{
+		int chunk = (num_samples - offset < PX_MULTIBAND_CHUNK) ? num_samples - offset : PX_MULTIBAND_CHUNK;
+
+		px_multiband_lanes_update(&multiband->lanes, multiband->bands, chunk);
+		px_multiband_crossover_split(&multiband->left, num_bands, input_left + offset, left, chunk);
+		px_multiband_crossover_split(&multiband->right, num_bands, input_right + offset, right, chunk);
+
+		// linked, both channels of a band take the louder one's gain
+		for (int band = 0; band < num_bands; ++band)
+		{
+			for (int i = 0; i < chunk; ++i)
+				gain[band][i] = px_fmax(px_fabs(left[band][i]), px_fabs(right[band][i]));
+			px_level_detector_process_block(&multiband->bands[band].detector, gain[band], gain[band], chunk);
+		}
+
+		px_multiband_compute_gains(&multiband->lanes, num_bands, gain, chunk);
+
+		for (int i = 0; i < chunk; ++i)
+		{
+			SAMPLE_TYPE sum_left = 0.f;
+			SAMPLE_TYPE sum_right = 0.f;
+			for (int band = 0; band < num_bands; ++band)
+			{
+				sum_left += left[band][i] * gain[band][i];
+				sum_right += right[band][i] * gain[band][i];
+			}
+			input_left[offset + i] = sum_left;
+			input_right[offset + i] = sum_right;
+		}
+	}
+	px_denormals_restore(mode);
+	PX_PROFILE_END(num_samples);
+}
+
+static void px_multiband_mono_set_num_bands(px_mono_multiband* multiband, int num_bands)
+{
+	assert(multiband);
+	assert(num_bands >= 1 && num_bands <= PX_MULTIBAND_MAX_BANDS);
+	multiband->num_bands = num_bands;
+	px_multiband_crossover_design(&multiband->crossover, num_bands, multiband->order, multiband->sample_rate, multiband->crossover_frequencies);
+}
+
+static void px_multiband_stereo_set_num_bands(px_stereo_multiband* multiband, int num_bands)
+{
+	assert(multiband);
+	assert(num_bands >= 1 && num_bands <= PX_MULTIBAND_MAX_BANDS);
+	multiband->num_bands = num_bands;
+	px_multiband_crossover_design(&multiband->left, num_bands, multiband->order, multiband->sample_rate, multiband->crossover_frequencies);
+	px_multiband_crossover_design(&multiband->right, num_bands, multiband->order, multiband->sample_rate, multiband->crossover_frequencies);
+}
+
+static void px_multiband_mono_set_crossover(px_mono_multiband* multiband, int index, float frequency)
+{
+	assert(multiband);
+	assert(index >= 0 && index < PX_MULTIBAND_MAX_BANDS - 1);
+	multiband->crossover_frequencies[index] = px_fmin(frequency, 0.45f * multiband->sample_rate);
+	px_multiband_crossover_design(&multiband->crossover, multiband->num_bands, multiband->order, multiband->sample_rate, multiband->crossover_frequencies);
+}
+
+static void px_multiband_stereo_set_crossover(px_stereo_multiband* multiband, int index, float frequency)
+{
+	assert(multiband);
+	assert(index >= 0 && index < PX_MULTIBAND_MAX_BANDS - 1);
+	multiband->crossover_frequencies[index] = px_fmin(frequency, 0.45f * multiband->sample_rate);
+	px_multiband_crossover_design(&multiband->left, multiband->num_bands, multiband->order, multiband->sample_rate, multiband->crossover_frequencies);
+	px_multiband_crossover_design(&multiband->right, multiband->num_bands, multiband->order, multiband->sample_rate, multiband->crossover_frequencies);
+}
+
+static void px_multiband_mono_set_order(px_mono_multiband* multiband, int order)
+{
+	assert(multiband);
+	if (order != 4 && order != 8)
+	{
+		printf("Invalid crossover order, use 4 or 8");
+		return;
+	}
+	multiband->order = order;
+	px_multiband_crossover_design(&multiband->crossover, multiband->num_bands, order, multiband->sample_rate, multiband->crossover_frequencies);
+}
+
+static void px_multiband_stereo_set_order(px_stereo_multiband* multiband, int order)
+{
+	assert(multiband);
+	if (order != 4 && order != 8)
+	{
+		printf("Invalid crossover order, use 4 or 8");
+		return;
+	}
+	multiband->order = order;
+	px_multiband_crossover_design(&multiband->left, multiband->num_bands, order, multiband->sample_rate, multiband->crossover_frequencies);
+	px_multiband_crossover_design(&multiband->right, multiband->num_bands, order, multiband->sample_rate, multiband->crossover_frequencies);
+}
+
+static px_mono_compressor* px_multiband_mono_get_band(px_mono_multiband* multiband, int index)
+{
+	assert(multiband);
+	assert(index >= 0 && index < PX_MULTIBAND_MAX_BANDS);
+	return &multiband->bands[index];
+}
+
+static px_mono_compressor* px_multiband_stereo_get_band(px_stereo_multiband* multiband, int index)
+{
+	assert(multiband);
+	assert(index >= 0 && index < PX_MULTIBAND_MAX_BANDS);
+	return &multiband->bands[index];
+}
+
+// linkwitz-riley bands sum to an allpass: phase shift, no delay to compensate
+static int px_multiband_mono_latency_samples(const px_mono_multiband* multiband)
+{
+	assert(multiband);
+	return 0;
+}
+
+static int px_multiband_stereo_latency_samples(const px_stereo_multiband* multiband)
+{
+	assert(multiband);
+	return 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// swaps in new coefficients, keeps the filter state when the section count is unchanged so a
+// crossover can move while audio runs
+static void px_multiband_swap_cascade(px_sos_cascade* cascade, const px_sos_cascade* designed)
+{
+	int num_sections = cascade->num_sections;
+	memcpy(cascade->sos, designed->sos, sizeof(cascade->sos));
+	cascade->num_sections = designed->num_sections;
+	if (num_sections != designed->num_sections)
+		px_sos_cascade_reset(cascade);
+}
+
+// LR low + high of one crossover is the allpass of its butterworth(order / 2) half,
+// one biquad allpass per butterworth pole pair at the same frequency
+static void px_multiband_append_allpass(px_sos_cascade* cascade, int order, float sample_rate, float frequency)
+{
+	int half = order / 2;
+	for (int k = 0; k < half / 2; ++k)
+	{
+		float quality = (float)(1.0 / (2.0 * sin(PI * (2.0 * k + 1.0) / (2.0 * half))));
+		px_biquad_parameters parameters = { sample_rate, frequency, quality, 0.f, BIQUAD_ALLPASS, false, BIQUAD_DIRECT_FORM };
+		px_biquad_coefficients coefficients = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+		px_biquad_update_coefficients(parameters, &coefficients);
+
+		SAMPLE_TYPE* c = cascade->sos + cascade->num_sections * PX_SOS_STRIDE;
+		c[0] = coefficients.a0;
+		c[1] = coefficients.a1;
+		c[2] = coefficients.a2;
+		c[3] = coefficients.b1;
+		c[4] = coefficients.b2;
+		cascade->num_sections++;
+	}
+}
+
+static void px_multiband_crossover_design(px_multiband_crossover* crossover, int num_bands, int order, float sample_rate, const float* frequencies)
+{
+	assert(crossover && frequencies);
+	px_sos_cascade designed;
+
+	for (int k = 0; k < PX_MULTIBAND_MAX_BANDS - 1; ++k)
+	{
+		if (k < num_bands - 1)
+		{
+			px_filter_specification lowpass = PX_FILTER_SPECIFICATION(FILTER_LINKWITZ_RILEY, BIQUAD_LOWPASS, order, sample_rate, frequencies[k]);
+			px_filter_design(lowpass, &designed);
+			px_multiband_swap_cascade(&crossover->lowpass[k], &designed);
+
+			px_filter_specification highpass = PX_FILTER_SPECIFICATION(FILTER_LINKWITZ_RILEY, BIQUAD_HIGHPASS, order, sample_rate, frequencies[k]);
+			px_filter_design(highpass, &designed);
+			px_multiband_swap_cascade(&crossover->highpass[k], &designed);
+		}
+		else
+		{
+			crossover->lowpass[k].num_sections = 0;
+			crossover->highpass[k].num_sections = 0;
+		}
+	}
+
+	// band k sees crossovers 0..k directly, the ones above it only through compensation
+	for (int band = 0; band < PX_MULTIBAND_MAX_BANDS; ++band)
+	{
+		designed.num_sections = 0;
+		for (int k = band + 1; k < num_bands - 1; ++k)
+			px_multiband_append_allpass(&designed, order, sample_rate, frequencies[k]);
+		px_multiband_swap_cascade(&crossover->allpass[band], &designed);
+	}
+}
+
+static void px_multiband_crossover_split(px_multiband_crossover* crossover, int num_bands, const SAMPLE_TYPE* input, SAMPLE_TYPE bands[][PX_MULTIBAND_CHUNK], int num_samples)
+{
+	// the top band doubles as the running high-pass
+	SAMPLE_TYPE* rest = bands[num_bands - 1];
+	memcpy(rest, input, num_samples * sizeof(SAMPLE_TYPE));
+
+	for (int k = 0; k < num_bands - 1; ++k)
+	{
+		memcpy(bands[k], rest, num_samples * sizeof(SAMPLE_TYPE));
+		px_sos_cascade_process_block(&crossover->lowpass[k], bands[k], num_samples);
+		px_sos_cascade_process_block(&crossover->highpass[k], rest, num_samples);
+	}
+
+	for (int band = 0; band < num_bands - 2; ++band)
+		px_sos_cascade_process_block(&crossover->allpass[band], bands[band], num_samples);
+}
+
+static void px_multiband_lanes_initialize(px_multiband_lanes* lanes)
+{
+	assert(lanes);
+	// padding lanes compute a harmless unity gain
+	for (int group = 0; group < PX_MULTIBAND_GROUPS; ++group)
+		px_compressor_lanes_initialize(&lanes->groups[group]);
+}
+
+// gathers the band compressors' parameters into lanes, advancing their smoothers by num_samples
+static void px_multiband_lanes_update(px_multiband_lanes* lanes, px_mono_compressor* bands, int num_samples)
+{
+	assert(lanes && bands);
+	for (int band = 0; band < PX_MULTIBAND_MAX_BANDS; ++band)
+	{
+		px_mono_compressor* compressor = &bands[band];
+		if (px_compressor_is_smoothing(compressor))
+		{
+			compressor->parameters.threshold = px_smoother_skip(&compressor->smoothing.threshold, num_samples);
+			compressor->parameters.ratio = px_smoother_skip(&compressor->smoothing.ratio, num_samples);
+			compressor->parameters.makeup_gain = px_smoother_skip(&compressor->smoothing.makeup_gain, num_samples);
+		}
+
+		px_compressor_lanes_set(&lanes->groups[band / PX_COMPRESSOR_LANES], band % PX_COMPRESSOR_LANES, compressor);
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// detector levels in, band gains out, through the lanes' [sample][lane] layout
+static void px_multiband_compute_gains(px_multiband_lanes* lanes, int num_bands, SAMPLE_TYPE levels[][PX_MULTIBAND_CHUNK], int num_samples)
+{
+	SAMPLE_TYPE interleaved[PX_MULTIBAND_CHUNK * PX_COMPRESSOR_LANES];
+
+	for (int group = 0; group * PX_COMPRESSOR_LANES < num_bands; ++group)
+	{
+		const int first = group * PX_COMPRESSOR_LANES;
+		const int count = (num_bands - first < PX_COMPRESSOR_LANES) ? num_bands - first : PX_COMPRESSOR_LANES;
+
+		memset(interleaved, 0, sizeof(SAMPLE_TYPE) * PX_COMPRESSOR_LANES * num_samples);
+		for (int lane = 0; lane < count; ++lane)
+			for (int i = 0; i < num_samples; ++i)
+				interleaved[i * PX_COMPRESSOR_LANES + lane] = levels[first + lane][i];
+
+		px_compressor_lanes_process(&lanes->groups[group], interleaved, interleaved, num_samples);
+
+		for (int lane = 0; lane < count; ++lane)
+			for (int i = 0; i < num_samples; ++i)
+				levels[first + lane][i] = interleaved[i * PX_COMPRESSOR_LANES + lane];
+	}
+}
+
+#endif
@@ -0,0 +1,579 @@
+#include "px_globals.h"
+#include "px_memory.h"
+
+#ifndef PX_PROFILE_H
+#define PX_PROFILE_H
+
+/*
+	px_profile.h
+
+	hot-path profiling of the block entry points, off unless PX_PROFILE is defined before the
+	first include. without it PX_PROFILE_BEGIN / PX_PROFILE_END expand to nothing, the snapshot
+	and trace calls are empty stubs, nothing is linked or allocated.
+
+	every block entry point (biquad, sos cascade, equalizer, saturator, clipper, compressor,
+	multiband, limiter, linked, delay, batch, graph, executor) opens a zone on entry and closes it
+	on every return. a zone is keyed by instance and name (the processor's type), so the left and
+	right equalizer of a stereo pair or two limiters in a chain show up apart, and nested calls
+	(an equalizer running its bands, a graph running its nodes) each get their own.
+
+	cost
+		two timestamp reads (rdtsc on x86, cntvct_el0 on arm64, the monotonic clock elsewhere),
+		a probe into the thread's zone table and a histogram increment per block call. no locks,
+		no read-modify-write atomics (the counts are relaxed loads and stores under the zone's
+		sequence number), no allocation after the first zone on a thread
+		(px_profile_thread_begin() does that one up front, px_executor's workers call it)
+
+	per thread
+		each thread writes only its own tables: min / max / total cycles and a log histogram
+		(PX_PROFILE_SUBBUCKETS per octave, ~9% wide) per zone, plus a ring of the last
+		PX_PROFILE_TRACE_EVENTS calls. readers copy a zone under its sequence number and retry if
+		the owner was mid-update, the owner never waits. a processor that moves between threads
+		(px_executor) is merged across them in the snapshot.
+
+	state lives in the translation unit, like the rest of the library's statics: profile and
+	snapshot from the same one.
+
+	use:
+		#define PX_PROFILE
+		#include "px_audio.h"
+
+		// any thread, polling
+		px_profile_stats stats[64];
+		int count = px_profile_snapshot(stats, 64);
+		for (int i = 0; i < count; ++i)
+			printf("%s %p  avg %.0f  p99 %.0f  max %.0f cycles\n", stats[i].name, stats[i].instance,
+				stats[i].avg, stats[i].p99, stats[i].max);
+
+		px_profile_write_trace("trace.json");	// chrome://tracing or ui.perfetto.dev
+		px_profile_reset();				// each thread clears at its next zone
+
+	own code:
+		PX_PROFILE_BEGIN("reverb", &reverb);
+		...
+		PX_PROFILE_END(num_samples);	// before every return, one pair per scope
+*/
+
+#ifndef PX_PROFILE_MAX_THREADS
+	#define PX_PROFILE_MAX_THREADS 32
+#endif
+#ifndef PX_PROFILE_MAX_ZONES
+	#define PX_PROFILE_MAX_ZONES 256		// per thread, power of two
+#endif
+#ifndef PX_PROFILE_TRACE_EVENTS
+	#define PX_PROFILE_TRACE_EVENTS 16384	// per thread, power of two
+#endif
+#define PX_PROFILE_SUBBUCKETS 8			// per octave
+#define PX_PROFILE_BUCKETS 256			// up to ~2^33 cycles, the last bucket holds the rest
+
+typedef struct
+{
+	const void* instance;
+	const char* name;
+	unsigned long long count;		// calls
+	unsigned long long samples;		// summed num_samples
+	double min;				// cycles per call
+	double avg;
+	double max;
+	double p99;				// histogram bucket, within ~9%
+	double cycles_per_sample;		// avg / samples per call
+} px_profile_stats;
+
+#ifdef PX_PROFILE
+
+#if defined(__cplusplus)
+	#define PX_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+	#define PX_THREAD_LOCAL __declspec(thread)
+#else
+	#define PX_THREAD_LOCAL _Thread_local
+#endif
+
+typedef struct
+{
+	px_atomic_int used;		// instance and name are set, never change until a reset
+	px_atomic_int sequence;		// odd while the owner updates the counts
+	const void* instance;
+	const char* name;
+	px_atomic_int64 count;			// counts are relaxed atomics, the sequence orders them
+	px_atomic_int64 samples;
+	px_atomic_int64 total;
+	px_atomic_int64 min;
+	px_atomic_int64 max;
+	px_atomic_int buckets[PX_PROFILE_BUCKETS];
+} px_profile_zone;
+
+// a reader's copy of a zone's counts
+typedef struct
+{
+	unsigned long long count;
+	unsigned long long samples;
+	unsigned long long total;
+	unsigned long long min;
+	unsigned long long max;
+	unsigned int buckets[PX_PROFILE_BUCKETS];
+} px_profile_counts;
+
+typedef struct
+{
+	const void* instance;
+	const char* name;
+	unsigned long long start;	// ticks
+	unsigned long long cycles;
+	int num_samples;
+} px_profile_event;
+
+typedef struct
+{
+	int id;
+	px_atomic_int epoch;		// last px_profile_reset cleared, readers skip a thread that hasn't caught up
+	px_profile_zone zones[PX_PROFILE_MAX_ZONES];
+	px_atomic_int64 written;	// events so far, the ring keeps the last PX_PROFILE_TRACE_EVENTS
+	px_profile_event events[PX_PROFILE_TRACE_EVENTS];
+} px_profile_thread;
+
+static px_profile_thread* px_profile_threads[PX_PROFILE_MAX_THREADS];
+static px_atomic_int px_profile_num_threads;
+static px_atomic_int px_profile_epoch;
+static PX_THREAD_LOCAL px_profile_thread* px_profile_current;
+static PX_THREAD_LOCAL bool px_profile_refused;		// table full, this thread isn't profiled
+
+#define PX_PROFILE_BEGIN(name, instance)									\
+	const unsigned long long px_profile_start_ = px_profile_ticks();					\
+	const void* const px_profile_instance_ = (const void*)(instance);					\
+	const char* const px_profile_name_ = (name)
+
+#define PX_PROFILE_END(num_samples)										\
+	px_profile_record(px_profile_instance_, px_profile_name_, px_profile_start_, px_profile_ticks(), (num_samples))
+
+#else
+
+#define PX_PROFILE_BEGIN(name, instance)
+#define PX_PROFILE_END(num_samples)
+
+#endif
+
+// ----------------------------------------------------------------------------------------------------
+
+static int px_profile_snapshot(px_profile_stats* stats, int capacity);		// zones merged across threads, returns how many
+static bool px_profile_write_trace(const char* path);				// chrome trace event json, the last events per thread
+static void px_profile_reset(void);
+static void px_profile_thread_begin(void);					// registers the calling thread, allocates
+
+#ifdef PX_PROFILE
+
+// ----------------------------------------------------------------------------------------------------
+
+static inline unsigned long long px_profile_ticks(void);
+static inline void px_profile_record(const void* instance, const char* name, unsigned long long start, unsigned long long end, int num_samples);
+static inline int px_profile_bucket(unsigned long long cycles);
+static double px_profile_bucket_value(int bucket);
+static px_profile_thread* px_profile_thread_get(void);
+static px_profile_zone* px_profile_find(px_profile_thread* thread, const void* instance, const char* name, bool create);
+static bool px_profile_read_zone(const px_profile_zone* zone, px_profile_counts* copy);
+static void px_profile_clear_zone(px_profile_zone* zone);
+static bool px_profile_current_epoch(px_profile_thread* thread, int epoch);
+static double px_profile_now_ns(void);
+static double px_profile_ticks_per_ns(void);
+
+// ----------------------------------------------------------------------------------------------------
+
+static int px_profile_snapshot(px_profile_stats* stats, int capacity)
+{
+	assert(stats || capacity == 0);
+	const int num_threads = px_atomic_load(&px_profile_num_threads);
+	const int epoch = px_atomic_load(&px_profile_epoch);
+	int count = 0;
+
+	px_profile_counts merged, copy;
+	for (int t = 0; t < num_threads && t < PX_PROFILE_MAX_THREADS; ++t)
+	{
+		px_profile_thread* thread = px_profile_threads[t];
+		if (!px_profile_current_epoch(thread, epoch))
+			continue;
+
+		for (int z = 0; z < PX_PROFILE_MAX_ZONES && count < capacity; ++z)
+		{
+			const px_profile_zone* zone = &thread->zones[z];
+			if (!px_atomic_load(&zone->used))
+				continue;
+
+			// first thread holding the zone merges every other one's copy
+			bool seen = false;
+			for (int earlier = 0; earlier < t && !seen; ++earlier)
+				seen = px_profile_current_epoch(px_profile_threads[earlier], epoch) && px_profile_find(px_profile_threads[earlier], zone->instance, zone->name, false);
+			if (seen)
+				continue;
+
+			if (!px_profile_read_zone(zone, &merged))
+				continue;
+			for (int other = t + 1; other < num_threads && other < PX_PROFILE_MAX_THREADS; ++other)
+			{
+				px_profile_zone* match = px_profile_current_epoch(px_profile_threads[other], epoch) ? px_profile_find(px_profile_threads[other], zone->instance, zone->name, false) : NULL;
+				if (!match || !px_profile_read_zone(match, &copy) || copy.count == 0)
+					continue;
+
+				merged.min = (merged.count == 0 || copy.min < merged.min) ? copy.min : merged.min;
+				merged.max = (copy.max > merged.max) ? copy.max : merged.max;
+				merged.count += copy.count;
+				merged.samples += copy.samples;
+				merged.total += copy.total;
+				for (int bucket = 0; bucket < PX_PROFILE_BUCKETS; ++bucket)
+					merged.buckets[bucket] += copy.buckets[bucket];
+			}
+			if (merged.count == 0)
+				continue;
+
+			// p99: the bucket holding the call 1% from the top, clamped to what was actually seen
+			const unsigned long long rank = merged.count - merged.count / 100;
+			unsigned long long below = 0;
+			int bucket = 0;
+			for (; bucket < PX_PROFILE_BUCKETS - 1; ++bucket)
+			{
+				below += merged.buckets[bucket];
+				if (below >= rank)
+					break;
+			}
+
+			px_profile_stats* out = &stats[count++];
+			out->instance = zone->instance;
+			out->name = zone->name;
+			out->count = merged.count;
+			out->samples = merged.samples;
+			out->min = (double)merged.min;
+			out->avg = (double)merged.total / (double)merged.count;
+			out->max = (double)merged.max;
+			out->p99 = px_profile_bucket_value(bucket);
+			out->p99 = (out->p99 < out->min) ? out->min : (out->p99 > out->max) ? out->max : out->p99;
+			out->cycles_per_sample = (merged.samples > 0) ? (double)merged.total / (double)merged.samples : 0.0;
+		}
+	}
+	return count;
+}
+
+// complete ("X") events in microseconds from the earliest one kept, one tid per profiled thread
+static bool px_profile_write_trace(const char* path)
+{
+	assert(path);
+	FILE* file = fopen(path, "w");
+	if (!file)
+	{
+		printf("Invalid trace path");
+		return false;
+	}
+
+	const double ticks_per_us = px_profile_ticks_per_ns() * 1000.0;
+	const int num_threads = px_atomic_load(&px_profile_num_threads);
+	const int epoch = px_atomic_load(&px_profile_epoch);
+
+	unsigned long long origin = ~0ull;
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		bool first = true;
+		if (pass == 1)
+			fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+		for (int t = 0; t < num_threads && t < PX_PROFILE_MAX_THREADS; ++t)
+		{
+			px_profile_thread* thread = px_profile_threads[t];
+			if (!px_profile_current_epoch(thread, epoch))
+				continue;
+
+			const long long written = px_atomic_load(&thread->written);
+			long long oldest = (written > PX_PROFILE_TRACE_EVENTS) ? written - PX_PROFILE_TRACE_EVENTS : 0;
+			for (long long index = oldest; index < written; ++index)
+			{
+				px_profile_event event = thread->events[index & (PX_PROFILE_TRACE_EVENTS - 1)];
+
+				// the owner lapped this slot while it was being read
+				if (px_atomic_load(&thread->written) - PX_PROFILE_TRACE_EVENTS > index)
+					continue;
+
+				if (pass == 0)
+				{
+					origin = (event.start < origin) ? event.start : origin;
+					continue;
+				}
+
+				fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"px_audio\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"instance\":\"%p\",\"samples\":%d,\"cycles\":%llu}}",
+					first ? "" : ",\n", event.name, thread->id, (double)(event.start - origin) / ticks_per_us, (double)event.cycles / ticks_per_us,
+					event.instance, event.num_samples, event.cycles);
+				first = false;
+			}
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
+
+static void px_profile_reset(void)
+{
+	px_atomic_fetch_add(&px_profile_epoch, 1);
+}
+
+static void px_profile_thread_begin(void)
+{
+	px_profile_thread_get();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static inline unsigned long long px_profile_ticks(void)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+	unsigned long long ticks;
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+	return ticks;
+#else
+	return (unsigned long long)px_profile_now_ns();
+#endif
+}
+
+static inline void px_profile_record(const void* instance, const char* name, unsigned long long start, unsigned long long end, int num_samples)
+{
+	px_profile_thread* thread = px_profile_current ? px_profile_current : px_profile_thread_get();
+	if (!thread)
+		return;
+
+	// a reset clears on the owner's side, readers never write the tables
+	const int epoch = px_atomic_load_relaxed(&px_profile_epoch);
+	if (px_atomic_load_relaxed(&thread->epoch) != epoch)
+	{
+		for (int z = 0; z < PX_PROFILE_MAX_ZONES; ++z)
+			px_atomic_store(&thread->zones[z].used, 0);
+		px_atomic_store(&thread->written, 0);
+		px_atomic_store(&thread->epoch, epoch);
+	}
+
+	px_profile_zone* zone = px_profile_find(thread, instance, name, true);
+	const unsigned long long cycles = end - start;
+	if (zone)
+	{
+		const int sequence = px_atomic_load_relaxed(&zone->sequence);
+		px_atomic_store_relaxed(&zone->sequence, sequence + 1);
+		px_atomic_fence_release();
+
+		// the owner is the only writer, load and store instead of read-modify-write
+		const long long count = px_atomic_load_relaxed(&zone->count);
+		const long long min = px_atomic_load_relaxed(&zone->min);
+		const long long max = px_atomic_load_relaxed(&zone->max);
+		px_atomic_store_relaxed(&zone->min, (count == 0 || (long long)cycles < min) ? (long long)cycles : min);
+		px_atomic_store_relaxed(&zone->max, ((long long)cycles > max) ? (long long)cycles : max);
+		px_atomic_store_relaxed(&zone->count, count + 1);
+		px_atomic_store_relaxed(&zone->samples, px_atomic_load_relaxed(&zone->samples) + num_samples);
+		px_atomic_store_relaxed(&zone->total, px_atomic_load_relaxed(&zone->total) + (long long)cycles);
+		px_atomic_int* bucket = &zone->buckets[px_profile_bucket(cycles)];
+		px_atomic_store_relaxed(bucket, px_atomic_load_relaxed(bucket) + 1);
+
+		px_atomic_store(&zone->sequence, sequence + 2);
+	}
+
+	const long long written = px_atomic_load_relaxed(&thread->written);
+	px_profile_event* event = &thread->events[written & (PX_PROFILE_TRACE_EVENTS - 1)];
+	event->instance = instance;
+	event->name = name;
+	event->start = start;
+	event->cycles = cycles;
+	event->num_samples = num_samples;
+	px_atomic_store(&thread->written, written + 1);
+}
+
+// PX_PROFILE_SUBBUCKETS linear steps per power of two, exact below the first octave
+static inline int px_profile_bucket(unsigned long long cycles)
+{
+	if (cycles < PX_PROFILE_SUBBUCKETS)
+		return (int)cycles;
+
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long octave;
+	_BitScanReverse64(&octave, cycles);
+#elif defined(__GNUC__) || defined(__clang__)
+	const int octave = 63 - __builtin_clzll(cycles);
+#else
+	int octave = 0;
+	for (unsigned long long value = cycles; value > 1; value >>= 1)
+		++octave;
+#endif
+	const int shift = (int)octave - 3;	// log2(PX_PROFILE_SUBBUCKETS)
+	const int bucket = PX_PROFILE_SUBBUCKETS * (shift + 1) + (int)((cycles >> shift) & (PX_PROFILE_SUBBUCKETS - 1));
+	return (bucket < PX_PROFILE_BUCKETS) ? bucket : PX_PROFILE_BUCKETS - 1;
+}
+
+// middle of the bucket's range
+static double px_profile_bucket_value(int bucket)
+{
+	if (bucket < PX_PROFILE_SUBBUCKETS)
+		return (double)bucket;
+
+	const int shift = bucket / PX_PROFILE_SUBBUCKETS - 1;
+	const double low = (double)(PX_PROFILE_SUBBUCKETS + bucket % PX_PROFILE_SUBBUCKETS) * ldexp(1.0, shift);
+	return low + 0.5 * ldexp(1.0, shift);
+}
+
+// first call on a thread takes a slot and allocates its tables
+static px_profile_thread* px_profile_thread_get(void)
+{
+	if (px_profile_current || px_profile_refused)
+		return px_profile_current;
+
+	const int slot = px_atomic_fetch_add(&px_profile_num_threads, 1);
+	if (slot >= PX_PROFILE_MAX_THREADS)
+	{
+		px_profile_refused = true;
+		return NULL;
+	}
+
+	px_profile_thread* thread = (px_profile_thread*)px_malloc(sizeof(px_profile_thread));
+	if (!thread)
+	{
+		px_profile_refused = true;
+		return NULL;
+	}
+	memset(thread->events, 0, sizeof(thread->events));
+	for (int z = 0; z < PX_PROFILE_MAX_ZONES; ++z)
+	{
+		px_atomic_init(&thread->zones[z].used, 0);
+		px_atomic_init(&thread->zones[z].sequence, 0);
+		px_profile_clear_zone(&thread->zones[z]);
+	}
+	px_atomic_init(&thread->written, 0);
+	px_atomic_init(&thread->epoch, px_atomic_load_relaxed(&px_profile_epoch));
+	thread->id = slot;
+
+	px_atomic_fence_release();
+	px_profile_threads[slot] = thread;
+	px_profile_current = thread;
+	return thread;
+}
+
+// open addressing on the instance, create is owner only
+static px_profile_zone* px_profile_find(px_profile_thread* thread, const void* instance, const char* name, bool create)
+{
+	size_t hash = (size_t)instance;
+	hash ^= hash >> 17;
+	hash *= (size_t)0x9E3779B97F4A7C15ull;
+
+	for (int probe = 0; probe < PX_PROFILE_MAX_ZONES; ++probe)
+	{
+		px_profile_zone* zone = &thread->zones[(hash + (size_t)probe) & (PX_PROFILE_MAX_ZONES - 1)];
+		if (!px_atomic_load(&zone->used))
+		{
+			if (!create)
+				return NULL;
+
+			px_profile_clear_zone(zone);
+			zone->instance = instance;
+			zone->name = name;
+			px_atomic_store(&zone->used, 1);
+			return zone;
+		}
+		if (zone->instance == instance && (zone->name == name || strcmp(zone->name, name) == 0))
+			return zone;
+	}
+	return NULL;
+}
+
+// a consistent copy, or false if the owner kept it busy
+static bool px_profile_read_zone(const px_profile_zone* zone, px_profile_counts* copy)
+{
+	px_profile_zone* source = (px_profile_zone*)zone;
+	for (int attempt = 0; attempt < 64; ++attempt)
+	{
+		const int before = px_atomic_load(&source->sequence);
+		if (before & 1)
+		{
+			px_pause();
+			continue;
+		}
+
+		copy->count = (unsigned long long)px_atomic_load_relaxed(&source->count);
+		copy->samples = (unsigned long long)px_atomic_load_relaxed(&source->samples);
+		copy->total = (unsigned long long)px_atomic_load_relaxed(&source->total);
+		copy->min = (unsigned long long)px_atomic_load_relaxed(&source->min);
+		copy->max = (unsigned long long)px_atomic_load_relaxed(&source->max);
+		for (int bucket = 0; bucket < PX_PROFILE_BUCKETS; ++bucket)
+			copy->buckets[bucket] = (unsigned int)px_atomic_load_relaxed(&source->buckets[bucket]);
+
+		px_atomic_fence_acquire();
+		if (px_atomic_load_relaxed(&source->sequence) == before)
+			return true;
+	}
+	return false;
+}
+
+// owner only, while the zone is unused
+static void px_profile_clear_zone(px_profile_zone* zone)
+{
+	zone->instance = NULL;
+	zone->name = NULL;
+	px_atomic_store_relaxed(&zone->count, 0);
+	px_atomic_store_relaxed(&zone->samples, 0);
+	px_atomic_store_relaxed(&zone->total, 0);
+	px_atomic_store_relaxed(&zone->min, 0);
+	px_atomic_store_relaxed(&zone->max, 0);
+	for (int bucket = 0; bucket < PX_PROFILE_BUCKETS; ++bucket)
+		px_atomic_store_relaxed(&zone->buckets[bucket], 0);
+}
+
+// registered and cleared since the last reset
+static bool px_profile_current_epoch(px_profile_thread* thread, int epoch)
+{
+	return thread && px_atomic_load(&thread->epoch) == epoch;
+}
+
+static double px_profile_now_ns(void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double)counter.QuadPart * 1.0e9 / (double)frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1.0e9 + (double)time.tv_nsec;
+#elif defined(TIME_UTC)
+	// strict ISO C hides clock_gettime, C11's wall clock is enough for the tick calibration
+	struct timespec time;
+	timespec_get(&time, TIME_UTC);
+	return (double)time.tv_sec * 1.0e9 + (double)time.tv_nsec;
+#else
+	// C99, processor time: the calibration spins, so it tracks the wall clock closely enough
+	return (double)clock() * (1.0e9 / (double)CLOCKS_PER_SEC);
+#endif
+}
+
+// timestamps against the clock over ~20 ms, once, off the audio thread
+static double px_profile_ticks_per_ns(void)
+{
+	static double ratio = 0.0;
+	if (ratio > 0.0)
+		return ratio;
+
+	const double start_ns = px_profile_now_ns();
+	const unsigned long long start_ticks = px_profile_ticks();
+	double now = start_ns;
+	while (now - start_ns < 2.0e7)
+		now = px_profile_now_ns();
+	const unsigned long long ticks = px_profile_ticks() - start_ticks;
+
+	ratio = ((double)ticks > 0.0) ? (double)ticks / (now - start_ns) : 1.0;
+	return ratio;
+}
+
+#else
+
+static int px_profile_snapshot(px_profile_stats* stats, int capacity) { (void)stats; (void)capacity; return 0; }
+static bool px_profile_write_trace(const char* path) { (void)path; return false; }
+static void px_profile_reset(void) {}
+static void px_profile_thread_begin(void) {}
+
+#endif
+
+#endif
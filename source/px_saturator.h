@@ -1,5 +1,9 @@
 #include "px_globals.h"
 #include "px_memory.h"
+#include "px_simd.h"
+#include "px_smoother.h"
+#include "px_silence.h"
+#include "px_profile.h"
 
 
 #ifndef PX_SATURATOR_H
@@ -15,10 +19,22 @@
 
         float drive = 12.f;
         px_saturator saturator;
-        px_saturator_initialize(&saturator);
+        px_saturator_initialize(&saturator, sample_rate, TANGENT);
 
         px_saturator_set_drive(&saturator, drive);
 
+    // block processing
+
+        px_saturator_mono_process_block(&saturator, buffer, num_samples);
+
+    drive is converted to linear gain once in px_saturator_set_drive(), block processing ramps
+    from the previous block's gain to the new one across the block to avoid zipper noise.
+    for longer glides set a smoothing time, the per-sample path then follows the smoother and
+    the block path ramps to wherever the smoother is at the end of the block
+
+        px_saturator_set_smoothing(&saturator, 50.f);
+    block kernels use the approximations in px_simd.h instead of atan/tanh
+
 */
 
 typedef enum
@@ -29,7 +45,10 @@ typedef enum
 
 typedef struct
 {
-    float drive;
+    float drive;            // dB
+    float gain;             // linear drive, cached by set_drive
+    float ramp_gain;        // gain at the end of the last block
+    px_smoother smoother;   // linear gain, instant until set_smoothing
     SATURATION_CURVE curve;
 } px_saturator;
 
@@ -37,35 +56,47 @@ typedef struct
 // ----------------------------------------------------------------------------------------------------
 
 
-static void px_saturator_initialize(px_saturator* saturator, SATURATION_CURVE curve);
-static px_saturator* px_saturator_create(SATURATION_CURVE curve);
+static void px_saturator_initialize(px_saturator* saturator, float sample_rate, SATURATION_CURVE curve);
+static px_saturator* px_saturator_create(float sample_rate, SATURATION_CURVE curve);
 static void px_saturator_destroy(px_saturator* saturator);
 
 static void px_saturator_set_drive(px_saturator* saturator, float drive);
 static void px_saturator_set_curve(px_saturator* saturator, SATURATION_CURVE curve);
-static void px_saturator_mono_process(px_saturator* saturator, float* input);
-static void px_saturator_stereo_process(px_saturator* saturator, float* input_left, float* input_right);
+static void px_saturator_set_smoothing(px_saturator* saturator, float time); // ms, 0 = instant
+static int px_saturator_latency_samples(const px_saturator* saturator); // 0
+static int px_saturator_tail_samples(const px_saturator* saturator); // 0
+static void px_saturator_mono_process(px_saturator* saturator, SAMPLE_TYPE* input);
+static void px_saturator_stereo_process(px_saturator* saturator, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right);
+
+static void px_saturator_mono_process_block(px_saturator* saturator, SAMPLE_TYPE* input, int num_samples);
+static void px_saturator_stereo_process_block(px_saturator* saturator, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples);
 
-static inline float px_saturate_arctangent(float input, float drive);
-static inline float px_saturate_tangent(float input, float drive);
+static inline SAMPLE_TYPE px_saturate_arctangent(SAMPLE_TYPE input, float drive);
+static inline SAMPLE_TYPE px_saturate_tangent(SAMPLE_TYPE input, float drive);
+
+static inline void px_saturate_arctangent_block(SAMPLE_TYPE* input, int num_samples, float gain_start, float gain_end);
+static inline void px_saturate_tangent_block(SAMPLE_TYPE* input, int num_samples, float gain_start, float gain_end);
 
 
 // ----------------------------------------------------------------------------------------------------
 
 
-static void px_saturator_initialize(px_saturator* saturator, SATURATION_CURVE curve)
+static void px_saturator_initialize(px_saturator* saturator, float sample_rate, SATURATION_CURVE curve)
 {
     assert(saturator);
     saturator->drive = 0.f;
+    saturator->gain = 1.f;
+    saturator->ramp_gain = 1.f;
     saturator->curve = curve;
+    px_smoother_initialize(&saturator->smoother, sample_rate, 0.f, SMOOTHER_LINEAR, saturator->gain);
 }
 
-static px_saturator* px_saturator_create(SATURATION_CURVE curve)
+static px_saturator* px_saturator_create(float sample_rate, SATURATION_CURVE curve)
 {
     px_saturator* saturator = (px_saturator*)px_malloc(sizeof(px_saturator));
     if (saturator)
     {
-        px_saturator_initialize(saturator, curve);
+        px_saturator_initialize(saturator, sample_rate, curve);
         return saturator;
     }
     else return NULL;
@@ -81,6 +112,8 @@ static void px_saturator_set_drive(px_saturator* saturator, float drive)
 {
     assert(saturator);
     saturator->drive = drive;
+    saturator->gain = dB2lin(drive);
+    px_smoother_set_target(&saturator->smoother, saturator->gain);
 }
 
 static void px_saturator_set_curve(px_saturator* saturator, SATURATION_CURVE curve)
@@ -89,48 +122,169 @@ static void px_saturator_set_curve(px_saturator* saturator, SATURATION_CURVE cur
     saturator->curve = curve;
 }
 
-static void px_saturator_mono_process(px_saturator* saturator, float* input)
+static void px_saturator_set_smoothing(px_saturator* saturator, float time)
+{
+    assert(saturator);
+    px_smoother_set_time(&saturator->smoother, time);
+}
+
+static int px_saturator_latency_samples(const px_saturator* saturator)
+{
+    assert(saturator);
+    return 0;
+}
+
+static int px_saturator_tail_samples(const px_saturator* saturator)
+{
+    assert(saturator);
+    return 0;
+}
+
+static void px_saturator_mono_process(px_saturator* saturator, SAMPLE_TYPE* input)
 {
     px_assert(saturator, input);
+    float gain = px_smoother_is_smoothing(&saturator->smoother) ? px_smoother_next(&saturator->smoother) : saturator->gain;
     switch (saturator->curve)
     {	
 	case ARCTANGENT:
-		*input = px_saturate_arctangent(*input, saturator->drive);
+		*input = px_atan(*input * gain);
 		break;
 
 	case TANGENT:
-		*input = px_saturate_tangent(*input, saturator->drive);	
+		*input = px_tanh(*input * gain);
     		break;
     }
 }
 
-static void px_saturator_stereo_process(px_saturator* saturator, float* input_left, float* input_right)
+static void px_saturator_stereo_process(px_saturator* saturator, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right)
 {
     px_assert(saturator, input_left, input_right);
+    float gain = px_smoother_is_smoothing(&saturator->smoother) ? px_smoother_next(&saturator->smoother) : saturator->gain;
     switch (saturator->curve)
     {	
 	case ARCTANGENT:
-		*input_left = px_saturate_arctangent(*input_left, saturator->drive);
-		*input_right = px_saturate_arctangent(*input_right, saturator->drive);
+		*input_left = px_atan(*input_left * gain);
+		*input_right = px_atan(*input_right * gain);
 		break;
 
 	case TANGENT:
-		*input_left = px_saturate_tangent(*input_left, saturator->drive);
-    		*input_right = px_saturate_tangent(*input_right, saturator->drive);
+		*input_left = px_tanh(*input_left * gain);
+    		*input_right = px_tanh(*input_right * gain);
 		break;
     }
 }
 
+static void px_saturator_mono_process_block(px_saturator* saturator, SAMPLE_TYPE* input, int num_samples)
+{
+    px_assert(saturator, input);
+    PX_PROFILE_BEGIN("px_saturator", saturator);
+    float gain_end = px_smoother_skip(&saturator->smoother, num_samples);
+
+    // memoryless, the drive ramp still moves on
+    if (px_is_silent(input, num_samples))
+    {
+	memset(input, 0, sizeof(SAMPLE_TYPE) * num_samples);
+	saturator->ramp_gain = gain_end;
+	PX_PROFILE_END(num_samples);
+	return;
+    }
+
+    switch (saturator->curve)
+    {
+	case ARCTANGENT:
+		px_saturate_arctangent_block(input, num_samples, saturator->ramp_gain, gain_end);
+		break;
+
+	case TANGENT:
+		px_saturate_tangent_block(input, num_samples, saturator->ramp_gain, gain_end);
+		break;
+    }
+    saturator->ramp_gain = gain_end;
+    PX_PROFILE_END(num_samples);
+}
+
+static void px_saturator_stereo_process_block(px_saturator* saturator, SAMPLE_TYPE* input_left, SAMPLE_TYPE* input_right, int num_samples)
+{
+    px_assert(saturator, input_left, input_right);
+    PX_PROFILE_BEGIN("px_saturator", saturator);
+    float gain_end = px_smoother_skip(&saturator->smoother, num_samples);
+
+    if (px_is_silent(input_left, num_samples) && px_is_silent(input_right, num_samples))
+    {
+	memset(input_left, 0, sizeof(SAMPLE_TYPE) * num_samples);
+	memset(input_right, 0, sizeof(SAMPLE_TYPE) * num_samples);
+	saturator->ramp_gain = gain_end;
+	PX_PROFILE_END(num_samples);
+	return;
+    }
+
+    switch (saturator->curve)
+    {
+	case ARCTANGENT:
+		px_saturate_arctangent_block(input_left, num_samples, saturator->ramp_gain, gain_end);
+		px_saturate_arctangent_block(input_right, num_samples, saturator->ramp_gain, gain_end);
+		break;
+
+	case TANGENT:
+		px_saturate_tangent_block(input_left, num_samples, saturator->ramp_gain, gain_end);
+		px_saturate_tangent_block(input_right, num_samples, saturator->ramp_gain, gain_end);
+		break;
+    }
+    saturator->ramp_gain = gain_end;
+    PX_PROFILE_END(num_samples);
+}
+
+// ----------------------------------------------------------------------------
+
+// drive in dB, kept for one-off calls. the process functions use the cached linear gain
+
+static inline SAMPLE_TYPE px_saturate_arctangent(SAMPLE_TYPE input, float drive)
+{
+    return px_atan(input * dB2lin(drive));
+}
+
+static inline SAMPLE_TYPE px_saturate_tangent(SAMPLE_TYPE input, float drive)
+{
+    return px_tanh(input * dB2lin(drive));
+}
+
+// block kernels, gain ramps linearly and lands on gain_end at the last sample
 // ----------------------------------------------------------------------------
 
-static inline float px_saturate_arctangent(float input, float drive)
+static inline void px_saturate_arctangent_block(SAMPLE_TYPE* input, int num_samples, float gain_start, float gain_end)
 {
-    return atan(input * dB2lin(drive));
+    SAMPLE_TYPE step = (num_samples > 0) ? (SAMPLE_TYPE)(gain_end - gain_start) / (SAMPLE_TYPE)num_samples : 0.f;
+    SAMPLE_TYPE gain = gain_start + step;
+
+    int i = 0;
+    px_simd lane_gain = px_simd_ramp(gain, step);
+    px_simd lane_step = px_simd_set1(step * PX_SIMD_WIDTH);
+    for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+    {
+	px_simd x = px_simd_mul(px_simd_load(input + i), lane_gain);
+	px_simd_store(input + i, px_simd_atan(x));
+	lane_gain = px_simd_add(lane_gain, lane_step);
+    }
+    for (; i < num_samples; ++i)
+	input[i] = px_fast_atan(input[i] * (gain + step * (SAMPLE_TYPE)i));
 }
 
-static inline float px_saturate_tangent(float input, float drive)
+static inline void px_saturate_tangent_block(SAMPLE_TYPE* input, int num_samples, float gain_start, float gain_end)
 {
-    return tanh(input * dB2lin(drive));
+    SAMPLE_TYPE step = (num_samples > 0) ? (SAMPLE_TYPE)(gain_end - gain_start) / (SAMPLE_TYPE)num_samples : 0.f;
+    SAMPLE_TYPE gain = gain_start + step;
+
+    int i = 0;
+    px_simd lane_gain = px_simd_ramp(gain, step);
+    px_simd lane_step = px_simd_set1(step * PX_SIMD_WIDTH);
+    for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+    {
+	px_simd x = px_simd_mul(px_simd_load(input + i), lane_gain);
+	px_simd_store(input + i, px_simd_tanh(x));
+	lane_gain = px_simd_add(lane_gain, lane_step);
+    }
+    for (; i < num_samples; ++i)
+	input[i] = px_fast_tanh(input[i] * (gain + step * (SAMPLE_TYPE)i));
 }
 
 #endif
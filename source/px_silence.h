@@ -0,0 +1,140 @@
+#include "px_globals.h"
+#include "px_simd.h"
+
+#ifndef PX_SILENCE_H
+#define PX_SILENCE_H
+
+/*
+	px_silence.h
+
+	silence tracking for the block APIs. a processor keeps a px_silence next to its state and knows
+	its tail: how many samples its output keeps ringing after the input stops. once the input has
+	been silent for longer than the tail, the block call writes zeros and skips the work.
+
+	tails (_tail_samples on each processor)
+		clipper, saturator      0, memoryless
+		biquad                  samples for the slower pole to fall PX_SILENCE_DECAY
+		equalizer               the longest band
+		delay                   max_time, once per echo the feedback needs to fall PX_SILENCE_DECAY
+		PX_TAIL_INFINITE        never skipped
+
+	silent means every sample under PX_SILENCE_THRESHOLD, the same floor the denormal flush uses.
+	only the block APIs track it, a processor driven per sample as well should px_silence_reset
+	after the per-sample calls.
+
+	use, inside a block API:
+		const bool asleep = processor->silence.asleep;
+		if (px_silence_skip(&processor->silence, px_is_silent(input, num_samples), num_samples, tail))
+		{
+			if (!asleep)
+				...	// first skipped block, clear the state once
+			memset(input, 0, sizeof(SAMPLE_TYPE) * num_samples);
+			return;
+		}
+
+	px_graph reads the same test on node outputs to skip whole silent branches, see px_graph.h
+*/
+
+#define PX_SILENCE_THRESHOLD PX_DENORMAL_THRESHOLD
+#define PX_SILENCE_DECAY 1.0E-6		// -120 dB, where a tail counts as over
+#define PX_TAIL_INFINITE (-1)
+#define PX_TAIL_MAX (1 << 28)		// samples, counters saturate here
+
+typedef struct
+{
+	int silent;	// samples of silent input so far, up to PX_TAIL_MAX
+	bool asleep;	// skipping, state already cleared
+} px_silence;
+
+// ----------------------------------------------------------------------------------------------------
+
+static inline void px_silence_reset(px_silence* silence);
+static inline bool px_silence_skip(px_silence* silence, bool silent, int num_samples, int tail);	// true = write zeros, skip the work
+static inline bool px_is_silent(const SAMPLE_TYPE* input, int num_samples);
+static inline int px_silence_tail_poles(SAMPLE_TYPE b1, SAMPLE_TYPE b2);	// 1 + b1 z^-1 + b2 z^-2
+static inline int px_silence_tail_echoes(int length, float feedback);
+static inline int px_silence_longer(int tail, int other);	// PX_TAIL_INFINITE wins
+
+// ----------------------------------------------------------------------------------------------------
+
+static inline void px_silence_reset(px_silence* silence)
+{
+	silence->silent = 0;
+	silence->asleep = false;
+}
+
+// the samples before this block have to cover the tail, this block only has to be silent
+static inline bool px_silence_skip(px_silence* silence, bool silent, int num_samples, int tail)
+{
+	if (!silent)
+	{
+		px_silence_reset(silence);
+		return false;
+	}
+
+	const bool skip = tail >= 0 && silence->silent >= tail;
+	silence->silent = (silence->silent < PX_TAIL_MAX - num_samples) ? silence->silent + num_samples : PX_TAIL_MAX;
+	silence->asleep = skip;
+	return skip;
+}
+
+// the ends first, anything playing rarely makes it to the full scan
+static inline bool px_is_silent(const SAMPLE_TYPE* input, int num_samples)
+{
+	const SAMPLE_TYPE threshold = (SAMPLE_TYPE)PX_SILENCE_THRESHOLD;
+	if (num_samples <= 0)
+		return true;
+	if (px_fabs(input[0]) >= threshold || px_fabs(input[num_samples - 1]) >= threshold)
+		return false;
+
+	px_simd peak = px_simd_set1(0);
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+		peak = px_simd_max(peak, px_simd_abs(px_simd_load(input + i)));
+
+	SAMPLE_TYPE lanes[PX_SIMD_WIDTH];
+	px_simd_store(lanes, peak);
+
+	SAMPLE_TYPE maximum = 0;
+	for (int lane = 0; lane < PX_SIMD_WIDTH; ++lane)
+		maximum = px_fmax(maximum, lanes[lane]);
+	for (; i < num_samples; ++i)
+		maximum = px_fmax(maximum, px_fabs(input[i]));
+	return maximum < threshold;
+}
+
+// slower pole of a second-order section, plus the two samples the numerator spans
+static inline int px_silence_tail_poles(SAMPLE_TYPE b1, SAMPLE_TYPE b2)
+{
+	const double discriminant = (double)b1 * b1 - 4.0 * b2;
+	const double radius = (discriminant < 0.0) ? sqrt((double)b2) : 0.5 * (fabs((double)b1) + sqrt(discriminant));
+
+	if (radius >= 1.0)
+		return PX_TAIL_INFINITE;
+	if (radius <= 0.0)
+		return 2;
+
+	const double tail = ceil(log(PX_SILENCE_DECAY) / log(radius)) + 2.0;
+	return (tail < PX_TAIL_MAX) ? (int)tail : PX_TAIL_MAX;
+}
+
+// a feedback loop of length samples, echoes until they fall PX_SILENCE_DECAY
+static inline int px_silence_tail_echoes(int length, float feedback)
+{
+	const double gain = fabs((double)feedback);
+	if (gain >= 1.0)
+		return PX_TAIL_INFINITE;
+
+	const double echoes = (gain > 0.0) ? ceil(log(PX_SILENCE_DECAY) / log(gain)) + 1.0 : 1.0;
+	const double tail = echoes * length;
+	return (tail < PX_TAIL_MAX) ? (int)tail : PX_TAIL_MAX;
+}
+
+static inline int px_silence_longer(int tail, int other)
+{
+	if (tail == PX_TAIL_INFINITE || other == PX_TAIL_INFINITE)
+		return PX_TAIL_INFINITE;
+	return (tail > other) ? tail : other;
+}
+
+#endif
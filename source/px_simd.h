@@ -0,0 +1,599 @@
+#include "px_globals.h"
+
+#ifndef PX_SIMD_H
+#define PX_SIMD_H
+
+/*
+	px_simd.h
+
+	thin wrapper over the widest SAMPLE_TYPE vector the compiler is targeting, used by the _process_block kernels.
+	picks AVX-512, AVX, SSE2 or NEON from the compiler flags and falls back to plain scalars otherwise,
+	so every kernel is written once against px_simd and PX_SIMD_WIDTH.
+
+	float:  AVX-512 16 lanes, AVX 8, SSE2 4, NEON 4
+	double: AVX-512 8 lanes,  AVX 4, SSE2 2, NEON 2 (aarch64 only)   (#define PX_DOUBLE_BUFFER)
+
+	// force the scalar path
+	#define PX_NO_SIMD
+	#include "px_simd.h"
+
+	// use
+
+	int i = 0;
+	for (; i + PX_SIMD_WIDTH <= num_samples; i += PX_SIMD_WIDTH)
+	{
+		px_simd x = px_simd_load(input + i);
+		px_simd_store(input + i, px_simd_min(x, px_simd_set1(1.f)));
+	}
+	for (; i < num_samples; ++i)
+		input[i] = px_fmin(input[i], 1.f);  // scalar tail
+
+	loads and stores are unaligned, masks are only meant to be fed back into px_simd_select
+*/
+
+#if !defined(PX_NO_SIMD) && defined(__AVX512F__)
+
+	#define PX_SIMD_AVX512
+	#ifdef PX_DOUBLE_BUFFER
+		#define PX_SIMD_WIDTH 8
+		#define PX_SIMD_OP(name) _mm512_##name##_pd
+		typedef __m512d px_simd;
+		typedef __mmask8 px_simd_mask;
+	#else
+		#define PX_SIMD_WIDTH 16
+		#define PX_SIMD_OP(name) _mm512_##name##_ps
+		typedef __m512 px_simd;
+		typedef __mmask16 px_simd_mask;
+	#endif
+
+#elif !defined(PX_NO_SIMD) && defined(__AVX__)
+
+	#define PX_SIMD_AVX
+	#ifdef PX_DOUBLE_BUFFER
+		#define PX_SIMD_WIDTH 4
+		#define PX_SIMD_OP(name) _mm256_##name##_pd
+		typedef __m256d px_simd;
+	#else
+		#define PX_SIMD_WIDTH 8
+		#define PX_SIMD_OP(name) _mm256_##name##_ps
+		typedef __m256 px_simd;
+	#endif
+	typedef px_simd px_simd_mask;
+
+#elif !defined(PX_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+
+	#define PX_SIMD_SSE
+	#ifdef PX_DOUBLE_BUFFER
+		#define PX_SIMD_WIDTH 2
+		#define PX_SIMD_OP(name) _mm_##name##_pd
+		typedef __m128d px_simd;
+	#else
+		#define PX_SIMD_WIDTH 4
+		#define PX_SIMD_OP(name) _mm_##name##_ps
+		typedef __m128 px_simd;
+	#endif
+	typedef px_simd px_simd_mask;
+
+#elif !defined(PX_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__)) && (!defined(PX_DOUBLE_BUFFER) || defined(__aarch64__))
+
+	#define PX_SIMD_NEON
+	#ifdef PX_DOUBLE_BUFFER
+		#define PX_SIMD_WIDTH 2
+		#define PX_SIMD_OP(name) name##_f64
+		typedef float64x2_t px_simd;
+		typedef uint64x2_t px_simd_mask;
+	#else
+		#define PX_SIMD_WIDTH 4
+		#define PX_SIMD_OP(name) name##_f32
+		typedef float32x4_t px_simd;
+		typedef uint32x4_t px_simd_mask;
+	#endif
+
+#else
+
+	#define PX_SIMD_SCALAR
+	#define PX_SIMD_WIDTH 1
+	typedef SAMPLE_TYPE px_simd;
+	typedef int px_simd_mask;
+
+#endif
+
+// ---------------------------------------------------------------------------------------------
+// inline functions
+
+static inline px_simd px_simd_load(const SAMPLE_TYPE* source);
+static inline void px_simd_store(SAMPLE_TYPE* destination, px_simd value);
+static inline px_simd px_simd_set1(SAMPLE_TYPE value);
+static inline px_simd px_simd_ramp(SAMPLE_TYPE start, SAMPLE_TYPE step);	// start + step * lane
+
+static inline px_simd px_simd_add(px_simd a, px_simd b);
+static inline px_simd px_simd_sub(px_simd a, px_simd b);
+static inline px_simd px_simd_mul(px_simd a, px_simd b);
+static inline px_simd px_simd_div(px_simd a, px_simd b);
+static inline px_simd px_simd_mul_add(px_simd a, px_simd b, px_simd c);	// a * b + c
+static inline px_simd px_simd_min(px_simd a, px_simd b);
+static inline px_simd px_simd_max(px_simd a, px_simd b);
+static inline px_simd px_simd_abs(px_simd a);
+static inline px_simd px_simd_copysign(px_simd magnitude, px_simd sign);
+
+static inline px_simd_mask px_simd_less(px_simd a, px_simd b);
+static inline px_simd_mask px_simd_greater(px_simd a, px_simd b);
+static inline px_simd px_simd_select(px_simd_mask mask, px_simd a, px_simd b);	// mask ? a : b
+
+// approximations, scalar versions match the vector ones for block tails
+static inline SAMPLE_TYPE px_fast_atan(SAMPLE_TYPE x);
+static inline px_simd px_simd_atan(px_simd x);
+static inline SAMPLE_TYPE px_fast_tanh(SAMPLE_TYPE x);
+static inline px_simd px_simd_tanh(px_simd x);
+static inline SAMPLE_TYPE px_fast_log2(SAMPLE_TYPE x);	// x > 0
+static inline px_simd px_simd_log2(px_simd x);
+static inline SAMPLE_TYPE px_fast_exp2(SAMPLE_TYPE x);
+static inline px_simd px_simd_exp2(px_simd x);
+
+// exponent field access behind log2 / exp2, x positive and normal
+static inline px_simd px_simd_frexp(px_simd x, px_simd* exponent);	// mantissa in [1, 2), x = mantissa * 2^exponent
+static inline px_simd px_simd_exp2_split(px_simd x, px_simd* fraction);	// 2^round(x), fraction = x - round(x)
+
+// ---------------------------------------------------------------------------------------------
+
+#if defined(PX_SIMD_AVX512)
+
+static inline px_simd px_simd_load(const SAMPLE_TYPE* source) { return PX_SIMD_OP(loadu)(source); }
+static inline void px_simd_store(SAMPLE_TYPE* destination, px_simd value) { PX_SIMD_OP(storeu)(destination, value); }
+static inline px_simd px_simd_set1(SAMPLE_TYPE value) { return PX_SIMD_OP(set1)(value); }
+
+static inline px_simd px_simd_add(px_simd a, px_simd b) { return PX_SIMD_OP(add)(a, b); }
+static inline px_simd px_simd_sub(px_simd a, px_simd b) { return PX_SIMD_OP(sub)(a, b); }
+static inline px_simd px_simd_mul(px_simd a, px_simd b) { return PX_SIMD_OP(mul)(a, b); }
+static inline px_simd px_simd_div(px_simd a, px_simd b) { return PX_SIMD_OP(div)(a, b); }
+static inline px_simd px_simd_mul_add(px_simd a, px_simd b, px_simd c) { return PX_SIMD_OP(fmadd)(a, b, c); }
+static inline px_simd px_simd_min(px_simd a, px_simd b) { return PX_SIMD_OP(min)(a, b); }
+static inline px_simd px_simd_max(px_simd a, px_simd b) { return PX_SIMD_OP(max)(a, b); }
+static inline px_simd px_simd_abs(px_simd a) { return PX_SIMD_OP(abs)(a); }
+
+// AVX-512F has no float and/or, go through the integer registers
+static inline px_simd px_simd_copysign(px_simd magnitude, px_simd sign)
+{
+#ifdef PX_DOUBLE_BUFFER
+	__m512i sign_bit = _mm512_set1_epi64((long long)0x8000000000000000ull);
+	__m512i m = _mm512_andnot_si512(sign_bit, _mm512_castpd_si512(magnitude));
+	__m512i s = _mm512_and_si512(sign_bit, _mm512_castpd_si512(sign));
+	return _mm512_castsi512_pd(_mm512_or_si512(m, s));
+#else
+	__m512i sign_bit = _mm512_set1_epi32((int)0x80000000);
+	__m512i m = _mm512_andnot_si512(sign_bit, _mm512_castps_si512(magnitude));
+	__m512i s = _mm512_and_si512(sign_bit, _mm512_castps_si512(sign));
+	return _mm512_castsi512_ps(_mm512_or_si512(m, s));
+#endif
+}
+
+#ifdef PX_DOUBLE_BUFFER
+static inline px_simd_mask px_simd_less(px_simd a, px_simd b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+static inline px_simd_mask px_simd_greater(px_simd a, px_simd b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+#else
+static inline px_simd_mask px_simd_less(px_simd a, px_simd b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+static inline px_simd_mask px_simd_greater(px_simd a, px_simd b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+#endif
+static inline px_simd px_simd_select(px_simd_mask mask, px_simd a, px_simd b) { return PX_SIMD_OP(mask_blend)(mask, b, a); }
+
+static inline px_simd px_simd_frexp(px_simd x, px_simd* exponent)
+{
+	*exponent = PX_SIMD_OP(getexp)(x);
+	return PX_SIMD_OP(getmant)(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+}
+
+static inline px_simd px_simd_exp2_split(px_simd x, px_simd* fraction)
+{
+	px_simd n = PX_SIMD_OP(roundscale)(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	*fraction = PX_SIMD_OP(sub)(x, n);
+	return PX_SIMD_OP(scalef)(PX_SIMD_OP(set1)(1.0), n);
+}
+
+#elif defined(PX_SIMD_AVX)
+
+static inline px_simd px_simd_load(const SAMPLE_TYPE* source) { return PX_SIMD_OP(loadu)(source); }
+static inline void px_simd_store(SAMPLE_TYPE* destination, px_simd value) { PX_SIMD_OP(storeu)(destination, value); }
+static inline px_simd px_simd_set1(SAMPLE_TYPE value) { return PX_SIMD_OP(set1)(value); }
+
+static inline px_simd px_simd_add(px_simd a, px_simd b) { return PX_SIMD_OP(add)(a, b); }
+static inline px_simd px_simd_sub(px_simd a, px_simd b) { return PX_SIMD_OP(sub)(a, b); }
+static inline px_simd px_simd_mul(px_simd a, px_simd b) { return PX_SIMD_OP(mul)(a, b); }
+static inline px_simd px_simd_div(px_simd a, px_simd b) { return PX_SIMD_OP(div)(a, b); }
+#if defined(__FMA__)
+static inline px_simd px_simd_mul_add(px_simd a, px_simd b, px_simd c) { return PX_SIMD_OP(fmadd)(a, b, c); }
+#else
+static inline px_simd px_simd_mul_add(px_simd a, px_simd b, px_simd c) { return PX_SIMD_OP(add)(PX_SIMD_OP(mul)(a, b), c); }
+#endif
+static inline px_simd px_simd_min(px_simd a, px_simd b) { return PX_SIMD_OP(min)(a, b); }
+static inline px_simd px_simd_max(px_simd a, px_simd b) { return PX_SIMD_OP(max)(a, b); }
+static inline px_simd px_simd_abs(px_simd a) { return PX_SIMD_OP(andnot)(PX_SIMD_OP(set1)(-0.0), a); }
+
+static inline px_simd px_simd_copysign(px_simd magnitude, px_simd sign)
+{
+	px_simd sign_bit = PX_SIMD_OP(set1)(-0.0);
+	return PX_SIMD_OP(or)(PX_SIMD_OP(andnot)(sign_bit, magnitude), PX_SIMD_OP(and)(sign_bit, sign));
+}
+
+static inline px_simd_mask px_simd_less(px_simd a, px_simd b) { return PX_SIMD_OP(cmp)(a, b, _CMP_LT_OQ); }
+static inline px_simd_mask px_simd_greater(px_simd a, px_simd b) { return PX_SIMD_OP(cmp)(a, b, _CMP_GT_OQ); }
+static inline px_simd px_simd_select(px_simd_mask mask, px_simd a, px_simd b) { return PX_SIMD_OP(blendv)(b, a, mask); }
+
+#if defined(__AVX2__)
+static inline px_simd px_simd_frexp(px_simd x, px_simd* exponent)
+{
+#ifdef PX_DOUBLE_BUFFER
+	__m256i bits = _mm256_castpd_si256(x);
+	__m256i biased = _mm256_permutevar8x32_epi32(_mm256_srli_epi64(bits, 52), _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+	*exponent = _mm256_sub_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(biased)), _mm256_set1_pd(1023.0));
+	__m256i mantissa = _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFll));
+	return _mm256_castsi256_pd(_mm256_or_si256(mantissa, _mm256_set1_epi64x(0x3FF0000000000000ll)));
+#else
+	__m256i bits = _mm256_castps_si256(x);
+	*exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+	__m256i mantissa = _mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF));
+	return _mm256_castsi256_ps(_mm256_or_si256(mantissa, _mm256_set1_epi32(0x3F800000)));
+#endif
+}
+
+static inline px_simd px_simd_exp2_split(px_simd x, px_simd* fraction)
+{
+#ifdef PX_DOUBLE_BUFFER
+	__m128i n = _mm256_cvtpd_epi32(x);
+	*fraction = _mm256_sub_pd(x, _mm256_cvtepi32_pd(n));
+	__m256i biased = _mm256_cvtepi32_epi64(_mm_add_epi32(n, _mm_set1_epi32(1023)));
+	return _mm256_castsi256_pd(_mm256_slli_epi64(biased, 52));
+#else
+	__m256i n = _mm256_cvtps_epi32(x);
+	*fraction = _mm256_sub_ps(x, _mm256_cvtepi32_ps(n));
+	return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23));
+#endif
+}
+#else
+// AVX1 has no 256-bit integer ops, go lane by lane through the scalar versions further down
+static inline SAMPLE_TYPE px_frexp(SAMPLE_TYPE x, SAMPLE_TYPE* exponent);
+static inline SAMPLE_TYPE px_exp2_split(SAMPLE_TYPE x, SAMPLE_TYPE* fraction);
+
+static inline px_simd px_simd_frexp(px_simd x, px_simd* exponent)
+{
+	SAMPLE_TYPE lanes[PX_SIMD_WIDTH], exponents[PX_SIMD_WIDTH];
+	px_simd_store(lanes, x);
+	for (int lane = 0; lane < PX_SIMD_WIDTH; ++lane)
+		lanes[lane] = px_frexp(lanes[lane], &exponents[lane]);
+	*exponent = px_simd_load(exponents);
+	return px_simd_load(lanes);
+}
+
+static inline px_simd px_simd_exp2_split(px_simd x, px_simd* fraction)
+{
+	SAMPLE_TYPE lanes[PX_SIMD_WIDTH], fractions[PX_SIMD_WIDTH];
+	px_simd_store(lanes, x);
+	for (int lane = 0; lane < PX_SIMD_WIDTH; ++lane)
+		lanes[lane] = px_exp2_split(lanes[lane], &fractions[lane]);
+	*fraction = px_simd_load(fractions);
+	return px_simd_load(lanes);
+}
+#endif
+
+#elif defined(PX_SIMD_SSE)
+
+static inline px_simd px_simd_load(const SAMPLE_TYPE* source) { return PX_SIMD_OP(loadu)(source); }
+static inline void px_simd_store(SAMPLE_TYPE* destination, px_simd value) { PX_SIMD_OP(storeu)(destination, value); }
+static inline px_simd px_simd_set1(SAMPLE_TYPE value) { return PX_SIMD_OP(set1)(value); }
+
+static inline px_simd px_simd_add(px_simd a, px_simd b) { return PX_SIMD_OP(add)(a, b); }
+static inline px_simd px_simd_sub(px_simd a, px_simd b) { return PX_SIMD_OP(sub)(a, b); }
+static inline px_simd px_simd_mul(px_simd a, px_simd b) { return PX_SIMD_OP(mul)(a, b); }
+static inline px_simd px_simd_div(px_simd a, px_simd b) { return PX_SIMD_OP(div)(a, b); }
+static inline px_simd px_simd_mul_add(px_simd a, px_simd b, px_simd c) { return PX_SIMD_OP(add)(PX_SIMD_OP(mul)(a, b), c); }
+static inline px_simd px_simd_min(px_simd a, px_simd b) { return PX_SIMD_OP(min)(a, b); }
+static inline px_simd px_simd_max(px_simd a, px_simd b) { return PX_SIMD_OP(max)(a, b); }
+static inline px_simd px_simd_abs(px_simd a) { return PX_SIMD_OP(andnot)(PX_SIMD_OP(set1)(-0.0), a); }
+
+static inline px_simd px_simd_copysign(px_simd magnitude, px_simd sign)
+{
+	px_simd sign_bit = PX_SIMD_OP(set1)(-0.0);
+	return PX_SIMD_OP(or)(PX_SIMD_OP(andnot)(sign_bit, magnitude), PX_SIMD_OP(and)(sign_bit, sign));
+}
+
+static inline px_simd_mask px_simd_less(px_simd a, px_simd b) { return PX_SIMD_OP(cmplt)(a, b); }
+static inline px_simd_mask px_simd_greater(px_simd a, px_simd b) { return PX_SIMD_OP(cmpgt)(a, b); }
+static inline px_simd px_simd_select(px_simd_mask mask, px_simd a, px_simd b) { return PX_SIMD_OP(or)(PX_SIMD_OP(and)(mask, a), PX_SIMD_OP(andnot)(mask, b)); }
+
+static inline px_simd px_simd_frexp(px_simd x, px_simd* exponent)
+{
+#ifdef PX_DOUBLE_BUFFER
+	__m128i bits = _mm_castpd_si128(x);
+	__m128i biased = _mm_shuffle_epi32(_mm_srli_epi64(bits, 52), _MM_SHUFFLE(3, 3, 2, 0));
+	*exponent = _mm_sub_pd(_mm_cvtepi32_pd(biased), _mm_set1_pd(1023.0));
+	__m128i mantissa = _mm_and_si128(bits, _mm_set1_epi64x(0x000FFFFFFFFFFFFFll));
+	return _mm_castsi128_pd(_mm_or_si128(mantissa, _mm_set1_epi64x(0x3FF0000000000000ll)));
+#else
+	__m128i bits = _mm_castps_si128(x);
+	*exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+	__m128i mantissa = _mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF));
+	return _mm_castsi128_ps(_mm_or_si128(mantissa, _mm_set1_epi32(0x3F800000)));
+#endif
+}
+
+static inline px_simd px_simd_exp2_split(px_simd x, px_simd* fraction)
+{
+#ifdef PX_DOUBLE_BUFFER
+	__m128i n = _mm_cvtpd_epi32(x);
+	*fraction = _mm_sub_pd(x, _mm_cvtepi32_pd(n));
+	__m128i biased = _mm_unpacklo_epi32(_mm_add_epi32(n, _mm_set1_epi32(1023)), _mm_setzero_si128());
+	return _mm_castsi128_pd(_mm_slli_epi64(biased, 52));
+#else
+	__m128i n = _mm_cvtps_epi32(x);
+	*fraction = _mm_sub_ps(x, _mm_cvtepi32_ps(n));
+	return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+#endif
+}
+
+#elif defined(PX_SIMD_NEON)
+
+static inline px_simd px_simd_load(const SAMPLE_TYPE* source) { return PX_SIMD_OP(vld1q)(source); }
+static inline void px_simd_store(SAMPLE_TYPE* destination, px_simd value) { PX_SIMD_OP(vst1q)(destination, value); }
+static inline px_simd px_simd_set1(SAMPLE_TYPE value) { return PX_SIMD_OP(vdupq_n)(value); }
+
+static inline px_simd px_simd_add(px_simd a, px_simd b) { return PX_SIMD_OP(vaddq)(a, b); }
+static inline px_simd px_simd_sub(px_simd a, px_simd b) { return PX_SIMD_OP(vsubq)(a, b); }
+static inline px_simd px_simd_mul(px_simd a, px_simd b) { return PX_SIMD_OP(vmulq)(a, b); }
+#if defined(__aarch64__)
+static inline px_simd px_simd_div(px_simd a, px_simd b) { return PX_SIMD_OP(vdivq)(a, b); }
+#else
+static inline px_simd px_simd_div(px_simd a, px_simd b)
+{
+	// two newton steps on the reciprocal estimate, armv7 has no vector divide
+	float32x4_t r = vrecpeq_f32(b);
+	r = vmulq_f32(vrecpsq_f32(b, r), r);
+	r = vmulq_f32(vrecpsq_f32(b, r), r);
+	return vmulq_f32(a, r);
+}
+#endif
+static inline px_simd px_simd_mul_add(px_simd a, px_simd b, px_simd c) { return PX_SIMD_OP(vmlaq)(c, a, b); }
+static inline px_simd px_simd_min(px_simd a, px_simd b) { return PX_SIMD_OP(vminq)(a, b); }
+static inline px_simd px_simd_max(px_simd a, px_simd b) { return PX_SIMD_OP(vmaxq)(a, b); }
+static inline px_simd px_simd_abs(px_simd a) { return PX_SIMD_OP(vabsq)(a); }
+
+static inline px_simd px_simd_copysign(px_simd magnitude, px_simd sign)
+{
+#ifdef PX_DOUBLE_BUFFER
+	uint64x2_t sign_bit = vdupq_n_u64(0x8000000000000000ull);
+#else
+	uint32x4_t sign_bit = vdupq_n_u32(0x80000000u);
+#endif
+	return PX_SIMD_OP(vbslq)(sign_bit, sign, magnitude);
+}
+
+static inline px_simd_mask px_simd_less(px_simd a, px_simd b) { return PX_SIMD_OP(vcltq)(a, b); }
+static inline px_simd_mask px_simd_greater(px_simd a, px_simd b) { return PX_SIMD_OP(vcgtq)(a, b); }
+static inline px_simd px_simd_select(px_simd_mask mask, px_simd a, px_simd b) { return PX_SIMD_OP(vbslq)(mask, a, b); }
+
+static inline px_simd px_simd_frexp(px_simd x, px_simd* exponent)
+{
+#ifdef PX_DOUBLE_BUFFER
+	uint64x2_t bits = vreinterpretq_u64_f64(x);
+	int64x2_t biased = vreinterpretq_s64_u64(vshrq_n_u64(bits, 52));
+	*exponent = vcvtq_f64_s64(vsubq_s64(biased, vdupq_n_s64(1023)));
+	uint64x2_t mantissa = vandq_u64(bits, vdupq_n_u64(0x000FFFFFFFFFFFFFull));
+	return vreinterpretq_f64_u64(vorrq_u64(mantissa, vdupq_n_u64(0x3FF0000000000000ull)));
+#else
+	uint32x4_t bits = vreinterpretq_u32_f32(x);
+	int32x4_t biased = vreinterpretq_s32_u32(vshrq_n_u32(bits, 23));
+	*exponent = vcvtq_f32_s32(vsubq_s32(biased, vdupq_n_s32(127)));
+	uint32x4_t mantissa = vandq_u32(bits, vdupq_n_u32(0x007FFFFFu));
+	return vreinterpretq_f32_u32(vorrq_u32(mantissa, vdupq_n_u32(0x3F800000u)));
+#endif
+}
+
+static inline px_simd px_simd_exp2_split(px_simd x, px_simd* fraction)
+{
+#ifdef PX_DOUBLE_BUFFER
+	int64x2_t n = vcvtnq_s64_f64(x);
+	*fraction = vsubq_f64(x, vcvtq_f64_s64(n));
+	return vreinterpretq_f64_s64(vshlq_n_s64(vaddq_s64(n, vdupq_n_s64(1023)), 52));
+#else
+	// armv7 converts toward zero only, bias by half away from zero first
+	int32x4_t n = vcvtq_s32_f32(vaddq_f32(x, px_simd_copysign(vdupq_n_f32(0.5f), x)));
+	*fraction = vsubq_f32(x, vcvtq_f32_s32(n));
+	return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(n, vdupq_n_s32(127)), 23));
+#endif
+}
+
+#else
+
+static inline px_simd px_simd_load(const SAMPLE_TYPE* source) { return *source; }
+static inline void px_simd_store(SAMPLE_TYPE* destination, px_simd value) { *destination = value; }
+static inline px_simd px_simd_set1(SAMPLE_TYPE value) { return value; }
+
+static inline px_simd px_simd_add(px_simd a, px_simd b) { return a + b; }
+static inline px_simd px_simd_sub(px_simd a, px_simd b) { return a - b; }
+static inline px_simd px_simd_mul(px_simd a, px_simd b) { return a * b; }
+static inline px_simd px_simd_div(px_simd a, px_simd b) { return a / b; }
+static inline px_simd px_simd_mul_add(px_simd a, px_simd b, px_simd c) { return a * b + c; }
+static inline px_simd px_simd_min(px_simd a, px_simd b) { return px_fmin(a, b); }
+static inline px_simd px_simd_max(px_simd a, px_simd b) { return px_fmax(a, b); }
+static inline px_simd px_simd_abs(px_simd a) { return px_fabs(a); }
+static inline px_simd px_simd_copysign(px_simd magnitude, px_simd sign) { return px_copysign(magnitude, sign); }
+
+static inline px_simd_mask px_simd_less(px_simd a, px_simd b) { return a < b; }
+static inline px_simd_mask px_simd_greater(px_simd a, px_simd b) { return a > b; }
+static inline px_simd px_simd_select(px_simd_mask mask, px_simd a, px_simd b) { return mask ? a : b; }
+
+static inline SAMPLE_TYPE px_frexp(SAMPLE_TYPE x, SAMPLE_TYPE* exponent);
+static inline SAMPLE_TYPE px_exp2_split(SAMPLE_TYPE x, SAMPLE_TYPE* fraction);
+
+static inline px_simd px_simd_frexp(px_simd x, px_simd* exponent) { return px_frexp(x, exponent); }
+static inline px_simd px_simd_exp2_split(px_simd x, px_simd* fraction) { return px_exp2_split(x, fraction); }
+
+#endif
+
+static inline px_simd px_simd_ramp(SAMPLE_TYPE start, SAMPLE_TYPE step)
+{
+	SAMPLE_TYPE lanes[PX_SIMD_WIDTH];
+	for (int lane = 0; lane < PX_SIMD_WIDTH; ++lane)
+		lanes[lane] = start + step * (SAMPLE_TYPE)lane;
+	return px_simd_load(lanes);
+}
+
+// ---------------------------------------------------------------------------------------------
+// approximations
+
+/*
+	atan: odd minimax polynomial on [0, 1], range reduced with atan(x) = pi/2 - atan(1/x)
+	min(|x|, 1) / max(|x|, 1) picks the reduced argument without a branch
+	max error ~1e-5 rad
+*/
+
+#define PX_ATAN_C1  0.9998660f
+#define PX_ATAN_C3 -0.3302995f
+#define PX_ATAN_C5  0.1801410f
+#define PX_ATAN_C7 -0.0851330f
+#define PX_ATAN_C9  0.0208351f
+
+static inline SAMPLE_TYPE px_fast_atan(SAMPLE_TYPE x)
+{
+	SAMPLE_TYPE a = px_fabs(x);
+	SAMPLE_TYPE t = px_fmin(a, 1.f) / px_fmax(a, 1.f);
+	SAMPLE_TYPE t2 = t * t;
+	SAMPLE_TYPE p = t * (PX_ATAN_C1 + t2 * (PX_ATAN_C3 + t2 * (PX_ATAN_C5 + t2 * (PX_ATAN_C7 + t2 * PX_ATAN_C9))));
+	SAMPLE_TYPE r = (a > 1.f) ? (SAMPLE_TYPE)(PI / 2.0) - p : p;
+	return px_copysign(r, x);
+}
+
+static inline px_simd px_simd_atan(px_simd x)
+{
+	px_simd one = px_simd_set1(1.f);
+	px_simd a = px_simd_abs(x);
+	px_simd t = px_simd_div(px_simd_min(a, one), px_simd_max(a, one));
+	px_simd t2 = px_simd_mul(t, t);
+
+	px_simd p = px_simd_mul_add(t2, px_simd_set1(PX_ATAN_C9), px_simd_set1(PX_ATAN_C7));
+	p = px_simd_mul_add(t2, p, px_simd_set1(PX_ATAN_C5));
+	p = px_simd_mul_add(t2, p, px_simd_set1(PX_ATAN_C3));
+	p = px_simd_mul_add(t2, p, px_simd_set1(PX_ATAN_C1));
+	p = px_simd_mul(t, p);
+
+	px_simd r = px_simd_select(px_simd_greater(a, one), px_simd_sub(px_simd_set1((SAMPLE_TYPE)(PI / 2.0)), p), p);
+	return px_simd_copysign(r, x);
+}
+
+/*
+	tanh: 7th order lambert continued fraction, input clamped where the fraction reaches 1
+	max error ~1e-4
+*/
+
+#define PX_TANH_CLAMP 4.97f
+
+static inline SAMPLE_TYPE px_fast_tanh(SAMPLE_TYPE x)
+{
+	x = px_fmin(px_fmax(x, -PX_TANH_CLAMP), PX_TANH_CLAMP);
+	SAMPLE_TYPE x2 = x * x;
+	SAMPLE_TYPE numerator = x * (135135.f + x2 * (17325.f + x2 * (378.f + x2)));
+	SAMPLE_TYPE denominator = 135135.f + x2 * (62370.f + x2 * (3150.f + x2 * 28.f));
+	return numerator / denominator;
+}
+
+static inline px_simd px_simd_tanh(px_simd x)
+{
+	x = px_simd_min(px_simd_max(x, px_simd_set1(-PX_TANH_CLAMP)), px_simd_set1(PX_TANH_CLAMP));
+	px_simd x2 = px_simd_mul(x, x);
+
+	px_simd numerator = px_simd_add(x2, px_simd_set1(378.f));
+	numerator = px_simd_mul_add(x2, numerator, px_simd_set1(17325.f));
+	numerator = px_simd_mul_add(x2, numerator, px_simd_set1(135135.f));
+	numerator = px_simd_mul(x, numerator);
+
+	px_simd denominator = px_simd_mul_add(x2, px_simd_set1(28.f), px_simd_set1(3150.f));
+	denominator = px_simd_mul_add(x2, denominator, px_simd_set1(62370.f));
+	denominator = px_simd_mul_add(x2, denominator, px_simd_set1(135135.f));
+
+	return px_simd_div(numerator, denominator);
+}
+
+/*
+	log2 / exp2: exponent field plus a 5th order minimax polynomial over the mantissa
+	log2 max error ~1e-5 (~1e-4 dB through lin2dB), exp2 max rel error ~2e-7,
+	exp2 input clamped to the normal range
+	cheap enough to run a dB-domain gain computer per sample per lane
+*/
+
+#define PX_LOG2_C1  1.4426832520f
+#define PX_LOG2_C2 -0.7204423707f
+#define PX_LOG2_C3  0.4693016890f
+#define PX_LOG2_C4 -0.3033896719f
+#define PX_LOG2_C5  0.1464336193f
+#define PX_LOG2_C6 -0.0345952129f
+
+#define PX_EXP2_C0  1.0000000710f
+#define PX_EXP2_C1  0.6931469492f
+#define PX_EXP2_C2  0.2402212175f
+#define PX_EXP2_C3  0.0555074262f
+#define PX_EXP2_C4  0.0096754597f
+#define PX_EXP2_C5  0.0013266970f
+
+#ifdef PX_DOUBLE_BUFFER
+	#define PX_EXP2_LIMIT 1022.0
+#else
+	#define PX_EXP2_LIMIT 126.f
+#endif
+
+static inline SAMPLE_TYPE px_frexp(SAMPLE_TYPE x, SAMPLE_TYPE* exponent)
+{
+	int e;
+	SAMPLE_TYPE mantissa = (SAMPLE_TYPE)frexp(x, &e);	// [0.5, 1)
+	*exponent = (SAMPLE_TYPE)(e - 1);
+	return mantissa * 2.f;
+}
+
+static inline SAMPLE_TYPE px_exp2_split(SAMPLE_TYPE x, SAMPLE_TYPE* fraction)
+{
+	SAMPLE_TYPE n = px_floor(x + 0.5f);
+	*fraction = x - n;
+	return (SAMPLE_TYPE)ldexp(1.0, (int)n);
+}
+
+static inline SAMPLE_TYPE px_fast_log2(SAMPLE_TYPE x)
+{
+	SAMPLE_TYPE exponent;
+	SAMPLE_TYPE t = px_frexp(x, &exponent) - 1.f;
+	SAMPLE_TYPE p = PX_LOG2_C1 + t * (PX_LOG2_C2 + t * (PX_LOG2_C3 + t * (PX_LOG2_C4 + t * (PX_LOG2_C5 + t * PX_LOG2_C6))));
+	return exponent + t * p;
+}
+
+static inline px_simd px_simd_log2(px_simd x)
+{
+	px_simd exponent;
+	px_simd t = px_simd_sub(px_simd_frexp(x, &exponent), px_simd_set1(1.f));
+
+	px_simd p = px_simd_mul_add(t, px_simd_set1(PX_LOG2_C6), px_simd_set1(PX_LOG2_C5));
+	p = px_simd_mul_add(t, p, px_simd_set1(PX_LOG2_C4));
+	p = px_simd_mul_add(t, p, px_simd_set1(PX_LOG2_C3));
+	p = px_simd_mul_add(t, p, px_simd_set1(PX_LOG2_C2));
+	p = px_simd_mul_add(t, p, px_simd_set1(PX_LOG2_C1));
+	return px_simd_mul_add(t, p, exponent);
+}
+
+static inline SAMPLE_TYPE px_fast_exp2(SAMPLE_TYPE x)
+{
+	x = px_fmin(px_fmax(x, -PX_EXP2_LIMIT), PX_EXP2_LIMIT);
+	SAMPLE_TYPE f;
+	SAMPLE_TYPE scale = px_exp2_split(x, &f);
+	return scale * (PX_EXP2_C0 + f * (PX_EXP2_C1 + f * (PX_EXP2_C2 + f * (PX_EXP2_C3 + f * (PX_EXP2_C4 + f * PX_EXP2_C5)))));
+}
+
+static inline px_simd px_simd_exp2(px_simd x)
+{
+	x = px_simd_min(px_simd_max(x, px_simd_set1(-PX_EXP2_LIMIT)), px_simd_set1(PX_EXP2_LIMIT));
+	px_simd f;
+	px_simd scale = px_simd_exp2_split(x, &f);
+
+	px_simd p = px_simd_mul_add(f, px_simd_set1(PX_EXP2_C5), px_simd_set1(PX_EXP2_C4));
+	p = px_simd_mul_add(f, p, px_simd_set1(PX_EXP2_C3));
+	p = px_simd_mul_add(f, p, px_simd_set1(PX_EXP2_C2));
+	p = px_simd_mul_add(f, p, px_simd_set1(PX_EXP2_C1));
+	p = px_simd_mul_add(f, p, px_simd_set1(PX_EXP2_C0));
+	return px_simd_mul(scale, p);
+}
+
+#endif
@@ -0,0 +1,204 @@
+#include "px_globals.h"
+
+#ifndef PX_SMOOTHER_H
+#define PX_SMOOTHER_H
+
+/*
+	px_smoother.h
+
+	per-sample parameter smoothing, used by the processors' setters to avoid zipper noise
+
+	SMOOTHER_LINEAR   reaches the target in exactly time ms, good for gains and times
+	SMOOTHER_ONE_POLE exponential approach with time ms time constant, snaps to the target once
+	                  within PX_SMOOTHER_EPSILON so the constant path kicks back in
+
+	init:
+		px_smoother smoother;
+		px_smoother_initialize(&smoother, sample_rate, 20.f, SMOOTHER_LINEAR, initial_value);
+
+	use:
+		px_smoother_set_target(&smoother, new_value);	// from a setter
+
+		if (px_smoother_is_smoothing(&smoother))	// constant fast path otherwise
+			value = px_smoother_next(&smoother);
+
+		// block-aware
+		px_smoother_process_block(&smoother, values, num_samples);	// fill per-sample values
+		float end = px_smoother_skip(&smoother, num_samples);		// or jump a control block ahead
+
+	a time of 0 ms makes set_target instant, which is what every processor defaults to
+*/
+
+#define PX_SMOOTHER_EPSILON 1.0E-6f
+
+typedef enum
+{
+	SMOOTHER_LINEAR,
+	SMOOTHER_ONE_POLE
+} SMOOTHER_TYPE;
+
+typedef struct
+{
+	float sample_rate;
+	float time;		// ms
+	float current;
+	float target;
+	float step;		// linear increment
+	float coefficient;	// one-pole feedback
+	int steps_remaining;	// linear countdown, one-pole uses it as an active flag
+	SMOOTHER_TYPE type;
+} px_smoother;
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_smoother_initialize(px_smoother* smoother, float sample_rate, float time, SMOOTHER_TYPE type, float value);
+static void px_smoother_set_time(px_smoother* smoother, float time);
+static void px_smoother_set_sample_rate(px_smoother* smoother, float sample_rate);
+static void px_smoother_set_target(px_smoother* smoother, float target);
+static void px_smoother_reset(px_smoother* smoother, float value);
+
+static void px_smoother_process_block(px_smoother* smoother, float* output, int num_samples);
+static float px_smoother_skip(px_smoother* smoother, int num_samples);
+
+static inline bool px_smoother_is_smoothing(const px_smoother* smoother);
+static inline float px_smoother_next(px_smoother* smoother);
+
+// ----------------------------------------------------------------------------------------------------
+
+static void px_smoother_initialize(px_smoother* smoother, float sample_rate, float time, SMOOTHER_TYPE type, float value)
+{
+	assert(smoother);
+	smoother->sample_rate = sample_rate;
+	smoother->type = type;
+	smoother->step = 0.f;
+	smoother->coefficient = 0.f;
+	px_smoother_set_time(smoother, time);
+	px_smoother_reset(smoother, value);
+}
+
+static void px_smoother_set_time(px_smoother* smoother, float time)
+{
+	assert(smoother);
+	smoother->time = (time > 0.f) ? time : 0.f;
+
+	float samples = smoother->time * 0.001f * smoother->sample_rate;
+	smoother->coefficient = (samples > 0.f) ? expf(-1.f / samples) : 0.f;
+}
+
+static void px_smoother_set_sample_rate(px_smoother* smoother, float sample_rate)
+{
+	assert(smoother);
+	smoother->sample_rate = sample_rate;
+	px_smoother_set_time(smoother, smoother->time);
+}
+
+static void px_smoother_set_target(px_smoother* smoother, float target)
+{
+	assert(smoother);
+	smoother->target = target;
+
+	int samples = (int)(smoother->time * 0.001f * smoother->sample_rate);
+	if (samples <= 0 || target == smoother->current)
+	{
+		px_smoother_reset(smoother, target);
+		return;
+	}
+
+	switch (smoother->type)
+	{
+	case SMOOTHER_LINEAR:
+		smoother->step = (target - smoother->current) / (float)samples;
+		smoother->steps_remaining = samples;
+		break;
+
+	case SMOOTHER_ONE_POLE:
+		smoother->steps_remaining = 1;
+		break;
+	}
+}
+
+static void px_smoother_reset(px_smoother* smoother, float value)
+{
+	assert(smoother);
+	smoother->current = value;
+	smoother->target = value;
+	smoother->steps_remaining = 0;
+}
+
+static void px_smoother_process_block(px_smoother* smoother, float* output, int num_samples)
+{
+	assert(smoother && output);
+	int i = 0;
+	while (i < num_samples && px_smoother_is_smoothing(smoother))
+	{
+		output[i++] = px_smoother_next(smoother);
+	}
+
+	// settled, the rest of the block is constant
+	for (; i < num_samples; ++i)
+		output[i] = smoother->current;
+}
+
+static float px_smoother_skip(px_smoother* smoother, int num_samples)
+{
+	assert(smoother);
+	if (!px_smoother_is_smoothing(smoother) || num_samples <= 0)
+		return smoother->current;
+
+	switch (smoother->type)
+	{
+	case SMOOTHER_LINEAR:
+		if (num_samples >= smoother->steps_remaining)
+		{
+			px_smoother_reset(smoother, smoother->target);
+		}
+		else
+		{
+			smoother->current += smoother->step * (float)num_samples;
+			smoother->steps_remaining -= num_samples;
+		}
+		break;
+
+	case SMOOTHER_ONE_POLE:
+		smoother->current = smoother->target + powf(smoother->coefficient, (float)num_samples) * (smoother->current - smoother->target);
+		if (fabsf(smoother->target - smoother->current) <= PX_SMOOTHER_EPSILON * fmaxf(1.f, fabsf(smoother->target)))
+			px_smoother_reset(smoother, smoother->target);
+		break;
+	}
+	return smoother->current;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+static inline bool px_smoother_is_smoothing(const px_smoother* smoother)
+{
+	return smoother->steps_remaining > 0;
+}
+
+static inline float px_smoother_next(px_smoother* smoother)
+{
+	if (smoother->steps_remaining <= 0)
+		return smoother->current;
+
+	switch (smoother->type)
+	{
+	case SMOOTHER_LINEAR:
+		if (--smoother->steps_remaining == 0)
+			smoother->current = smoother->target;	// land exactly, no accumulated drift
+		else
+			smoother->current += smoother->step;
+		break;
+
+	case SMOOTHER_ONE_POLE:
+		smoother->current = smoother->target + smoother->coefficient * (smoother->current - smoother->target);
+		if (fabsf(smoother->target - smoother->current) <= PX_SMOOTHER_EPSILON * fmaxf(1.f, fabsf(smoother->target)))
+		{
+			smoother->current = smoother->target;
+			smoother->steps_remaining = 0;
+		}
+		break;
+	}
+	return smoother->current;
+}
+
+#endif
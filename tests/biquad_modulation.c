@@ -0,0 +1,90 @@
+/*
+	biquad_modulation.c
+
+	a setter that designs directly (type, lookup) while a modulation ramp is running has to
+	survive the end of the ramp. each case starts a ramp, changes the filter halfway through,
+	runs past the end and compares the coefficients with a biquad designed from scratch.
+
+	build:
+		cc -O2 -Isource tests/biquad_modulation.c -o biquad_modulation -lm -lpthread
+		./biquad_modulation
+
+	exit code 0 is the pass.
+*/
+
+#include "px_biquad.h"
+
+#define SAMPLE_RATE 48000.f
+#define CONTROL_BLOCK 64
+#define TOLERANCE 1.0e-6
+
+typedef enum
+{
+	CHANGE_TYPE,
+	CHANGE_LOOKUP
+} change;
+
+static double coefficient_error(const px_biquad* biquad, const px_biquad* reference)
+{
+	double error = 0.0;
+	if (biquad->parameters.topology == BIQUAD_SVF)
+	{
+		error = fmax(error, fabs((double)biquad->svf.g - reference->svf.g));
+		error = fmax(error, fabs((double)biquad->svf.k - reference->svf.k));
+		error = fmax(error, fabs((double)biquad->svf.m0 - reference->svf.m0));
+		error = fmax(error, fabs((double)biquad->svf.m1 - reference->svf.m1));
+		error = fmax(error, fabs((double)biquad->svf.m2 - reference->svf.m2));
+		return error;
+	}
+	error = fmax(error, fabs((double)biquad->coefficients.a0 - reference->coefficients.a0));
+	error = fmax(error, fabs((double)biquad->coefficients.a1 - reference->coefficients.a1));
+	error = fmax(error, fabs((double)biquad->coefficients.a2 - reference->coefficients.a2));
+	error = fmax(error, fabs((double)biquad->coefficients.b1 - reference->coefficients.b1));
+	error = fmax(error, fabs((double)biquad->coefficients.b2 - reference->coefficients.b2));
+	return error;
+}
+
+static bool run_case(const char* name, BIQUAD_TOPOLOGY topology, change what)
+{
+	px_biquad biquad;
+	px_biquad_initialize(&biquad, SAMPLE_RATE, BIQUAD_LOWPASS);
+	px_biquad_set_topology(&biquad, topology);
+	px_biquad_set_modulation(&biquad, CONTROL_BLOCK);
+
+	// start a ramp from 100 Hz to 2 kHz, stop halfway through it
+	px_biquad_set_frequency(&biquad, 2000.f);
+	SAMPLE_TYPE buffer[CONTROL_BLOCK * 4] = { 0 };
+	buffer[0] = 1.f;
+	px_biquad_process_block(&biquad, buffer, CONTROL_BLOCK / 2);
+
+	if (what == CHANGE_TYPE)
+		px_biquad_set_type(&biquad, BIQUAD_HIGHPASS);
+	else
+		px_biquad_set_lookup(&biquad, true);
+
+	// past the end of the ramp, with signal so the silence skip stays out of the way
+	for (int i = 0; i < CONTROL_BLOCK * 4; ++i)
+		buffer[i] = (i & 1) ? 0.25f : -0.25f;
+	px_biquad_process_block(&biquad, buffer, CONTROL_BLOCK * 4);
+
+	px_biquad reference;
+	px_biquad_initialize(&reference, SAMPLE_RATE, (what == CHANGE_TYPE) ? BIQUAD_HIGHPASS : BIQUAD_LOWPASS);
+	px_biquad_set_topology(&reference, topology);
+	px_biquad_set_lookup(&reference, what == CHANGE_LOOKUP);
+	px_biquad_set_frequency(&reference, 2000.f);
+
+	const double error = coefficient_error(&biquad, &reference);
+	const bool pass = !px_biquad_is_smoothing(&biquad) && error < TOLERANCE;
+	printf("%-24s error %.3g  %s\n", name, error, pass ? "ok" : "FAILED");
+	return pass;
+}
+
+int main(void)
+{
+	bool pass = true;
+	pass &= run_case("direct form, type", BIQUAD_DIRECT_FORM, CHANGE_TYPE);
+	pass &= run_case("direct form, lookup", BIQUAD_DIRECT_FORM, CHANGE_LOOKUP);
+	pass &= run_case("svf, type", BIQUAD_SVF, CHANGE_TYPE);
+	pass &= run_case("svf, lookup", BIQUAD_SVF, CHANGE_LOOKUP);
+	return pass ? 0 : 1;
+}